@@ -0,0 +1,112 @@
+#include <stdlib.h>
+#include "arena.h"
+#define TAM_PAGINA 65536
+#define ALINEACION 16
+
+/* *****************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+struct pagina{
+	struct pagina* sig;
+}typedef pagina_t;
+
+struct arena{
+	asignador_t asignador;
+	pagina_t* paginas;
+	char* libre;     // proximo byte a entregar de la pagina actual
+	size_t restante; // bytes que quedan en la pagina actual
+};
+
+// Espacio reservado al comienzo de cada pagina, redondeado para que los
+// datos queden alineados.
+#define ENCABEZADO ((sizeof(pagina_t) + ALINEACION - 1) & ~(size_t)(ALINEACION - 1))
+
+/* *****************************************************************
+ *                    PRIMITIVAS DEL ASIGNADOR
+ * *****************************************************************/
+
+void* asignador_pedir(const asignador_t* asignador, size_t tam){
+	if(!asignador || !asignador->pedir)
+		return malloc(tam);
+	return asignador->pedir(asignador->ctx, tam);
+}
+
+void asignador_liberar(const asignador_t* asignador, void* ptr){
+	if(!asignador || !asignador->pedir){
+		free(ptr);
+		return;
+	}
+	if(asignador->liberar)
+		asignador->liberar(asignador->ctx, ptr);
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DE LA ARENA
+ * *****************************************************************/
+
+arena_t* arena_crear(const asignador_t* asignador){
+	arena_t* arena = asignador_pedir(asignador, sizeof(arena_t));
+	if(!arena) return NULL;
+	arena->asignador.pedir = NULL;
+	arena->asignador.liberar = NULL;
+	arena->asignador.ctx = NULL;
+	if(asignador)
+		arena->asignador = *asignador;
+	arena->paginas = NULL;
+	arena->libre = NULL;
+	arena->restante = 0;
+	return arena;
+}
+
+void* arena_pedir(arena_t* arena, size_t tam){
+	tam = (tam + ALINEACION - 1) & ~(size_t)(ALINEACION - 1);
+	if(tam > arena->restante){
+		// Lo que quedaba de la pagina actual se pierde hasta destruir la arena.
+		size_t tam_pagina = tam > TAM_PAGINA - ENCABEZADO ? tam + ENCABEZADO : TAM_PAGINA;
+		pagina_t* pagina = asignador_pedir(&arena->asignador, tam_pagina);
+		if(!pagina) return NULL;
+		pagina->sig = arena->paginas;
+		arena->paginas = pagina;
+		arena->libre = (char*)pagina + ENCABEZADO;
+		arena->restante = tam_pagina - ENCABEZADO;
+	}
+	void* ptr = arena->libre;
+	arena->libre += tam;
+	arena->restante -= tam;
+	return ptr;
+}
+
+void arena_destruir(arena_t* arena){
+	pagina_t* pagina = arena->paginas;
+	while(pagina){
+		pagina_t* sig = pagina->sig;
+		asignador_liberar(&arena->asignador, pagina);
+		pagina = sig;
+	}
+	asignador_t asignador = arena->asignador;
+	asignador_liberar(&asignador, arena);
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DEL SLAB
+ * *****************************************************************/
+
+void slab_inicializar(slab_t* slab, arena_t* arena, size_t tam_objeto){
+	slab->arena = arena;
+	slab->tam_objeto = tam_objeto < sizeof(void*) ? sizeof(void*) : tam_objeto;
+	slab->libres = NULL;
+}
+
+void* slab_pedir(slab_t* slab){
+	if(!slab->libres)
+		return arena_pedir(slab->arena, slab->tam_objeto);
+	void* objeto = slab->libres;
+	slab->libres = *(void**)objeto;
+	return objeto;
+}
+
+void slab_devolver(slab_t* slab, void* objeto){
+	*(void**)objeto = slab->libres;
+	slab->libres = objeto;
+}
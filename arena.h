@@ -0,0 +1,82 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* *****************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+// Funciones para pedir y liberar memoria, con un contexto propio del
+// usuario (por ejemplo, una arena por pedido). Si pedir es NULL se usan
+// malloc y free. liberar puede ser NULL si el usuario libera toda la
+// memoria del contexto junta.
+typedef struct asignador{
+	void *(*pedir)(void *ctx, size_t tam);
+	void (*liberar)(void *ctx, void *ptr);
+	void *ctx;
+} asignador_t;
+
+// Arena: reparte memoria de paginas grandes avanzando un puntero. Lo que
+// se pide no se libera de a uno, sino todo junto al destruir la arena.
+struct arena;
+typedef struct arena arena_t;
+
+// Slab: reparte objetos de un tamaño fijo sacados de una arena, y
+// reutiliza los que se le devuelven. Se puede guardar en el stack o
+// dentro de otra estructura.
+typedef struct slab{
+	arena_t *arena;
+	size_t tam_objeto;
+	void *libres; // lista de objetos devueltos, enlazados por su inicio
+} slab_t;
+
+/* *****************************************************************
+ *                    PRIMITIVAS DEL ASIGNADOR
+ * *****************************************************************/
+
+// Pide tam bytes al asignador (o a malloc, si asignador es NULL o no
+// tiene funcion pedir). Devuelve NULL si no hay memoria.
+void *asignador_pedir(const asignador_t *asignador, size_t tam);
+
+// Libera memoria obtenida con asignador_pedir del mismo asignador.
+void asignador_liberar(const asignador_t *asignador, void *ptr);
+
+/* *****************************************************************
+ *                    PRIMITIVAS DE LA ARENA
+ * *****************************************************************/
+
+// Crea una arena que pide sus paginas al asignador recibido (que se
+// copia; puede ser NULL).
+// Post: devuelve una arena vacia, o NULL si no hay memoria.
+arena_t *arena_crear(const asignador_t *asignador);
+
+// Devuelve tam bytes alineados para cualquier tipo, o NULL si no hay
+// memoria.
+// Pre: la arena fue creada.
+void *arena_pedir(arena_t *arena, size_t tam);
+
+// Libera todas las paginas de la arena de una sola vez.
+// Pre: la arena fue creada.
+// Post: la memoria entregada por la arena deja de ser valida.
+void arena_destruir(arena_t *arena);
+
+/* *****************************************************************
+ *                    PRIMITIVAS DEL SLAB
+ * *****************************************************************/
+
+// Inicializa un slab de objetos de tam_objeto bytes sobre la arena.
+// Pre: la arena fue creada.
+void slab_inicializar(slab_t *slab, arena_t *arena, size_t tam_objeto);
+
+// Devuelve un objeto, reutilizando uno devuelto si lo hay. NULL si no
+// hay memoria.
+// Pre: el slab fue inicializado.
+void *slab_pedir(slab_t *slab);
+
+// Devuelve el objeto al slab para que se lo vuelva a entregar.
+// Pre: objeto fue obtenido con slab_pedir del mismo slab.
+void slab_devolver(slab_t *slab, void *objeto);
+
+#endif // ARENA_H
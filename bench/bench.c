@@ -0,0 +1,416 @@
+#define _POSIX_C_SOURCE 200809L
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include "../hash.h"
+#include "../lista.h"
+
+/* Benchmark del hash y de la lista. Mide cada operacion por separado y
+ * escribe una linea JSON por operacion en la salida estandar, para poder
+ * comparar corridas. Ver bench/Makefile.
+ *
+ * Cada operacion se corre dos veces: en un ciclo que se mide entero, del
+ * que salen ns_op y los pedidos de memoria, y en otro que lee el reloj
+ * antes y despues de cada operacion, del que salen los percentiles y el
+ * maximo. Leer el reloj cuesta tanto como una busqueda, asi que sumar las
+ * mediciones de a una inflaria ns_op.
+ *
+ * uso: bench [-n cantidad] [-d uniforme|zipf|secuencial|url] [-e hash|lista]
+ */
+
+#ifndef IMPLEMENTACION
+#define IMPLEMENTACION "hash.c"
+#endif
+#define THETA_ZIPF 0.99
+#define SUBCUBETAS 16 // cubetas del histograma por potencia de dos
+#define CUBETAS (64 * SUBCUBETAS)
+#define LARGO_MAX_CLAVE 64
+
+/* *****************************************************************
+ *                    CONTEO DE PEDIDOS DE MEMORIA
+ * *****************************************************************/
+
+// El Makefile enlaza con -Wl,--wrap=malloc,...: cada llamada a malloc del
+// programa pasa por __wrap_malloc, que la cuenta y llama a la original.
+void* __real_malloc(size_t tam);
+void* __real_calloc(size_t cant, size_t tam);
+void* __real_realloc(void* ptr, size_t tam);
+static size_t pedidos;
+
+void* __wrap_malloc(size_t tam){
+	pedidos++;
+	return __real_malloc(tam);
+}
+
+void* __wrap_calloc(size_t cant, size_t tam){
+	pedidos++;
+	return __real_calloc(cant, tam);
+}
+
+void* __wrap_realloc(void* ptr, size_t tam){
+	pedidos++;
+	return __real_realloc(ptr, tam);
+}
+
+/* *****************************************************************
+ *                    MEDICION DE LATENCIAS
+ * *****************************************************************/
+
+// Histograma logaritmico de latencias en nanosegundos: exacto hasta
+// SUBCUBETAS ns y con un error de a lo sumo 1/SUBCUBETAS despues. Si no
+// tiene muestras, los percentiles son el maximo.
+typedef struct medicion{
+	uint64_t cubetas[CUBETAS];
+	uint64_t muestras;
+	uint64_t max;
+	uint64_t cant;   // operaciones del ciclo medido entero
+	uint64_t total;  // y su duracion
+	size_t pedidos;  // pedidos de memoria del ciclo
+} medicion_t;
+
+static uint64_t ahora(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static size_t cubeta_de(uint64_t ns){
+	if(ns < SUBCUBETAS) return (size_t)ns;
+	size_t exp = 63 - (size_t)__builtin_clzll(ns); // exp >= 4
+	size_t sub = (size_t)(ns >> (exp - 4)) & (SUBCUBETAS - 1);
+	size_t i = (exp - 3) * SUBCUBETAS + sub;
+	return i < CUBETAS ? i : CUBETAS - 1;
+}
+
+// Devuelve el menor valor que cae en la cubeta i.
+static uint64_t valor_de(size_t i){
+	if(i < SUBCUBETAS) return i;
+	size_t exp = i / SUBCUBETAS + 3;
+	return ((uint64_t)SUBCUBETAS + i % SUBCUBETAS) << (exp - 4);
+}
+
+static void medicion_empezar(medicion_t* m){
+	memset(m, 0, sizeof(*m));
+}
+
+static void medicion_agregar(medicion_t* m, uint64_t ns){
+	m->cubetas[cubeta_de(ns)]++;
+	m->muestras++;
+	if(ns > m->max) m->max = ns;
+}
+
+// Corre operacion para i de 0 a n - 1 y mide el ciclo entero.
+#define MEDIR_CICLO(m, n, operacion) do{ \
+	size_t pedidos_ = pedidos; \
+	uint64_t inicio_ = ahora(); \
+	for(size_t i = 0; i < (n); i++){ operacion; } \
+	(m)->total = ahora() - inicio_; \
+	(m)->cant = (n); \
+	(m)->pedidos = pedidos - pedidos_; \
+}while(0)
+
+// Corre operacion para i de 0 a n - 1 y mide cada una.
+#define MEDIR_CADA_UNA(m, n, operacion) do{ \
+	for(size_t i = 0; i < (n); i++){ \
+		uint64_t inicio_ = ahora(); \
+		operacion; \
+		medicion_agregar((m), ahora() - inicio_); \
+	} \
+}while(0)
+
+// Mide una sola operacion: los percentiles son su duracion.
+#define MEDIR_UNA(m, cant_elementos, operacion) do{ \
+	size_t pedidos_ = pedidos; \
+	uint64_t inicio_ = ahora(); \
+	operacion; \
+	(m)->total = ahora() - inicio_; \
+	(m)->max = (m)->total; \
+	(m)->cant = (cant_elementos); \
+	(m)->pedidos = pedidos - pedidos_; \
+}while(0)
+
+static uint64_t percentil(const medicion_t* m, double p){
+	uint64_t objetivo = (uint64_t)(p * (double)m->muestras);
+	uint64_t acumulado = 0;
+	for(size_t i = 0; i < CUBETAS; i++){
+		acumulado += m->cubetas[i];
+		if(acumulado > objetivo) return valor_de(i);
+	}
+	return m->max;
+}
+
+static void informar(const char* estructura, const char* distribucion, size_t n, const char* operacion, const medicion_t* m){
+	struct rusage uso;
+	getrusage(RUSAGE_SELF, &uso);
+	printf("{\"estructura\":\"%s\",\"implementacion\":\"%s\",\"distribucion\":\"%s\",\"n\":%zu,"
+		"\"operacion\":\"%s\",\"ns_op\":%.1f,\"p50\":%llu,\"p99\":%llu,\"p999\":%llu,\"max\":%llu,"
+		"\"pedidos\":%zu,\"rss_max_kb\":%ld}\n",
+		estructura, strcmp(estructura, "hash") == 0 ? IMPLEMENTACION : "lista.c", distribucion, n, operacion,
+		m->cant ? (double)m->total / (double)m->cant : 0.0,
+		(unsigned long long)percentil(m, 0.5), (unsigned long long)percentil(m, 0.99),
+		(unsigned long long)percentil(m, 0.999), (unsigned long long)m->max,
+		m->pedidos, uso.ru_maxrss);
+	fflush(stdout);
+}
+
+/* *****************************************************************
+ *                    GENERACION DE CLAVES
+ * *****************************************************************/
+
+static uint64_t splitmix(uint64_t x){
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+// Numero pseudoaleatorio en [0, n).
+static size_t azar(uint64_t* estado, size_t n){
+	*estado = splitmix(*estado);
+	return (size_t)(*estado % n);
+}
+
+/* Escribe en clave la clave numero i de la distribucion. Claves con
+ * distinto i son distintas; las de i >= n se usan para buscar claves que
+ * no estan.
+ */
+static void generar_clave(const char* distribucion, size_t i, char* clave){
+	if(strcmp(distribucion, "secuencial") == 0)
+		sprintf(clave, "%zu", i);
+	else if(strcmp(distribucion, "url") == 0)
+		sprintf(clave, "https://www.ejemplo.com.ar/productos/categoria/%zu", i);
+	else // uniforme y zipf: splitmix es biyectiva, no hay repetidas
+		sprintf(clave, "%016llx", (unsigned long long)splitmix(i));
+}
+
+// Claves guardadas juntas en un bloque, cada una terminada en '\0'.
+typedef struct claves{
+	char* bloque;
+	size_t* inicio;
+	size_t cant;
+} claves_t;
+
+static bool claves_crear(claves_t* claves, const char* distribucion, size_t desde, size_t cant){
+	size_t capacidad = cant * 24 + LARGO_MAX_CLAVE;
+	claves->bloque = malloc(capacidad);
+	claves->inicio = malloc(sizeof(size_t) * cant);
+	claves->cant = cant;
+	if(!claves->bloque || !claves->inicio) return false;
+	size_t usado = 0;
+	for(size_t i = 0; i < cant; i++){
+		if(capacidad - usado < LARGO_MAX_CLAVE){
+			capacidad *= 2;
+			char* bloque = realloc(claves->bloque, capacidad);
+			if(!bloque) return false;
+			claves->bloque = bloque;
+		}
+		claves->inicio[i] = usado;
+		generar_clave(distribucion, desde + i, claves->bloque + usado);
+		usado += strlen(claves->bloque + usado) + 1;
+	}
+	return true;
+}
+
+static const char* clave(const claves_t* claves, size_t i){
+	return claves->bloque + claves->inicio[i];
+}
+
+static void claves_destruir(claves_t* claves){
+	free(claves->bloque);
+	free(claves->inicio);
+}
+
+/* Genera el orden en que se buscan las claves: cant indices en [0, n),
+ * uniformes o con distribucion de Zipf (el generador de Gray et al.,
+ * "Quickly generating billion-record synthetic databases"), en cuyo caso
+ * unas pocas claves se buscan la mayoria de las veces.
+ */
+static size_t* generar_busquedas(const char* distribucion, size_t n, size_t cant){
+	size_t* indices = malloc(sizeof(size_t) * cant);
+	if(!indices) return NULL;
+	uint64_t estado = 42;
+	if(strcmp(distribucion, "zipf") != 0){
+		for(size_t i = 0; i < cant; i++)
+			indices[i] = azar(&estado, n);
+		return indices;
+	}
+	double zeta_n = 0, zeta_2 = 1 + pow(0.5, THETA_ZIPF);
+	for(size_t i = 1; i <= n; i++)
+		zeta_n += 1 / pow((double)i, THETA_ZIPF);
+	double alfa = 1 / (1 - THETA_ZIPF);
+	double eta = (1 - pow(2.0 / (double)n, 1 - THETA_ZIPF)) / (1 - zeta_2 / zeta_n);
+	for(size_t i = 0; i < cant; i++){
+		double u = (double)(splitmix(estado += 1) >> 11) / 9007199254740992.0;
+		double uz = u * zeta_n;
+		size_t rango;
+		if(uz < 1) rango = 0;
+		else if(uz < zeta_2) rango = 1;
+		else rango = (size_t)((double)n * pow(eta * u - eta + 1, alfa));
+		if(rango >= n) rango = n - 1;
+		// El rango se mezcla para que las claves frecuentes no sean las
+		// primeras guardadas.
+		indices[i] = (size_t)(splitmix(rango) % n);
+	}
+	return indices;
+}
+
+/* *****************************************************************
+ *                    BENCHMARKS
+ * *****************************************************************/
+
+static bool contar(const char* clave, void* dato, void* extra){
+	(void)clave;
+	(void)dato;
+	(*(size_t*)extra)++;
+	return true;
+}
+
+static int bench_hash(const char* distribucion, size_t n){
+	claves_t claves, fallos;
+	size_t* busquedas = generar_busquedas(distribucion, n, n);
+	size_t* orden_borrado = malloc(sizeof(size_t) * n);
+	if(!busquedas || !orden_borrado || !claves_crear(&claves, distribucion, 0, n) || !claves_crear(&fallos, distribucion, n, n)){
+		fprintf(stderr, "bench: no hay memoria para las claves\n");
+		return 1;
+	}
+	// Borrado en orden aleatorio: se mezclan los indices 0..n-1.
+	for(size_t i = 0; i < n; i++)
+		orden_borrado[i] = i;
+	uint64_t estado = 7;
+	for(size_t i = n; i > 1; i--){
+		size_t j = azar(&estado, i);
+		size_t aux = orden_borrado[i - 1];
+		orden_borrado[i - 1] = orden_borrado[j];
+		orden_borrado[j] = aux;
+	}
+
+	medicion_t m;
+	size_t suma = 0;
+	hash_t* hash = hash_crear(NULL);
+	hash_t* otro = hash_crear(NULL);
+	if(!hash || !otro) return 1;
+
+	// Los percentiles de guardar salen de otro hash, que se arma igual y
+	// se destruye antes de armar el de las demas operaciones. El maximo
+	// es la peor demora de una redimension.
+	medicion_empezar(&m);
+	MEDIR_CADA_UNA(&m, n, hash_guardar(otro, clave(&claves, i), (void*)clave(&claves, i)));
+	// Una redimension sola de la tabla llena, al doble de tamaño: ns_op es
+	// por clave movida.
+	medicion_t r;
+	hash_estadisticas_t e;
+	hash_estadisticas(otro, &e);
+	medicion_empezar(&r);
+	MEDIR_UNA(&r, n, hash_reservar(otro, e.tam));
+	hash_destruir(otro);
+	MEDIR_CICLO(&m, n, hash_guardar(hash, clave(&claves, i), (void*)clave(&claves, i)));
+	informar("hash", distribucion, n, "guardar", &m);
+	informar("hash", distribucion, n, "redimensionar", &r);
+
+	medicion_empezar(&m);
+	MEDIR_CICLO(&m, n, suma += hash_obtener(hash, clave(&claves, busquedas[i])) != NULL);
+	MEDIR_CADA_UNA(&m, n, suma += hash_obtener(hash, clave(&claves, busquedas[i])) != NULL);
+	informar("hash", distribucion, n, "obtener_acierto", &m);
+
+	medicion_empezar(&m);
+	MEDIR_CICLO(&m, n, suma += hash_obtener(hash, clave(&fallos, i)) != NULL);
+	MEDIR_CADA_UNA(&m, n, suma += hash_obtener(hash, clave(&fallos, i)) != NULL);
+	informar("hash", distribucion, n, "obtener_fallo", &m);
+
+	// La iteracion se mide entera: ns_op es por elemento, y los
+	// percentiles y el maximo son del recorrido completo.
+	medicion_empezar(&m);
+	size_t visitados = 0;
+	MEDIR_UNA(&m, n, hash_iterar(hash, contar, &visitados));
+	m.cant = visitados;
+	informar("hash", distribucion, n, "iterar", &m);
+
+	// Entre las dos pasadas de borrar se vuelven a guardar las claves.
+	medicion_empezar(&m);
+	MEDIR_CADA_UNA(&m, n, hash_borrar(hash, clave(&claves, orden_borrado[i])));
+	for(size_t i = 0; i < n; i++)
+		hash_guardar(hash, clave(&claves, i), (void*)clave(&claves, i));
+	MEDIR_CICLO(&m, n, hash_borrar(hash, clave(&claves, orden_borrado[i])));
+	informar("hash", distribucion, n, "borrar", &m);
+	hash_destruir(hash);
+
+	// Guardar con la capacidad reservada, sin redimensiones.
+	medicion_empezar(&m);
+	hash = hash_crear_con_capacidad(NULL, n);
+	if(!hash) return 1;
+	MEDIR_CADA_UNA(&m, n, hash_guardar(hash, clave(&claves, i), (void*)clave(&claves, i)));
+	hash_destruir(hash);
+	hash = hash_crear_con_capacidad(NULL, n);
+	if(!hash) return 1;
+	MEDIR_CICLO(&m, n, hash_guardar(hash, clave(&claves, i), (void*)clave(&claves, i)));
+	informar("hash", distribucion, n, "guardar_reservado", &m);
+
+	hash_destruir(hash);
+	claves_destruir(&claves);
+	claves_destruir(&fallos);
+	free(busquedas);
+	free(orden_borrado);
+	return suma == 2 * n ? 0 : 1;
+}
+
+static bool visitar_lista(void* dato, void* extra){
+	(void)dato;
+	(*(size_t*)extra)++;
+	return true;
+}
+
+static int bench_lista(size_t n){
+	medicion_t m;
+	lista_t* lista = lista_crear();
+	if(!lista) return 1;
+
+	// Entre las dos pasadas de cada operacion se deshace la primera.
+	medicion_empezar(&m);
+	MEDIR_CADA_UNA(&m, n, lista_insertar_ultimo(lista, &m));
+	while(!lista_esta_vacia(lista))
+		lista_borrar_primero(lista);
+	MEDIR_CICLO(&m, n, lista_insertar_ultimo(lista, &m));
+	informar("lista", "secuencial", n, "insertar_ultimo", &m);
+
+	medicion_empezar(&m);
+	size_t visitados = 0;
+	MEDIR_UNA(&m, n, lista_iterar(lista, visitar_lista, &visitados));
+	m.cant = visitados;
+	informar("lista", "secuencial", n, "iterar", &m);
+
+	medicion_empezar(&m);
+	MEDIR_CADA_UNA(&m, n, lista_borrar_primero(lista));
+	for(size_t i = 0; i < n; i++)
+		lista_insertar_ultimo(lista, &m);
+	MEDIR_CICLO(&m, n, lista_borrar_primero(lista));
+	informar("lista", "secuencial", n, "borrar_primero", &m);
+
+	lista_destruir(lista, NULL);
+	return 0;
+}
+
+int main(int argc, char* argv[]){
+	size_t n = 1000000;
+	const char* distribucion = "uniforme";
+	const char* estructura = "hash";
+	for(int i = 1; i + 1 < argc; i += 2){
+		if(strcmp(argv[i], "-n") == 0)
+			n = (size_t)strtoull(argv[i + 1], NULL, 10);
+		else if(strcmp(argv[i], "-d") == 0)
+			distribucion = argv[i + 1];
+		else if(strcmp(argv[i], "-e") == 0)
+			estructura = argv[i + 1];
+	}
+	if(n == 0){
+		fprintf(stderr, "uso: %s [-n cantidad] [-d uniforme|zipf|secuencial|url] [-e hash|lista]\n", argv[0]);
+		return 1;
+	}
+	if(strcmp(estructura, "lista") == 0)
+		return bench_lista(n);
+	return bench_hash(distribucion, n);
+}
@@ -0,0 +1,60 @@
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Bitmap de posiciones ocupadas. Lo usan las implementaciones del hash
+ * para saltear de a 64 las posiciones vacias al recorrer la tabla.
+ */
+
+#define BITS_PALABRA 64
+
+// Devuelve cuantas palabras hacen falta para tam bits.
+static inline size_t bitmap_palabras(size_t tam){
+	return (tam + BITS_PALABRA - 1) / BITS_PALABRA;
+}
+
+static inline void bitmap_marcar(uint64_t *bits, size_t pos){
+	bits[pos / BITS_PALABRA] |= (uint64_t)1 << (pos % BITS_PALABRA);
+}
+
+static inline void bitmap_desmarcar(uint64_t *bits, size_t pos){
+	bits[pos / BITS_PALABRA] &= ~((uint64_t)1 << (pos % BITS_PALABRA));
+}
+
+static inline bool bitmap_esta(const uint64_t *bits, size_t pos){
+	return (bits[pos / BITS_PALABRA] >> (pos % BITS_PALABRA)) & 1;
+}
+
+// Devuelve la posicion del bit en 1 menos significativo de la palabra.
+// Pre: palabra no es 0.
+static inline size_t bitmap_primer_bit(uint64_t palabra){
+#if defined(__GNUC__) || defined(__clang__)
+	return (size_t)__builtin_ctzll(palabra);
+#else
+	size_t n = 0;
+	while(!(palabra & 1)){
+		palabra >>= 1;
+		n++;
+	}
+	return n;
+#endif
+}
+
+// Devuelve la primera posicion marcada mayor o igual a desde, o tam si
+// no hay ninguna.
+static inline size_t bitmap_siguiente(const uint64_t *bits, size_t tam, size_t desde){
+	if(desde >= tam) return tam;
+	size_t i = desde / BITS_PALABRA;
+	size_t palabras = bitmap_palabras(tam);
+	uint64_t palabra = bits[i] & (~(uint64_t)0 << (desde % BITS_PALABRA));
+	while(!palabra){
+		if(++i == palabras) return tam;
+		palabra = bits[i];
+	}
+	return i * BITS_PALABRA + bitmap_primer_bit(palabra);
+}
+
+#endif // BITMAP_H
@@ -1,361 +1,1710 @@
-#include <stdbool.h>
-#include <stddef.h>
-#include <stdlib.h>
-#include <string.h>
-#include "hash.h"
-#include "lista.h"
-#define TAM_INICIAL 1000
-#define COEF_REDIM 2
-#define UMBRAL_MAX 0.7
-#define VALOR_MIN 4
-/* *****************************************************************
- *                DEFINICION DE LOS TIPOS DE DATOS
- * *****************************************************************/
-
-struct campo_hash{
-	char* clave;
-	void* valor;
-}typedef campo_hash_t;
-
-struct hash{
-	lista_t** tabla;
-	size_t tam; //(m que es la capacidad maxima de la estructura)
-	size_t cant; //(n que es la cantidad de elementos que esta en el hash)
-	hash_destruir_dato_t destruir;
-};
-
-struct hash_iter{
-	const hash_t* hash;
-	lista_iter_t* lista_iter;
-	size_t pos;
-	size_t iterados;
-};
-
-bool hash_redimensionar(hash_t* hash, size_t tam_nuevo);
-lista_t** crear_tabla(size_t tam);
-
-/* *****************************************************************
- *                DEFINICION DE FUNCIONES AUXILIARES
- * *****************************************************************/
-/* Funcion hashing, recibe una cadena y el tamaños del hash. Duelve un
- * size_t.
- */
-size_t funcion_hash(const char* s, size_t hash_tam){
-	size_t hashvalue;
-	for(hashvalue = 0; *s != '\0';s++)
-		hashvalue = *s + 11 * hashvalue;
-	return hashvalue % hash_tam;
-}
-
-/* Recibe un puntero a un funcion destruir campo hash y elimina el dato,
- *  la clave y el campo. Si recibe un puntero nulo no hace nada.
- */
-void destruir_campo_hash(hash_destruir_dato_t destruir_dato, campo_hash_t* campo){
-	if(!campo) return;
-	if(destruir_dato)
-		destruir_dato(campo->valor);
-	free(campo->clave);
-	free(campo);
-}
-
-/* Recibe una clave y un dato, y asocicia ambos parametros en un campo
- * La clave es copiada.
- */
-campo_hash_t* crear_campo_hash(const char* clave, void* dato){
-	campo_hash_t* campo_hash = malloc(sizeof(campo_hash_t));
-	if(!campo_hash) return NULL;
-	campo_hash->clave = malloc(sizeof(const char)* strlen(clave)+1);
-	campo_hash->valor = dato;
-	strcpy(campo_hash->clave, clave);
-	return campo_hash;
-}
-
-/* Recibe un puntero a una lista de listas, en el que guarda un campo 
- * hash con la clave y el valor asociado. Si hubo algun problema no guarda
- * el campo y devuelve false.
- */
-bool guardar_campo_hash(const char *clave, void *dato,lista_t** tabla,size_t tam,hash_destruir_dato_t destruir){
-	if(!clave) return false;
-	size_t indice = funcion_hash(clave,tam);
-	campo_hash_t* campo = crear_campo_hash(clave, dato);
-	if(!campo) return false;
-	if(!lista_insertar_ultimo(tabla[indice], campo)){
-		destruir_campo_hash(destruir,campo);
-		return false;
-	}
-	return true;
-}
-
-/* Inicializa una tabla de hash con listas enlazadas (hash abierto)
- * En caso de que hubiera un problema al pedir memoria para la tabla o
- * una lista, devuelve NULL.
- */
-lista_t** crear_tabla(size_t tam){
-	lista_t** tabla = malloc(sizeof(lista_t*)* tam);
-	if(!tabla) return NULL;
-	
-	for(int i = 0; i < tam; i++){
-		tabla[i] = lista_crear();
-		if(!tabla[i]){
-			for(int j=0; j<i;j++)
-				lista_destruir(tabla[j],NULL);
-			free(tabla);
-			return NULL;
-		}
-	}
-	return tabla;
-	
-}
-
-/* Recibe un puntero a un struct hash y busca en el campo hash cuya 
- * clave asignada sea la recibida por parametro, si tal campo no se 
- * encontro devuelve NULL.
- * Pre: el hash fue creado
- * Post: Devuelve el iterador con el campo si fue encontrado.
- */
-lista_iter_t* buscar_campo_hash(const hash_t *hash, const char *clave){
-	size_t pos = funcion_hash(clave, hash->tam);
-
-	lista_iter_t* iter_lista = lista_iter_crear(hash->tabla[pos]);
-	if(!iter_lista) return NULL;
-
-	campo_hash_t* campo;
-	while(!lista_iter_al_final(iter_lista)){
-		campo = lista_iter_ver_actual(iter_lista);
-		if(strcmp(campo->clave,clave) == 0)
-			break;
-		lista_iter_avanzar(iter_lista);
-	}
-	return iter_lista;
-}
-
-/* Recibe una tabla de hash y su tamaño y se encarga en destruir todas 
- * las listas interiores. Si destruir_dato es distinta de NULL se la 
- * aplica sobre el valor de cada campo_hash.
- */
-void destruir_tabla(lista_t** tabla, size_t tam, void destruir_dato(void*)){
-	for(int i = 0; i < tam; i++){
-		campo_hash_t* campo;
-		while((campo = lista_borrar_primero(tabla[i])))
-			destruir_campo_hash(destruir_dato,campo);
-		lista_destruir(tabla[i], NULL);
-	}
-	free(tabla);
-}
-
-/* Modifica el hash pasado por parametro redimensionandolo. Devuelve un
- * Segun si se modifico corretamento o no.
- */
-bool hash_redimensionar(hash_t* hash, size_t tam_nuevo){
-	lista_t** tabla_nueva = crear_tabla(tam_nuevo);
-	hash_iter_t* iter_hash = hash_iter_crear(hash);
-	if(!iter_hash) return false;
-	while(!hash_iter_al_final(iter_hash)){
-        campo_hash_t* campo = lista_iter_ver_actual(iter_hash->lista_iter);
-        if (!guardar_campo_hash(campo->clave,campo->valor,tabla_nueva,tam_nuevo,hash->destruir)){
-			hash_iter_destruir(iter_hash);
-			destruir_tabla(tabla_nueva, tam_nuevo,NULL);
-			return false;
-		}
-        hash_iter_avanzar(iter_hash);
-    }
-	hash_iter_destruir(iter_hash);
-	destruir_tabla(hash->tabla, hash->tam,NULL);
-	hash->tabla = tabla_nueva;
-	hash->tam = tam_nuevo;
-	return true;
-}
-
-/* Recibe un iterador y avanza sobre la tabla hasta encontrar una posicion
- * valida, en esa posicion se ubica el iterdaor de la lista correspondiente
- * Si no se encontro niguna posicion valida el iterador es NULL. 
- */
-bool avanzar_sobre_tabla(hash_iter_t* iter){
-	size_t i = iter->pos;
-	while(i < iter->hash->tam && lista_esta_vacia(iter->hash->tabla[i]))
-		i++;
-	if(i == iter->hash->tam){
-		iter->lista_iter = NULL;
-		return false;
-	}
-	iter->lista_iter = lista_iter_crear(iter->hash->tabla[i]);
-	if(!iter->lista_iter) return false;
-	iter->pos = i;
-	return true;
-}
-
-/* *****************************************************************
- *                    PRIMITIVAS DEL HASH
- * *****************************************************************/
-
-/* Crea el hash
- */
-hash_t* hash_crear(hash_destruir_dato_t destruir_dato){
-	hash_t* hash = malloc(sizeof(hash_t));
-	if (!hash) return NULL;
-	lista_t** tabla = crear_tabla(TAM_INICIAL);
-	if(!tabla){
-		free(hash);
-		return NULL;
-	}
-	hash->tam = TAM_INICIAL;
-	hash->cant = 0;
-	hash->destruir = destruir_dato;
-	hash->tabla = tabla;
-	return hash;
-}
-
-/* Guarda un elemento en el hash, si la clave ya se encuentra en la
- * estructura, la reemplaza. De no poder guardarlo devuelve false.
- * Pre: La estructura hash fue inicializada
- * Post: Se almacenó el par (clave, dato)
- */
-bool hash_guardar(hash_t *hash, const char *clave, void *dato) {
-	if((hash->cant/hash->tam) >= UMBRAL_MAX)
-		hash_redimensionar(hash, hash->tam * COEF_REDIM);
-
-	lista_iter_t* iter =  buscar_campo_hash(hash, clave);
-	if(!iter) return false;
-	campo_hash_t* campo = lista_iter_ver_actual(iter);
-	lista_iter_destruir(iter);
-
-	if(campo){
-		if (hash->destruir)
-			hash->destruir(campo->valor);
-		campo->valor= dato;
-		return true;
-	}
-	if(guardar_campo_hash(clave,dato,hash->tabla,hash->tam,hash->destruir)){
-		hash->cant++;
-		return true;
-	}
-	return false;
-}
-
-/* Borra un elemento del hash y devuelve el dato asociado.  Devuelve
- * NULL si el dato no estaba.
- * Pre: La estructura hash fue inicializada
- * Post: El elemento fue borrado de la estructura y se lo devuelve
- * en el caso de que estuviera guardado. Queda en manos del usuario
- * la memoria de ese dato guardado.
- */
-void* hash_borrar(hash_t *hash, const char *clave){
-	if(hash->cant == 0) return NULL;
-	if((hash->cant* VALOR_MIN)<= hash->tam && hash->cant * COEF_REDIM >= TAM_INICIAL)
-	   hash_redimensionar(hash, hash->cant*COEF_REDIM);
-
-	lista_iter_t* iter =  buscar_campo_hash(hash, clave);
-	if(!iter) return NULL;
-	campo_hash_t* campo = lista_iter_borrar(iter);
-	if(campo){
-		void* dato = campo->valor;
-		destruir_campo_hash(NULL, campo);
-		lista_iter_destruir(iter);
-		hash->cant--;
-		return dato;
-	}
-	lista_iter_destruir(iter);
-	return NULL;
-}
-
-/* Obtiene el valor de un elemento del hash, si la clave no se encuentra
- * devuelve NULL.
- * Pre: La estructura hash fue inicializada
- */
-void* hash_obtener(const hash_t *hash, const char *clave){
-	lista_iter_t* iter =  buscar_campo_hash(hash, clave);
-	if(!iter) return NULL;
-	campo_hash_t* campo = lista_iter_ver_actual(iter);
-	lista_iter_destruir(iter);
-	if(!campo) return NULL;
-	return campo->valor;
-}
-
-/* Determina si clave pertenece o no al hash.
- * Pre: La estructura hash fue inicializada
- */
-bool hash_pertenece(const hash_t* hash, const char* clave){
-	lista_iter_t* iter =  buscar_campo_hash(hash, clave);
-	if(!iter) return false;
-	campo_hash_t* campo = lista_iter_ver_actual(iter);
-	lista_iter_destruir(iter);
-	return campo;
-}
-
-/* Devuelve la cantidad de elementos del hash.
- * Pre: La estructura hash fue inicializada
- */
-size_t hash_cantidad(const hash_t* hash){
-	return hash->cant;
-}
-
-/* Destruye la estructura liberando la memoria pedida y llamando a la función
- * destruir para cada par (clave, dato).
- * Pre: La estructura hash fue inicializada
- * Post: La estructura hash fue destruida
- */
-void hash_destruir(hash_t *hash){
-	destruir_tabla(hash->tabla, hash->tam, hash->destruir);
-	free(hash);
-}
-
-/* Iterador del hash */
-
-/* Crea iterador. Asigna el iterador al primer elemento de la tabla de
- * hash cuya lista no sea vacia. Si todas las listas estan vacias hace
- * referencia a NULL.
- * Pre: el hash fue creado.
- */
-hash_iter_t* hash_iter_crear(const hash_t *hash){
-	hash_iter_t* iter =  malloc(sizeof(hash_iter_t));
-	if(!iter) return NULL;
-	iter->hash = hash;
-	iter->iterados = 0;
-	iter->pos = 0;
-	iter->lista_iter = NULL;
-	if(hash->cant == 0) return iter;
-	avanzar_sobre_tabla(iter);
-	return iter;
-}
-
-/* Avanza iterador sobre un mismo hash.
- * Pre: el iterador fue creado.
- */
-bool hash_iter_avanzar(hash_iter_t *iter){
-	if (hash_iter_al_final(iter)) return false;
-	if (lista_iter_avanzar(iter->lista_iter)&& !lista_iter_al_final(iter->lista_iter)) {
-		iter->iterados++;
-		return true;
-	}
-	lista_iter_destruir(iter->lista_iter);
-	iter->iterados++;
-	iter->pos++;
-	return avanzar_sobre_tabla(iter);
-}
-
-/* Devuelve clave actual, esa clave no se puede modificar ni liberar.
- */
-const char* hash_iter_ver_actual(const hash_iter_t *iter){
-	if(!iter || hash_iter_al_final(iter)) 
-		return NULL;
-	campo_hash_t* actual = lista_iter_ver_actual(iter->lista_iter);
-	return actual->clave;
-}
-
-/* Comprueba si existen nodos siguientes en la lista actual o si
- * existen elemetos de la tabla hash no vacios. De esta manera si hay
- * algun elemento siguiente es posible iterar o no.
- */
-bool hash_iter_al_final(const hash_iter_t *iter){
-	return iter->iterados == iter->hash->cant;
-}
-
-/* Destruye iterador.
- * Pre: el iterador fue creado.
- */
-void hash_iter_destruir(hash_iter_t* iter){
-	if(iter->lista_iter){
-		lista_iter_destruir(iter->lista_iter);
-	}
-	free(iter);
-}
\ No newline at end of file
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hash.h"
+#include "bitmap.h"
+#include "particion.h"
+#include "rueda.h"
+// Politica de redimension por defecto
+#define TAM_INICIAL 1024 // siempre potencia de dos
+#define COEF_REDIM 2
+#define UMBRAL_MAX 0.7
+#define PASOS_MIGRACION 2 // posiciones de la tabla vieja que mueve cada operacion
+#define LARGO_CLAVE_CORTA 15 // claves que se guardan dentro del campo
+#define LOTE 16 // claves que se preparan juntas en las primitivas por lotes
+#define SIN_VENCIMIENTO UINT64_MAX
+#define BITS_PAGINA 6 // las instantaneas copian la tabla de a 64 posiciones
+#define POSICIONES_PAGINA ((size_t)1 << BITS_PAGINA)
+#define RECOLECTAR_CADA 1024 // modificaciones entre recolecciones de instantaneas destruidas
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PRECARGAR(p) __builtin_prefetch(p)
+#else
+#define PRECARGAR(p) ((void)(p))
+#endif
+
+// Cuenta una busqueda en las estadisticas, si se compilo con
+// HASH_CONTADORES o el hash esta en modo cache. Modifica el hash aunque
+// la primitiva lo reciba como const (siempre se lo pide con malloc).
+#ifdef HASH_CONTADORES
+#define CONTAR_SIEMPRE true
+#else
+#define CONTAR_SIEMPRE false
+#endif
+#define CONTAR_BUSQUEDA(hash, encontrada) do{ \
+	if(CONTAR_SIEMPRE || (hash)->cache){ \
+		((hash_t*)(hash))->busquedas++; \
+		if(encontrada) ((hash_t*)(hash))->aciertos++; \
+	} \
+}while(0)
+/* *****************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+struct campo_hash{
+	void* valor;
+	struct campo_hash* sig; // siguiente campo de la misma posicion
+	size_t hash; // valor completo de la funcion de hashing de la clave
+	size_t largo; // largo de la clave, sin contar el '\0'
+	// Las claves de hasta LARGO_CLAVE_CORTA bytes se guardan en el campo
+	// mismo; las mas largas, en memoria aparte.
+	union{
+		char corta[LARGO_CLAVE_CORTA + 1];
+		char* larga;
+	} clave;
+}typedef campo_hash_t;
+
+// En modo cache cada campo se pide con lugar para los enlaces de la
+// lista de uso, del mas nuevo al mas viejo. Como los campos no se mueven
+// al redimensionar, los enlaces siguen siendo validos.
+struct campo_cache{
+	campo_hash_t campo; // primero, para convertir entre los dos punteros
+	struct campo_cache* mas_nuevo;
+	struct campo_cache* mas_viejo;
+	size_t bytes; // lo que sumo a hash->bytes al guardarlo (ver sumar_bytes)
+}typedef campo_cache_t;
+
+// Con vencimientos, cada campo (o campo_cache_t) se pide con lugar para
+// un uint64_t mas al final, con el momento en que vence (ver vencimiento).
+
+// Cada tabla es un arreglo de tam listas enlazadas de campos, seguido de
+// un bitmap con las posiciones no vacias (ver ocupadas).
+struct hash{
+	campo_hash_t** tabla; // cada posicion es una lista enlazada de campos
+	size_t tam; //(m que es la capacidad maxima de la estructura)
+	size_t cant; //(n que es la cantidad de elementos que esta en el hash)
+	hash_destruir_dato_t destruir;
+	hash_funcion_t funcion;
+	uint64_t semilla;
+	hash_politica_t politica;
+	asignador_t asignador;
+	arena_t* arena; // NULL si no se usa el modo arena
+	slab_t campos;  // solo en modo arena
+	size_t tam_campo; // bytes que se piden por campo
+	bool prestadas; // las claves largas son del usuario (ver hash_opciones_t)
+	// Rehash incremental: mientras vieja no sea NULL, sus posiciones desde
+	// migradas en adelante todavia no se movieron a tabla.
+	bool incremental;
+	campo_hash_t** vieja;
+	size_t tam_vieja;
+	size_t migradas;
+	// Modo cache (ver hash_opciones_t)
+	bool cache;
+	size_t cache_entradas;
+	size_t cache_bytes;
+	size_t (*bytes_dato)(const void* dato);
+	size_t bytes;
+	campo_cache_t* mas_nuevo;
+	campo_cache_t* mas_viejo;
+	// Vencimientos (ver hash_opciones_t). Los registros de la rueda
+	// identifican a cada campo por su direccion.
+	rueda_t* rueda; // NULL si no hay vencimientos
+	uint64_t (*reloj)(void);
+	// Estadisticas (ver hash_estadisticas)
+	size_t redimensiones;
+	uint64_t ns_redimension;
+	uint64_t max_ns_redimension;
+	uint64_t busquedas;
+	uint64_t aciertos;
+	size_t desalojos;
+	size_t vencidas;
+	// Instantaneas (ver hash_snapshot), de la mas nueva a la mas vieja.
+	// preservadas[p] es la generacion de la ultima instantanea para la que
+	// se copio la pagina p; es NULL si ninguna lee paginas de la tabla, y
+	// mientras no lo sea no hay un rehash en curso.
+	hash_snapshot_t* instantaneas;
+	uint64_t generacion;
+	uint64_t* preservadas;
+	size_t hasta_recolectar;
+};
+
+// Copia de una pagina de la tabla (o de toda la tabla, si es mas chica)
+// que guardan las instantaneas, con campos y claves propios. La comparten
+// las instantaneas que todavia leian la pagina de la tabla al copiarla.
+struct pagina{
+	size_t refs;
+	campo_hash_t* listas[POSICIONES_PAGINA];
+}typedef pagina_t;
+
+// Cada pagina de una instantanea se lee de su copia o, mientras el hash
+// no la modifique, de la tabla del hash, que entonces tiene el mismo tam.
+struct hash_snapshot{
+	hash_t* hash;
+	pthread_mutex_t mutex; // protege paginas y terminada
+	pagina_t** paginas; // NULL: la pagina se lee de la tabla
+	size_t tam;
+	size_t cant;
+	uint64_t generacion;
+	bool terminada; // el usuario la destruyo (ver recolectar_instantaneas)
+	struct hash_snapshot* sig; // la siguiente mas vieja
+};
+
+// Trabajo de un hilo de hash_construir_paralelo: guardar las claves de
+// la particion p, que caen todas en su propio rango de la tabla.
+struct rango{
+	hash_t* hash;
+	const particion_t* particion;
+	const char* const* claves;
+	void* const* datos;
+	size_t p;
+	size_t cant; // claves nuevas que guardo
+	bool ok;     // false si no hubo memoria
+}typedef rango_t;
+
+bool hash_redimensionar(hash_t* hash, size_t tam_nuevo);
+campo_hash_t** crear_tabla(const hash_t* hash, size_t tam);
+campo_hash_t* guardar_campo(hash_t *hash, const void *clave, size_t largo, uint64_t h, void *dato);
+
+/* *****************************************************************
+ *                DEFINICION DE FUNCIONES AUXILIARES
+ * *****************************************************************/
+/* Devuelve la menor potencia de dos mayor o igual a n.
+ */
+size_t potencia_de_dos(size_t n){
+	size_t tam = 1;
+	while(tam < n)
+		tam <<= 1;
+	return tam;
+}
+
+/* Completa los campos en cero de la politica con los valores por defecto.
+ * Devuelve false si la politica recibida es invalida.
+ */
+bool normalizar_politica(hash_politica_t* politica){
+	if(politica->carga_maxima == 0)
+		politica->carga_maxima = UMBRAL_MAX;
+	if(politica->factor_crecimiento == 0)
+		politica->factor_crecimiento = COEF_REDIM;
+	// Por defecto se achica con la mitad de la carga que queda al crecer.
+	if(politica->carga_minima == 0)
+		politica->carga_minima = politica->carga_maxima / (double)(2 * politica->factor_crecimiento);
+	politica->tam_inicial = politica->tam_inicial ? potencia_de_dos(politica->tam_inicial) : TAM_INICIAL;
+
+	size_t factor = politica->factor_crecimiento;
+	if(politica->carga_maxima <= 0 || factor < 2 || (factor & (factor - 1)) != 0)
+		return false;
+	return politica->nunca_achicar || (politica->carga_minima > 0 &&
+		politica->carga_minima < politica->carga_maxima / (double)factor);
+}
+
+/* Devuelve el tamaño al que hay que llevar la tabla para que la carga
+ * quede por debajo de carga_maxima / factor_crecimiento, o el tamaño
+ * actual si no corresponde achicarla.
+ */
+size_t tam_achicado(const hash_t* hash){
+	const hash_politica_t* politica = &hash->politica;
+	size_t tam = hash->tam;
+	if(politica->nunca_achicar || (double)hash->cant >= politica->carga_minima * (double)tam)
+		return tam;
+	double carga_objetivo = politica->carga_maxima / (double)politica->factor_crecimiento;
+	while(tam / 2 >= politica->tam_inicial && (double)hash->cant <= carga_objetivo * (double)(tam / 2))
+		tam /= 2;
+	return tam;
+}
+
+/* Devuelve el tamaño de tabla necesario para guardar n elementos sin
+ * superar la carga maxima.
+ */
+size_t tam_para(const hash_politica_t* politica, size_t n){
+	return potencia_de_dos((size_t)((double)n / politica->carga_maxima) + 1);
+}
+
+/* Devuelve la clave del campo, este guardada dentro de el o aparte.
+ */
+const char* clave_campo(const campo_hash_t* campo){
+	return campo->largo <= LARGO_CLAVE_CORTA ? campo->clave.corta : campo->clave.larga;
+}
+
+/* Devuelve donde guarda el campo el momento en que vence, al final de lo
+ * que se pidio para el.
+ * Pre: el hash tiene vencimientos.
+ */
+uint64_t* vencimiento(const hash_t* hash, campo_hash_t* campo){
+	return (uint64_t*)((char*)campo + hash->tam_campo) - 1;
+}
+
+/* Devuelve true si el campo tiene vencimiento y ya vencio. Solo consulta
+ * el reloj para los campos con vencimiento.
+ */
+bool vencido(const hash_t* hash, campo_hash_t* campo){
+	if(!hash->rueda) return false;
+	uint64_t vence = *vencimiento(hash, campo);
+	return vence != SIN_VENCIMIENTO && vence <= hash->reloj();
+}
+
+/* Recibe un puntero a un funcion destruir campo hash y elimina el dato,
+ *  la clave y el campo. Si recibe un puntero nulo no hace nada. En modo
+ *  arena el campo vuelve al slab y la clave queda en la arena.
+ */
+void destruir_campo_hash(hash_t* hash, hash_destruir_dato_t destruir_dato, campo_hash_t* campo){
+	if(!campo) return;
+	if(destruir_dato)
+		destruir_dato(campo->valor);
+	if(hash->arena){
+		slab_devolver(&hash->campos, campo);
+		return;
+	}
+	if(campo->largo > LARGO_CLAVE_CORTA && !hash->prestadas)
+		asignador_liberar(&hash->asignador, campo->clave.larga);
+	asignador_liberar(&hash->asignador, campo);
+}
+
+/* Recibe una clave, su largo y su hash, y un dato, y asocicia ambos
+ * parametros en un campo. La clave es copiada; si es corta, dentro del
+ * campo mismo. Con claves prestadas las largas no se copian.
+ */
+campo_hash_t* crear_campo_hash(hash_t* hash, const void* clave, size_t largo, size_t h, void* dato){
+	campo_hash_t* campo_hash;
+	if(hash->arena)
+		campo_hash = slab_pedir(&hash->campos);
+	else
+		campo_hash = asignador_pedir(&hash->asignador, hash->tam_campo);
+	if(!campo_hash) return NULL;
+
+	char* copia = campo_hash->clave.corta;
+	if(largo > LARGO_CLAVE_CORTA && hash->prestadas){
+		copia = NULL;
+		campo_hash->clave.larga = (char*)clave;
+	}else if(largo > LARGO_CLAVE_CORTA){
+		if(hash->arena)
+			copia = arena_pedir(hash->arena, sizeof(const char)* largo+1);
+		else
+			copia = asignador_pedir(&hash->asignador, sizeof(const char)* largo+1);
+		if(!copia){
+			if(hash->arena)
+				slab_devolver(&hash->campos, campo_hash);
+			else
+				asignador_liberar(&hash->asignador, campo_hash);
+			return NULL;
+		}
+		campo_hash->clave.larga = copia;
+	}
+	if(copia){
+		memcpy(copia, clave, largo);
+		copia[largo] = '\0';
+	}
+	campo_hash->valor = dato;
+	campo_hash->sig = NULL;
+	campo_hash->hash = h;
+	campo_hash->largo = largo;
+	if(hash->rueda)
+		*vencimiento(hash, campo_hash) = SIN_VENCIMIENTO;
+	return campo_hash;
+}
+
+/* Inicializa una tabla de hash abierto con todas las posiciones vacias.
+ * En caso de que hubiera un problema al pedir memoria devuelve NULL.
+ */
+campo_hash_t** crear_tabla(const hash_t* hash, size_t tam){
+	size_t bytes_bitmap = sizeof(uint64_t) * bitmap_palabras(tam);
+	campo_hash_t** tabla = asignador_pedir(&hash->asignador, sizeof(campo_hash_t*) * tam + bytes_bitmap);
+	if(!tabla) return NULL;
+	for(size_t i = 0; i < tam; i++)
+		tabla[i] = NULL;
+	memset(tabla + tam, 0, bytes_bitmap);
+	return tabla;
+}
+
+/* Devuelve el bitmap de la tabla, guardado a continuacion de sus tam
+ * posiciones. El bit de una posicion esta en 1 si y solo si su lista no
+ * esta vacia.
+ */
+uint64_t* ocupadas(campo_hash_t** tabla, size_t tam){
+	return (uint64_t*)(tabla + tam);
+}
+
+/* Desmarca en el bitmap las posiciones del hash h que hayan quedado
+ * vacias, tanto en la tabla como en la tabla vieja si la hay.
+ */
+void actualizar_ocupadas(hash_t* hash, size_t h){
+	size_t pos = h & (hash->tam - 1);
+	if(!hash->tabla[pos])
+		bitmap_desmarcar(ocupadas(hash->tabla, hash->tam), pos);
+	if(hash->vieja){
+		pos = h & (hash->tam_vieja - 1);
+		if(!hash->vieja[pos])
+			bitmap_desmarcar(ocupadas(hash->vieja, hash->tam_vieja), pos);
+	}
+}
+
+/* Recorre la lista de campos que empieza en enlace buscando la clave.
+ * Devuelve el enlace que apunta al campo, o el enlace final (que apunta
+ * a NULL) si la clave no esta.
+ */
+campo_hash_t** buscar_en_posicion(campo_hash_t** enlace, const void *clave, size_t largo, size_t h){
+	while(*enlace){
+		campo_hash_t* campo = *enlace;
+		if(campo->hash == h && campo->largo == largo && memcmp(clave_campo(campo), clave, largo) == 0)
+			break;
+		enlace = &campo->sig;
+	}
+	return enlace;
+}
+
+/* Guarda las claves de la particion del rango. Como solo toca las
+ * posiciones del rango (que empieza y termina en un borde de palabra del
+ * bitmap), corre en paralelo con los demas rangos sin candados.
+ */
+void armar_rango(void* arg){
+	rango_t* rango = arg;
+	hash_t* hash = rango->hash;
+	const particion_t* particion = rango->particion;
+	for(size_t k = particion->inicio[rango->p]; k < particion->inicio[rango->p + 1]; k++){
+		size_t i = particion->orden[k];
+		size_t h = (size_t)particion->hs[i];
+		size_t pos = h & (hash->tam - 1);
+		campo_hash_t** enlace = buscar_en_posicion(&hash->tabla[pos], rango->claves[i], particion->largos[i], h);
+		if(*enlace){
+			if(hash->destruir)
+				hash->destruir((*enlace)->valor);
+			(*enlace)->valor = rango->datos[i];
+			continue;
+		}
+		campo_hash_t* campo = crear_campo_hash(hash, rango->claves[i], particion->largos[i], h, rango->datos[i]);
+		if(!campo){
+			rango->ok = false;
+			return;
+		}
+		*enlace = campo;
+		bitmap_marcar(ocupadas(hash->tabla, hash->tam), pos);
+		rango->cant++;
+	}
+}
+
+/* Recibe un puntero a un struct hash y busca el campo cuya clave sea la
+ * recibida por parametro, de largo y hash ya calculados. Durante un
+ * rehash incremental busca tanto en la tabla vieja como en la nueva; si
+ * la clave no esta, el enlace devuelto es el de la tabla nueva. Devuelve la
+ * direccion del enlace que apunta a ese campo (la posicion de la tabla o
+ * el sig del campo anterior), de modo que se lo pueda leer, reemplazar o
+ * desenlazar sin volver a recorrer. Si la clave no esta, el enlace
+ * devuelto apunta a NULL. Los campos con otro hash u otro largo se
+ * descartan sin leer su clave. No pide memoria.
+ * Pre: el hash fue creado
+ */
+campo_hash_t** buscar_enlace(const hash_t *hash, const void *clave, size_t largo, size_t h){
+	if(hash->vieja){
+		size_t pos = h & (hash->tam_vieja - 1);
+		if(pos >= hash->migradas){
+			campo_hash_t** enlace = buscar_en_posicion(&hash->vieja[pos], clave, largo, h);
+			if(*enlace) return enlace;
+		}
+	}
+	return buscar_en_posicion(&hash->tabla[h & (hash->tam - 1)], clave, largo, h);
+}
+
+/* Devuelve cuantas paginas de instantanea tiene una tabla de tam
+ * posiciones.
+ */
+size_t cantidad_paginas(size_t tam){
+	return (tam + POSICIONES_PAGINA - 1) >> BITS_PAGINA;
+}
+
+/* Libera una pagina copiada con copiar_pagina, con el mismo asignador.
+ */
+void liberar_pagina(const hash_t* hash, pagina_t* pagina, const asignador_t* asignador){
+	for(size_t i = 0; i < POSICIONES_PAGINA; i++){
+		campo_hash_t* campo = pagina->listas[i];
+		while(campo){
+			campo_hash_t* sig = campo->sig;
+			if(campo->largo > LARGO_CLAVE_CORTA && !hash->prestadas)
+				asignador_liberar(asignador, campo->clave.larga);
+			asignador_liberar(asignador, campo);
+			campo = sig;
+		}
+	}
+	asignador_liberar(asignador, pagina);
+}
+
+/* Copia la pagina p de la tabla con campos y claves pedidos al asignador,
+ * sin los enlaces del modo cache ni el vencimiento. No modifica el hash,
+ * asi que una instantanea la puede llamar desde otro hilo. Devuelve NULL
+ * si no hay memoria.
+ * Pre: no hay un rehash en curso.
+ */
+pagina_t* copiar_pagina(const hash_t* hash, size_t p, const asignador_t* asignador){
+	pagina_t* pagina = asignador_pedir(asignador, sizeof(pagina_t));
+	if(!pagina) return NULL;
+	pagina->refs = 0;
+	for(size_t i = 0; i < POSICIONES_PAGINA; i++)
+		pagina->listas[i] = NULL;
+	size_t base = p << BITS_PAGINA;
+	size_t n = hash->tam - base < POSICIONES_PAGINA ? hash->tam - base : POSICIONES_PAGINA;
+	for(size_t i = 0; i < n; i++){
+		campo_hash_t** enlace = &pagina->listas[i];
+		for(campo_hash_t* campo = hash->tabla[base + i]; campo; campo = campo->sig){
+			campo_hash_t* copia = asignador_pedir(asignador, sizeof(campo_hash_t));
+			if(!copia){
+				liberar_pagina(hash, pagina, asignador);
+				return NULL;
+			}
+			*copia = *campo;
+			copia->sig = NULL;
+			if(campo->largo > LARGO_CLAVE_CORTA && !hash->prestadas){
+				copia->clave.larga = asignador_pedir(asignador, campo->largo + 1);
+				if(!copia->clave.larga){
+					asignador_liberar(asignador, copia);
+					liberar_pagina(hash, pagina, asignador);
+					return NULL;
+				}
+				memcpy(copia->clave.larga, campo->clave.larga, campo->largo + 1);
+			}
+			*enlace = copia;
+			enlace = &copia->sig;
+		}
+	}
+	return pagina;
+}
+
+/* Libera la instantanea, y las copias de paginas que ya no usa ninguna
+ * otra.
+ * Pre: el usuario la destruyo, o se esta destruyendo el hash.
+ */
+void liberar_instantanea(hash_t* hash, hash_snapshot_t* instantanea){
+	size_t cant_paginas = cantidad_paginas(instantanea->tam);
+	for(size_t p = 0; p < cant_paginas; p++){
+		pagina_t* pagina = instantanea->paginas[p];
+		if(pagina && --pagina->refs == 0)
+			liberar_pagina(hash, pagina, &hash->asignador);
+	}
+	pthread_mutex_destroy(&instantanea->mutex);
+	asignador_liberar(&hash->asignador, instantanea->paginas);
+	asignador_liberar(&hash->asignador, instantanea);
+}
+
+/* Libera las instantaneas que el usuario ya destruyo. Como
+ * hash_snapshot_destruir puede correr en otro hilo, solo las marca, y la
+ * memoria (pedida al asignador del hash) se libera aca. Si no queda
+ * ninguna, ya no hay paginas que copiar.
+ */
+void recolectar_instantaneas(hash_t* hash){
+	hash_snapshot_t** enlace = &hash->instantaneas;
+	while(*enlace){
+		hash_snapshot_t* instantanea = *enlace;
+		pthread_mutex_lock(&instantanea->mutex);
+		bool terminada = instantanea->terminada;
+		pthread_mutex_unlock(&instantanea->mutex);
+		if(terminada){
+			*enlace = instantanea->sig;
+			liberar_instantanea(hash, instantanea);
+		}else{
+			enlace = &instantanea->sig;
+		}
+	}
+	hash->hasta_recolectar = RECOLECTAR_CADA;
+	if(!hash->instantaneas && hash->preservadas){
+		asignador_liberar(&hash->asignador, hash->preservadas);
+		hash->preservadas = NULL;
+	}
+}
+
+/* Se llama antes de modificar la pagina p de la tabla: la copia para las
+ * instantaneas que todavia la leen de la tabla (las de generacion mayor a
+ * preservadas[p]), que desde entonces leen la copia. Cada RECOLECTAR_CADA
+ * llamadas, ademas, libera las instantaneas destruidas. Devuelve false si
+ * no hay memoria para la copia.
+ */
+bool preservar_pagina(hash_t* hash, size_t p){
+	if(!hash->instantaneas) return true;
+	if(--hash->hasta_recolectar == 0 || (hash->preservadas && hash->preservadas[p] != hash->generacion))
+		recolectar_instantaneas(hash);
+	if(!hash->preservadas || hash->preservadas[p] == hash->generacion)
+		return true;
+	size_t refs = 0;
+	for(hash_snapshot_t* instantanea = hash->instantaneas; instantanea && instantanea->generacion > hash->preservadas[p]; instantanea = instantanea->sig)
+		refs++;
+	if(refs){
+		pagina_t* copia = copiar_pagina(hash, p, &hash->asignador);
+		if(!copia) return false;
+		copia->refs = refs;
+		for(hash_snapshot_t* instantanea = hash->instantaneas; instantanea && instantanea->generacion > hash->preservadas[p]; instantanea = instantanea->sig){
+			pthread_mutex_lock(&instantanea->mutex);
+			instantanea->paginas[p] = copia;
+			pthread_mutex_unlock(&instantanea->mutex);
+		}
+	}
+	hash->preservadas[p] = hash->generacion;
+	return true;
+}
+
+/* Preserva la pagina de la posicion del hash h en la tabla.
+ */
+bool preservar_posicion(hash_t* hash, size_t h){
+	return preservar_pagina(hash, (h & (hash->tam - 1)) >> BITS_PAGINA);
+}
+
+/* Preserva todas las paginas, antes de una modificacion que puede mover
+ * campos de cualquier posicion. Despues ninguna instantanea lee de la
+ * tabla. Devuelve false si no hay memoria; las paginas ya copiadas quedan.
+ */
+bool preservar_todo(hash_t* hash){
+	size_t cant_paginas = cantidad_paginas(hash->tam);
+	for(size_t p = 0; p < cant_paginas && hash->preservadas; p++){
+		if(!preservar_pagina(hash, p))
+			return false;
+	}
+	if(hash->preservadas){
+		asignador_liberar(&hash->asignador, hash->preservadas);
+		hash->preservadas = NULL;
+	}
+	return true;
+}
+
+/* Busca la clave en la instantanea, en la copia de su pagina o en la
+ * tabla del hash, con el mutex tomado para que el hash no copie la pagina
+ * y la modifique mientras tanto. Si la encuentra guarda su dato en dato.
+ */
+bool buscar_en_instantanea(const hash_snapshot_t* snapshot, const void* clave, size_t largo, void** dato){
+	hash_snapshot_t* instantanea = (hash_snapshot_t*)snapshot;
+	const hash_t* hash = instantanea->hash;
+	size_t h = (size_t)hash_calcular(hash, clave, largo);
+	size_t pos = h & (instantanea->tam - 1);
+	pthread_mutex_lock(&instantanea->mutex);
+	pagina_t* pagina = instantanea->paginas[pos >> BITS_PAGINA];
+	campo_hash_t** lista = pagina ? &pagina->listas[pos & (POSICIONES_PAGINA - 1)] : &hash->tabla[pos];
+	campo_hash_t* campo = *buscar_en_posicion(lista, clave, largo, h);
+	if(campo)
+		*dato = campo->valor;
+	pthread_mutex_unlock(&instantanea->mutex);
+	return campo != NULL;
+}
+
+/* Devuelve cuantos bytes cuenta para cache_bytes una clave de largo
+ * bytes con el dato recibido.
+ */
+size_t bytes_entrada(const hash_t* hash, size_t largo, const void* dato){
+	size_t bytes = largo + 1;
+	if(hash->bytes_dato && dato)
+		bytes += hash->bytes_dato(dato);
+	return bytes;
+}
+
+/* Suma bytes a los del modo cache y los anota en el campo, para restar
+ * lo mismo al sacarlo: el dato puede cambiar despues (con
+ * hash_obtener_ptr, o cambiar de tamaño) y bytes_dato dar otra cosa.
+ */
+void sumar_bytes(hash_t* hash, campo_hash_t* campo, size_t bytes){
+	((campo_cache_t*)campo)->bytes = bytes;
+	hash->bytes += bytes;
+}
+
+/* Resta de los bytes del modo cache lo que sumo el campo.
+ */
+void restar_bytes(hash_t* hash, const campo_hash_t* campo){
+	hash->bytes -= ((const campo_cache_t*)campo)->bytes;
+}
+
+/* Desenlaza el campo de la lista de uso.
+ */
+void quitar_de_uso(hash_t* hash, campo_hash_t* campo){
+	campo_cache_t* nodo = (campo_cache_t*)campo;
+	if(nodo->mas_nuevo)
+		nodo->mas_nuevo->mas_viejo = nodo->mas_viejo;
+	else
+		hash->mas_nuevo = nodo->mas_viejo;
+	if(nodo->mas_viejo)
+		nodo->mas_viejo->mas_nuevo = nodo->mas_nuevo;
+	else
+		hash->mas_viejo = nodo->mas_nuevo;
+}
+
+/* Enlaza el campo al principio de la lista de uso, como el mas nuevo.
+ */
+void agregar_a_uso(hash_t* hash, campo_hash_t* campo){
+	campo_cache_t* nodo = (campo_cache_t*)campo;
+	nodo->mas_nuevo = NULL;
+	nodo->mas_viejo = hash->mas_nuevo;
+	if(hash->mas_nuevo)
+		hash->mas_nuevo->mas_nuevo = nodo;
+	else
+		hash->mas_viejo = nodo;
+	hash->mas_nuevo = nodo;
+}
+
+/* Marca el campo como el usado mas recientemente, si el hash esta en
+ * modo cache.
+ */
+void usar_campo(hash_t* hash, campo_hash_t* campo){
+	if(!hash->cache || hash->mas_nuevo == (campo_cache_t*)campo) return;
+	quitar_de_uso(hash, campo);
+	agregar_a_uso(hash, campo);
+}
+
+/* Devuelve true si guardar una clave nueva de bytes_nuevos bytes
+ * superaria los limites del modo cache.
+ */
+bool excede_cache(const hash_t* hash, size_t bytes_nuevos){
+	return (hash->cache_entradas && hash->cant + 1 > hash->cache_entradas)
+		|| (hash->cache_bytes && hash->bytes + bytes_nuevos > hash->cache_bytes);
+}
+
+/* Desaloja el campo usado hace mas tiempo, destruyendo su dato. Devuelve
+ * false si no hay memoria para preservar su pagina.
+ * Pre: el hash esta en modo cache y no esta vacio.
+ */
+bool desalojar(hash_t* hash){
+	campo_hash_t* campo = &hash->mas_viejo->campo;
+	if(!preservar_posicion(hash, campo->hash))
+		return false;
+	campo_hash_t** enlace = buscar_enlace(hash, clave_campo(campo), campo->largo, campo->hash);
+	*enlace = campo->sig;
+	actualizar_ocupadas(hash, campo->hash);
+	quitar_de_uso(hash, campo);
+	restar_bytes(hash, campo);
+	hash->cant--;
+	hash->desalojos++;
+	destruir_campo_hash(hash, hash->destruir, campo);
+	return true;
+}
+
+/* Desenlaza el campo vencido al que apunta enlace y lo destruye junto con
+ * su dato.
+ */
+void expirar_campo(hash_t* hash, campo_hash_t** enlace){
+	campo_hash_t* campo = *enlace;
+	*enlace = campo->sig;
+	actualizar_ocupadas(hash, campo->hash);
+	if(hash->cache){
+		quitar_de_uso(hash, campo);
+		restar_bytes(hash, campo);
+	}
+	hash->cant--;
+	hash->vencidas++;
+	destruir_campo_hash(hash, hash->destruir, campo);
+}
+
+/* Busca la clave como buscar_enlace, pero si vencio la borra (salvo que
+ * no haya memoria para preservar su pagina) y devuelve NULL. Por eso
+ * modifica el hash aunque lo reciba como const.
+ */
+campo_hash_t* buscar_vigente(const hash_t* hash, const void* clave, size_t largo, size_t h){
+	campo_hash_t** enlace = buscar_enlace(hash, clave, largo, h);
+	if(*enlace && vencido(hash, *enlace)){
+		if(preservar_posicion((hash_t*)hash, h))
+			expirar_campo((hash_t*)hash, enlace);
+		return NULL;
+	}
+	return *enlace;
+}
+
+/* Guarda en el campo el momento en que vence y lo registra en la rueda.
+ * Si no hay memoria para registrarlo, lo deja sin vencimiento y devuelve
+ * false.
+ */
+bool fijar_vencimiento(hash_t* hash, campo_hash_t* campo, uint64_t vence){
+	*vencimiento(hash, campo) = vence;
+	if(vence == SIN_VENCIMIENTO || rueda_agregar(hash->rueda, campo->hash, campo, vence))
+		return true;
+	*vencimiento(hash, campo) = SIN_VENCIMIENTO;
+	return false;
+}
+
+/* Devuelve el enlace al campo de un registro de la rueda, o NULL si el
+ * campo ya no esta o cambio de vencimiento. Compara direcciones sin leer
+ * el campo del registro, que puede haberse liberado.
+ */
+campo_hash_t** buscar_registro(hash_t* hash, const rueda_registro_t* registro){
+	size_t h = (size_t)registro->h;
+	campo_hash_t** enlaces[2] = {&hash->tabla[h & (hash->tam - 1)], NULL};
+	if(hash->vieja && (h & (hash->tam_vieja - 1)) >= hash->migradas)
+		enlaces[1] = &hash->vieja[h & (hash->tam_vieja - 1)];
+	for(size_t i = 0; i < 2 && enlaces[i]; i++){
+		for(campo_hash_t** enlace = enlaces[i]; *enlace; enlace = &(*enlace)->sig){
+			if((const void*)*enlace == registro->id)
+				return *vencimiento(hash, *enlace) == registro->vence ? enlace : NULL;
+		}
+	}
+	return NULL;
+}
+
+/* Recibe una tabla de hash y su tamaño y se encarga en destruir todos
+ * los campos. Si destruir_dato es distinta de NULL se la aplica sobre
+ * el valor de cada campo_hash. En modo arena sin destruir_dato no hace
+ * falta recorrer los campos: se liberan junto con la arena.
+ */
+void destruir_tabla(hash_t* hash, campo_hash_t** tabla, size_t tam, void destruir_dato(void*)){
+	for(size_t i = 0; i < tam && (destruir_dato || !hash->arena); i++){
+		campo_hash_t* campo = tabla[i];
+		while(campo){
+			campo_hash_t* sig = campo->sig;
+			destruir_campo_hash(hash, destruir_dato,campo);
+			campo = sig;
+		}
+	}
+	asignador_liberar(&hash->asignador, tabla);
+}
+
+/* Enlaza todos los campos de la posicion pos de la tabla en la tabla
+ * nueva, sin copiarlos ni recalcular su hash, y deja la posicion vacia.
+ */
+void mover_posicion(campo_hash_t** tabla, size_t tam, size_t pos, campo_hash_t** tabla_nueva, size_t tam_nuevo){
+	campo_hash_t* campo = tabla[pos];
+	while(campo){
+		campo_hash_t* sig = campo->sig;
+		size_t indice = campo->hash & (tam_nuevo - 1);
+		campo->sig = tabla_nueva[indice];
+		tabla_nueva[indice] = campo;
+		bitmap_marcar(ocupadas(tabla_nueva, tam_nuevo), indice);
+		campo = sig;
+	}
+	tabla[pos] = NULL;
+	bitmap_desmarcar(ocupadas(tabla, tam), pos);
+}
+
+/* Mueve a la tabla nueva como mucho pasos posiciones no vacias de la
+ * tabla vieja, salteando las vacias con el bitmap. Cuando la tabla vieja
+ * queda vacia la libera.
+ */
+void migrar(hash_t* hash, size_t pasos){
+	if(!hash->vieja) return;
+	uint64_t* bits = ocupadas(hash->vieja, hash->tam_vieja);
+	for(; pasos > 0; pasos--){
+		hash->migradas = bitmap_siguiente(bits, hash->tam_vieja, hash->migradas);
+		if(hash->migradas == hash->tam_vieja) break;
+		mover_posicion(hash->vieja, hash->tam_vieja, hash->migradas++, hash->tabla, hash->tam);
+	}
+	if(bitmap_siguiente(bits, hash->tam_vieja, hash->migradas) == hash->tam_vieja){
+		asignador_liberar(&hash->asignador, hash->vieja);
+		hash->vieja = NULL;
+		hash->tam_vieja = 0;
+		hash->migradas = 0;
+	}
+}
+
+/* Devuelve el reloj monotono del sistema en nanosegundos.
+ */
+uint64_t ahora_ns(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+/* Suma a las estadisticas una redimension que empezo en inicio (segun
+ * ahora_ns).
+ */
+void registrar_redimension(hash_t* hash, uint64_t inicio){
+	uint64_t ns = ahora_ns() - inicio;
+	hash->redimensiones++;
+	hash->ns_redimension += ns;
+	if(ns > hash->max_ns_redimension)
+		hash->max_ns_redimension = ns;
+}
+
+/* Modifica el hash pasado por parametro redimensionandolo. Devuelve false
+ * si no se pudo pedir memoria para la tabla nueva (o para preservar las
+ * paginas de las instantaneas), en cuyo caso el hash no cambia. En modo
+ * incremental solo crea la tabla nueva: los campos se mueven de a poco en
+ * cada guardar y borrar (si habia un rehash en curso, primero lo termina).
+ */
+bool hash_redimensionar(hash_t* hash, size_t tam_nuevo){
+	uint64_t inicio = ahora_ns();
+	if(!preservar_todo(hash)) return false;
+	campo_hash_t** tabla_nueva = crear_tabla(hash, tam_nuevo);
+	if(!tabla_nueva) return false;
+	if(hash->vieja)
+		migrar(hash, hash->tam_vieja);
+	if(hash->incremental){
+		hash->vieja = hash->tabla;
+		hash->tam_vieja = hash->tam;
+		hash->migradas = 0;
+	}else{
+		uint64_t* bits = ocupadas(hash->tabla, hash->tam);
+		for(size_t i = bitmap_siguiente(bits, hash->tam, 0); i < hash->tam; i = bitmap_siguiente(bits, hash->tam, i + 1))
+			mover_posicion(hash->tabla, hash->tam, i, tabla_nueva, tam_nuevo);
+		asignador_liberar(&hash->asignador, hash->tabla);
+	}
+	hash->tabla = tabla_nueva;
+	hash->tam = tam_nuevo;
+	registrar_redimension(hash, inicio);
+	return true;
+}
+
+/* Calcula el largo y el hash de las cant claves de un lote, y pide al
+ * procesador la posicion de la tabla de cada una. En una segunda pasada,
+ * cuando esas posiciones ya suelen estar en cache, pide el primer campo
+ * de cada lista, de modo que las esperas se superponen en lugar de
+ * sumarse.
+ * Pre: cant es como mucho LOTE
+ */
+void preparar_lote(const hash_t* hash, const char* const claves[], size_t cant, size_t largos[], uint64_t hs[]){
+	for(size_t i = 0; i < cant; i++){
+		largos[i] = strlen(claves[i]);
+		hs[i] = hash_calcular(hash, claves[i], largos[i]);
+		PRECARGAR(&hash->tabla[hs[i] & (hash->tam - 1)]);
+		if(hash->vieja)
+			PRECARGAR(&hash->vieja[hs[i] & (hash->tam_vieja - 1)]);
+	}
+	for(size_t i = 0; i < cant; i++)
+		PRECARGAR(hash->tabla[hs[i] & (hash->tam - 1)]);
+}
+
+/* Devuelve true si los campos de origen se pueden enlazar en destino sin
+ * copiarlos: los dos los piden al mismo asignador, fuera de una arena,
+ * sin los enlaces del modo cache ni vencimientos, y con claves prestadas
+ * los dos o ninguno.
+ */
+bool campos_compatibles(const hash_t* destino, const hash_t* origen){
+	return !destino->arena && !origen->arena && !destino->cache && !origen->cache
+		&& !destino->rueda && !origen->rueda
+		&& destino->prestadas == origen->prestadas
+		&& destino->asignador.pedir == origen->asignador.pedir
+		&& destino->asignador.liberar == origen->asignador.liberar
+		&& destino->asignador.ctx == origen->asignador.ctx;
+}
+
+/* Pasa a destino los campos de una tabla de origen (la actual o la vieja)
+ * segun politica. Si mover es true los enlaza en destino; si no, guarda
+ * una copia y libera el campo de origen. Devuelve false si no hay memoria.
+ */
+bool fusionar_tabla(hash_t* destino, hash_t* origen, campo_hash_t** tabla, size_t tam, hash_fusion_t politica, bool mover){
+	bool mismo_hash = destino->funcion == origen->funcion && destino->semilla == origen->semilla;
+	uint64_t* bits = ocupadas(tabla, tam);
+	bool ok = true;
+	for(size_t i = bitmap_siguiente(bits, tam, 0); i < tam && ok; i = bitmap_siguiente(bits, tam, i + 1)){
+		campo_hash_t** enlace_origen = &tabla[i];
+		while(*enlace_origen){
+			campo_hash_t* campo = *enlace_origen;
+			if(mover && destino->vieja)
+				migrar(destino, PASOS_MIGRACION);
+			size_t h = mismo_hash ? campo->hash : (size_t)hash_calcular(destino, clave_campo(campo), campo->largo);
+			campo_hash_t** enlace = buscar_enlace(destino, clave_campo(campo), campo->largo, h);
+			if(*enlace && politica == HASH_FUSION_UNION){
+				enlace_origen = &campo->sig;
+				continue;
+			}
+			if(!mover){
+				campo_hash_t* copia = guardar_campo(destino, clave_campo(campo), campo->largo, h, campo->valor);
+				if(!copia){
+					ok = false;
+					break;
+				}
+				// Sin memoria para el vencimiento la clave pasa igual, sin
+				// vencimiento: el dato ya es de destino.
+				if(origen->rueda && destino->rueda)
+					ok = fijar_vencimiento(destino, copia, *vencimiento(origen, campo));
+				*enlace_origen = campo->sig;
+				if(origen->cache){
+					quitar_de_uso(origen, campo);
+					restar_bytes(origen, campo);
+				}
+				destruir_campo_hash(origen, NULL, campo);
+			}else if(*enlace){
+				if(destino->destruir)
+					destino->destruir((*enlace)->valor);
+				(*enlace)->valor = campo->valor;
+				*enlace_origen = campo->sig;
+				destruir_campo_hash(origen, NULL, campo);
+			}else{
+				*enlace_origen = campo->sig;
+				campo->hash = h;
+				campo->sig = NULL;
+				*enlace = campo;
+				bitmap_marcar(ocupadas(destino->tabla, destino->tam), h & (destino->tam - 1));
+				destino->cant++;
+			}
+			origen->cant--;
+			if(!ok) break;
+		}
+		if(!tabla[i])
+			bitmap_desmarcar(bits, i);
+	}
+	return ok;
+}
+
+/* Devuelve la lista de la posicion pos del recorrido del iterador. Si hay
+ * un rehash en curso, las primeras posiciones son las de la tabla vieja.
+ */
+campo_hash_t* posicion_iter(const hash_t* hash, size_t pos){
+	if(pos < hash->tam_vieja)
+		return hash->vieja[pos];
+	return hash->tabla[pos - hash->tam_vieja];
+}
+
+/* Recibe un iterador y avanza sobre la tabla desde iter->pos hasta
+ * encontrar una posicion no vacia, y ubica al iterador en su primer
+ * campo. Si no hay ninguna, el campo actual queda en NULL. Las posiciones
+ * vacias se saltean de a 64 con el bitmap.
+ */
+bool avanzar_sobre_tabla(hash_iter_t* iter){
+	const hash_t* hash = iter->hash;
+	size_t total = hash->tam_vieja + hash->tam;
+	size_t i = iter->pos;
+	if(i < hash->tam_vieja)
+		i = bitmap_siguiente(ocupadas(hash->vieja, hash->tam_vieja), hash->tam_vieja, i);
+	if(i >= hash->tam_vieja)
+		i = hash->tam_vieja + bitmap_siguiente(ocupadas(hash->tabla, hash->tam), hash->tam, i - hash->tam_vieja);
+	iter->pos = i;
+	if(i == total){
+		iter->actual = NULL;
+		return false;
+	}
+	iter->actual = posicion_iter(iter->hash, i);
+	return true;
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DEL HASH
+ * *****************************************************************/
+
+/* Crea el hash
+ */
+hash_t* hash_crear(hash_destruir_dato_t destruir_dato){
+	return hash_crear_con_opciones(destruir_dato, NULL);
+}
+
+/* Crea el hash con las opciones recibidas. Si opciones es NULL usa las
+ * predeterminadas. Devuelve NULL si la politica es invalida.
+ */
+hash_t* hash_crear_con_opciones(hash_destruir_dato_t destruir_dato, const hash_opciones_t* opciones){
+	hash_politica_t politica = {0};
+	if(opciones)
+		politica = opciones->politica;
+	if(!normalizar_politica(&politica)) return NULL;
+
+	asignador_t asignador = {0};
+	if(opciones)
+		asignador = opciones->asignador;
+	hash_t* hash = asignador_pedir(&asignador, sizeof(hash_t));
+	if (!hash) return NULL;
+	hash->asignador = asignador;
+	hash->cache_entradas = opciones ? opciones->cache_entradas : 0;
+	hash->cache_bytes = opciones ? opciones->cache_bytes : 0;
+	hash->bytes_dato = opciones ? opciones->bytes_dato : NULL;
+	hash->cache = hash->cache_entradas || hash->cache_bytes;
+	hash->bytes = 0;
+	hash->mas_nuevo = NULL;
+	hash->mas_viejo = NULL;
+	hash->prestadas = opciones && opciones->claves_prestadas;
+	hash->tam_campo = hash->cache ? sizeof(campo_cache_t) : sizeof(campo_hash_t);
+	hash->reloj = opciones && opciones->reloj ? opciones->reloj : rueda_reloj;
+	hash->rueda = NULL;
+	if(opciones && opciones->vencimientos){
+		hash->tam_campo += sizeof(uint64_t);
+		hash->rueda = rueda_crear(&asignador, hash->reloj());
+		if(!hash->rueda){
+			asignador_liberar(&asignador, hash);
+			return NULL;
+		}
+	}
+	hash->arena = NULL;
+	if(opciones && opciones->arena){
+		hash->arena = arena_crear(&asignador);
+		if(!hash->arena){
+			if(hash->rueda)
+				rueda_destruir(hash->rueda);
+			asignador_liberar(&asignador, hash);
+			return NULL;
+		}
+		slab_inicializar(&hash->campos, hash->arena, hash->tam_campo);
+	}
+	campo_hash_t** tabla = crear_tabla(hash, politica.tam_inicial);
+	if(!tabla){
+		if(hash->arena)
+			arena_destruir(hash->arena);
+		if(hash->rueda)
+			rueda_destruir(hash->rueda);
+		asignador_liberar(&asignador, hash);
+		return NULL;
+	}
+	hash->politica = politica;
+	hash->tam = politica.tam_inicial;
+	hash->cant = 0;
+	hash->destruir = destruir_dato;
+	hash->tabla = tabla;
+	hash->funcion = HASH_FUNCION_PREDETERMINADA;
+	hash->semilla = 0;
+	hash->incremental = false;
+	hash->vieja = NULL;
+	hash->tam_vieja = 0;
+	hash->migradas = 0;
+	hash->redimensiones = 0;
+	hash->ns_redimension = 0;
+	hash->max_ns_redimension = 0;
+	hash->busquedas = 0;
+	hash->aciertos = 0;
+	hash->desalojos = 0;
+	hash->vencidas = 0;
+	hash->instantaneas = NULL;
+	hash->generacion = 0;
+	hash->preservadas = NULL;
+	hash->hasta_recolectar = RECOLECTAR_CADA;
+	if(opciones){
+		if(opciones->funcion)
+			hash->funcion = opciones->funcion;
+		hash->semilla = opciones->semilla;
+		hash->incremental = opciones->rehash_incremental;
+	}
+	if(!hash->semilla)
+		hash->semilla = hash_semilla_aleatoria(hash);
+	return hash;
+}
+
+/* Crea el hash con lugar para capacidad elementos sin redimensionar.
+ */
+hash_t* hash_crear_con_capacidad(hash_destruir_dato_t destruir_dato, size_t capacidad){
+	hash_opciones_t opciones = {0};
+	opciones.politica.carga_maxima = UMBRAL_MAX;
+	opciones.politica.tam_inicial = tam_para(&opciones.politica, capacidad);
+	return hash_crear_con_opciones(destruir_dato, &opciones);
+}
+
+/* Guarda un elemento en el hash, si la clave ya se encuentra en la
+ * estructura, la reemplaza. De no poder guardarlo devuelve false.
+ * Pre: La estructura hash fue inicializada
+ * Post: Se almacenó el par (clave, dato)
+ */
+bool hash_guardar(hash_t *hash, const char *clave, void *dato) {
+	if(!clave) return false;
+	return hash_guardar_n(hash, clave, strlen(clave), dato);
+}
+
+/* Borra un elemento del hash y devuelve el dato asociado.  Devuelve
+ * NULL si el dato no estaba.
+ * Pre: La estructura hash fue inicializada
+ * Post: El elemento fue borrado de la estructura y se lo devuelve
+ * en el caso de que estuviera guardado. Queda en manos del usuario
+ * la memoria de ese dato guardado.
+ */
+void* hash_borrar(hash_t *hash, const char *clave){
+	return hash_borrar_n(hash, clave, strlen(clave));
+}
+
+/* Obtiene el valor de un elemento del hash, si la clave no se encuentra
+ * devuelve NULL.
+ * Pre: La estructura hash fue inicializada
+ */
+void* hash_obtener(const hash_t *hash, const char *clave){
+	return hash_obtener_n(hash, clave, strlen(clave));
+}
+
+/* Obtiene la direccion donde se guarda el valor de la clave, o NULL si
+ * la clave no se encuentra.
+ * Pre: La estructura hash fue inicializada
+ */
+void** hash_obtener_ptr(hash_t *hash, const char *clave){
+	return hash_obtener_ptr_n(hash, clave, strlen(clave));
+}
+
+/* Determina si clave pertenece o no al hash.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_pertenece(const hash_t* hash, const char* clave){
+	return hash_pertenece_n(hash, clave, strlen(clave));
+}
+
+/* Claves binarias */
+
+/* Devuelve el valor de la funcion de hashing del hash para la clave.
+ */
+uint64_t hash_calcular(const hash_t *hash, const void *clave, size_t largo){
+	return hash->funcion(clave, largo, hash->semilla);
+}
+
+bool hash_guardar_n(hash_t *hash, const void *clave, size_t largo, void *dato){
+	if(!clave) return false;
+	return hash_guardar_nh(hash, clave, largo, hash_calcular(hash, clave, largo), dato);
+}
+
+void* hash_borrar_n(hash_t *hash, const void *clave, size_t largo){
+	return hash_borrar_nh(hash, clave, largo, hash_calcular(hash, clave, largo));
+}
+
+void* hash_obtener_n(const hash_t *hash, const void *clave, size_t largo){
+	return hash_obtener_nh(hash, clave, largo, hash_calcular(hash, clave, largo));
+}
+
+void** hash_obtener_ptr_n(hash_t *hash, const void *clave, size_t largo){
+	return hash_obtener_ptr_nh(hash, clave, largo, hash_calcular(hash, clave, largo));
+}
+
+bool hash_pertenece_n(const hash_t *hash, const void *clave, size_t largo){
+	return hash_pertenece_nh(hash, clave, largo, hash_calcular(hash, clave, largo));
+}
+
+/* Guarda la clave de largo y hash recibidos, sin vencimiento. Es la que
+ * hace el trabajo de hash_guardar y hash_guardar_n.
+ * Pre: La estructura hash fue inicializada, h es hash_calcular de la clave
+ */
+bool hash_guardar_nh(hash_t *hash, const void *clave, size_t largo, uint64_t h, void *dato){
+	return guardar_campo(hash, clave, largo, h, dato) != NULL;
+}
+
+/* Guarda la clave y devuelve su campo, o NULL si no se pudo.
+ */
+campo_hash_t* guardar_campo(hash_t *hash, const void *clave, size_t largo, uint64_t h, void *dato){
+	if(!clave) return NULL;
+	if(hash->vieja)
+		migrar(hash, PASOS_MIGRACION);
+	if((double)(hash->cant + 1) > hash->politica.carga_maxima * (double)hash->tam)
+		hash_redimensionar(hash, hash->tam * hash->politica.factor_crecimiento);
+	if(!preservar_posicion(hash, (size_t)h))
+		return NULL;
+
+	size_t bytes_nuevos = hash->cache ? bytes_entrada(hash, largo, dato) : 0;
+	if(hash->cache_bytes && bytes_nuevos > hash->cache_bytes)
+		return NULL;
+	campo_hash_t** enlace = buscar_enlace(hash, clave, largo, (size_t)h);
+	if(*enlace){
+		campo_hash_t* campo = *enlace;
+		if(hash->cache){
+			// Se desaloja por la diferencia de bytes. La clave que se
+			// reemplaza queda como la mas nueva, y si fuera la unica los
+			// bytes nuevos ya entrarian: nunca se la desaloja.
+			usar_campo(hash, campo);
+			while(hash->cache_bytes && hash->mas_viejo != (campo_cache_t*)campo
+					&& hash->bytes - ((campo_cache_t*)campo)->bytes + bytes_nuevos > hash->cache_bytes){
+				if(!desalojar(hash))
+					return NULL;
+			}
+			restar_bytes(hash, campo);
+		}
+		if (hash->destruir)
+			hash->destruir(campo->valor);
+		campo->valor= dato;
+		if(hash->cache)
+			sumar_bytes(hash, campo, bytes_nuevos);
+		if(hash->rueda)
+			*vencimiento(hash, campo) = SIN_VENCIMIENTO;
+		return campo;
+	}
+	if(hash->cache){
+		if(excede_cache(hash, bytes_nuevos)){
+			while(hash->cant > 0 && excede_cache(hash, bytes_nuevos)){
+				if(!desalojar(hash))
+					return NULL;
+			}
+			// El enlace pudo haber sido el sig de un campo desalojado.
+			enlace = buscar_enlace(hash, clave, largo, (size_t)h);
+		}
+	}
+	campo_hash_t* campo = crear_campo_hash(hash, clave, largo, (size_t)h, dato);
+	if(!campo) return NULL;
+	*enlace = campo;
+	bitmap_marcar(ocupadas(hash->tabla, hash->tam), (size_t)h & (hash->tam - 1));
+	hash->cant++;
+	if(hash->cache){
+		agregar_a_uso(hash, campo);
+		sumar_bytes(hash, campo, bytes_nuevos);
+	}
+	return campo;
+}
+
+/* Borra la clave de largo y hash recibidos y devuelve su dato.
+ * Pre: La estructura hash fue inicializada, h es hash_calcular de la clave
+ */
+void* hash_borrar_nh(hash_t *hash, const void *clave, size_t largo, uint64_t h){
+	if(hash->cant == 0) return NULL;
+	if(hash->vieja)
+		migrar(hash, PASOS_MIGRACION);
+
+	campo_hash_t** enlace = buscar_enlace(hash, clave, largo, (size_t)h);
+	campo_hash_t* campo = *enlace;
+	if(!campo || !preservar_posicion(hash, (size_t)h)) return NULL;
+	if(vencido(hash, campo)){
+		expirar_campo(hash, enlace);
+		return NULL;
+	}
+	*enlace = campo->sig;
+	actualizar_ocupadas(hash, (size_t)h);
+	if(hash->cache){
+		quitar_de_uso(hash, campo);
+		restar_bytes(hash, campo);
+	}
+	void* dato = campo->valor;
+	destruir_campo_hash(hash, NULL, campo);
+	hash->cant--;
+
+	size_t tam_nuevo = tam_achicado(hash);
+	if(!hash->vieja && tam_nuevo != hash->tam)
+		hash_redimensionar(hash, tam_nuevo);
+	return dato;
+}
+
+/* En modo cache marca la clave como usada, y con vencimientos borra la
+ * clave si vencio, por lo que modifica el hash aunque lo reciba como
+ * const.
+ */
+void* hash_obtener_nh(const hash_t *hash, const void *clave, size_t largo, uint64_t h){
+	campo_hash_t* campo = buscar_vigente(hash, clave, largo, (size_t)h);
+	CONTAR_BUSQUEDA(hash, campo);
+	if(!campo) return NULL;
+	usar_campo((hash_t*)hash, campo);
+	return campo->valor;
+}
+
+/* El dato se puede modificar a traves del puntero, asi que antes se
+ * preserva su pagina.
+ */
+void** hash_obtener_ptr_nh(hash_t *hash, const void *clave, size_t largo, uint64_t h){
+	campo_hash_t* campo = buscar_vigente(hash, clave, largo, (size_t)h);
+	CONTAR_BUSQUEDA(hash, campo);
+	if(!campo || !preservar_posicion(hash, (size_t)h)) return NULL;
+	usar_campo(hash, campo);
+	return &campo->valor;
+}
+
+bool hash_pertenece_nh(const hash_t *hash, const void *clave, size_t largo, uint64_t h){
+	bool esta = buscar_vigente(hash, clave, largo, (size_t)h);
+	CONTAR_BUSQUEDA(hash, esta);
+	return esta;
+}
+
+/* Primitivas por lotes */
+
+/* Obtiene el dato de cada una de las claves, de a LOTE claves por vez.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_obtener_lote(const hash_t *hash, const char *const claves[], size_t cant, void *datos[]){
+	size_t largos[LOTE];
+	uint64_t hs[LOTE];
+	for(size_t base = 0; base < cant; base += LOTE){
+		size_t n = cant - base < LOTE ? cant - base : LOTE;
+		preparar_lote(hash, claves + base, n, largos, hs);
+		for(size_t i = 0; i < n; i++)
+			datos[base + i] = hash_obtener_nh(hash, claves[base + i], largos[i], hs[i]);
+	}
+}
+
+/* Guarda los pares (claves[i], datos[i]). Agranda la tabla de antemano
+ * para el peor caso (todas las claves nuevas); si no hay memoria para
+ * eso, cada guardar agranda por su cuenta.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_guardar_lote(hash_t *hash, const char *const claves[], void *const datos[], size_t cant){
+	hash_reservar(hash, hash->cant + cant);
+	size_t largos[LOTE];
+	uint64_t hs[LOTE];
+	for(size_t base = 0; base < cant; base += LOTE){
+		size_t n = cant - base < LOTE ? cant - base : LOTE;
+		preparar_lote(hash, claves + base, n, largos, hs);
+		for(size_t i = 0; i < n; i++){
+			if(!hash_guardar_nh(hash, claves[base + i], largos[i], hs[i], datos[base + i]))
+				return false;
+		}
+	}
+	return true;
+}
+
+/* Borra cada una de las claves y devuelve sus datos en datos.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_borrar_lote(hash_t *hash, const char *const claves[], size_t cant, void *datos[]){
+	size_t largos[LOTE];
+	uint64_t hs[LOTE];
+	for(size_t base = 0; base < cant; base += LOTE){
+		size_t n = cant - base < LOTE ? cant - base : LOTE;
+		preparar_lote(hash, claves + base, n, largos, hs);
+		for(size_t i = 0; i < n; i++)
+			datos[base + i] = hash_borrar_nh(hash, claves[base + i], largos[i], hs[i]);
+	}
+}
+
+/* Construccion paralela y fusion */
+
+/* Crea el hash y guarda las claves del lote en paralelo: particion_crear
+ * calcula los hash y reparte las claves por rango de la tabla, y cada
+ * hilo arma su rango con armar_rango.
+ */
+hash_t* hash_construir_paralelo(const char* const claves[], void* const datos[], size_t cant, size_t hilos, hash_destruir_dato_t destruir_dato, const hash_opciones_t* opciones){
+	hash_t* hash = hash_crear_con_opciones(destruir_dato, opciones);
+	if(!hash) return NULL;
+	bool ok;
+	if(hash->cache){
+		ok = hash_guardar_lote(hash, claves, datos, cant);
+	}else{
+		// La tabla se arma ya del tamaño final, aun en modo incremental.
+		bool incremental = hash->incremental;
+		hash->incremental = false;
+		ok = hash_reservar(hash, cant);
+		hash->incremental = incremental;
+		if(hilos == 0 || hash->arena || hash->asignador.pedir)
+			hilos = 1;
+		size_t particiones = particion_cantidad(hilos, hash->tam, BITS_PALABRA);
+		particion_t particion;
+		rango_t* rangos = NULL;
+		if(ok)
+			ok = particion_crear(&particion, claves, cant, hash->funcion, hash->semilla, hash->tam, particiones, hilos);
+		if(ok){
+			rangos = malloc(sizeof(rango_t) * particiones);
+			ok = rangos != NULL;
+			if(!ok)
+				particion_destruir(&particion);
+		}
+		if(ok){
+			for(size_t p = 0; p < particiones; p++){
+				rangos[p].hash = hash;
+				rangos[p].particion = &particion;
+				rangos[p].claves = claves;
+				rangos[p].datos = datos;
+				rangos[p].p = p;
+				rangos[p].cant = 0;
+				rangos[p].ok = true;
+			}
+			particion_ejecutar(armar_rango, rangos, sizeof(rango_t), particiones, hilos);
+			for(size_t p = 0; p < particiones; p++){
+				hash->cant += rangos[p].cant;
+				ok = ok && rangos[p].ok;
+			}
+			free(rangos);
+			particion_destruir(&particion);
+		}
+	}
+	if(!ok){
+		hash->destruir = NULL;
+		hash_destruir(hash);
+		return NULL;
+	}
+	return hash;
+}
+
+/* Pasa las claves de origen a destino, primero las de la tabla vieja si
+ * origen esta en medio de un rehash.
+ */
+bool hash_fusionar(hash_t* destino, hash_t* origen, hash_fusion_t politica){
+	bool mover = campos_compatibles(destino, origen);
+	if(!preservar_todo(destino) || !preservar_todo(origen))
+		return false;
+	if(!hash_reservar(destino, destino->cant + origen->cant))
+		return false;
+	if(origen->vieja && !fusionar_tabla(destino, origen, origen->vieja, origen->tam_vieja, politica, mover))
+		return false;
+	return fusionar_tabla(destino, origen, origen->tabla, origen->tam, politica, mover);
+}
+
+/* Vencimientos */
+
+bool hash_guardar_ttl(hash_t *hash, const char *clave, void *dato, uint64_t ttl){
+	if(!clave) return false;
+	return hash_guardar_ttl_n(hash, clave, strlen(clave), dato, ttl);
+}
+
+/* El vencimiento se satura: un ttl que no entra en el reloj no vence.
+ */
+bool hash_guardar_ttl_n(hash_t *hash, const void *clave, size_t largo, void *dato, uint64_t ttl){
+	if(!hash->rueda) return false;
+	campo_hash_t* campo = guardar_campo(hash, clave, largo, hash_calcular(hash, clave, largo), dato);
+	if(!campo) return false;
+	uint64_t ahora = hash->reloj();
+	uint64_t vence = ttl < SIN_VENCIMIENTO - ahora ? ahora + ttl : SIN_VENCIMIENTO;
+	return fijar_vencimiento(hash, campo, vence);
+}
+
+/* Saca de la rueda los vencimientos que ya pasaron y borra los campos que
+ * todavia coinciden con el suyo. Como hash_borrar, avanza el rehash
+ * incremental en cada vencimiento. Al final achica la tabla si
+ * corresponde, una sola vez.
+ */
+size_t hash_expirar(hash_t *hash, size_t presupuesto){
+	if(!hash->rueda) return 0;
+	uint64_t ahora = hash->reloj();
+	size_t vencidas = 0;
+	rueda_registro_t registro;
+	for(; presupuesto > 0 && rueda_sacar(hash->rueda, ahora, &registro); presupuesto--){
+		if(hash->vieja)
+			migrar(hash, PASOS_MIGRACION);
+		campo_hash_t** enlace = buscar_registro(hash, &registro);
+		if(!enlace || !preservar_posicion(hash, (size_t)registro.h)) continue;
+		expirar_campo(hash, enlace);
+		vencidas++;
+	}
+	if(vencidas && !hash->vieja){
+		size_t tam_nuevo = tam_achicado(hash);
+		if(tam_nuevo != hash->tam)
+			hash_redimensionar(hash, tam_nuevo);
+	}
+	return vencidas;
+}
+
+/* Devuelve la cantidad de elementos del hash.
+ * Pre: La estructura hash fue inicializada
+ */
+size_t hash_cantidad(const hash_t* hash){
+	return hash->cant;
+}
+
+/* Agranda la tabla para que entren capacidad elementos sin volver a
+ * redimensionar.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_reservar(hash_t *hash, size_t capacidad){
+	size_t tam_nuevo = tam_para(&hash->politica, capacidad);
+	if(tam_nuevo <= hash->tam) return true;
+	return hash_redimensionar(hash, tam_nuevo);
+}
+
+/* Achica la tabla al menor tamaño en el que entran los elementos actuales.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_compactar(hash_t *hash){
+	if(hash->vieja)
+		migrar(hash, hash->tam_vieja);
+	size_t tam_nuevo = tam_para(&hash->politica, hash->cant);
+	if(tam_nuevo >= hash->tam) return true;
+	return hash_redimensionar(hash, tam_nuevo);
+}
+
+/* Suma a las estadisticas las posiciones de una tabla: el histograma de
+ * largos de lista, el mayor largo y los bytes de campos y claves.
+ */
+void estadisticas_tabla(const hash_t* hash, campo_hash_t** tabla, size_t tam, hash_estadisticas_t* estadisticas){
+	estadisticas->bytes_tabla += sizeof(campo_hash_t*) * tam + sizeof(uint64_t) * bitmap_palabras(tam);
+	uint64_t* bits = ocupadas(tabla, tam);
+	size_t vacias = tam;
+	for(size_t i = bitmap_siguiente(bits, tam, 0); i < tam; i = bitmap_siguiente(bits, tam, i + 1)){
+		size_t largo = 0;
+		for(campo_hash_t* campo = tabla[i]; campo; campo = campo->sig){
+			largo++;
+			estadisticas->bytes_campos += hash->tam_campo;
+			if(campo->largo > LARGO_CLAVE_CORTA && !hash->prestadas)
+				estadisticas->bytes_claves += campo->largo + 1;
+		}
+		estadisticas->histograma[largo < HASH_LARGOS ? largo : HASH_LARGOS - 1]++;
+		if(largo > estadisticas->max_sondeo)
+			estadisticas->max_sondeo = largo;
+		vacias--;
+	}
+	estadisticas->histograma[0] += vacias;
+}
+
+/* Completa las estadisticas recorriendo la tabla (y la vieja, si hay un
+ * rehash en curso) una vez.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_estadisticas(const hash_t *hash, hash_estadisticas_t *estadisticas){
+	memset(estadisticas, 0, sizeof(*estadisticas));
+	estadisticas->cantidad = hash->cant;
+	estadisticas->tam = hash->tam;
+	estadisticas->carga = (double)hash->cant / (double)hash->tam;
+	estadisticas_tabla(hash, hash->tabla, hash->tam, estadisticas);
+	if(hash->vieja)
+		estadisticas_tabla(hash, hash->vieja, hash->tam_vieja, estadisticas);
+	estadisticas->redimensiones = hash->redimensiones;
+	estadisticas->ns_redimension = hash->ns_redimension;
+	estadisticas->max_ns_redimension = hash->max_ns_redimension;
+	estadisticas->busquedas = hash->busquedas;
+	estadisticas->aciertos = hash->aciertos;
+	estadisticas->fallos = hash->busquedas - hash->aciertos;
+	estadisticas->desalojos = hash->desalojos;
+	estadisticas->bytes_cache = hash->bytes;
+	estadisticas->vencidas = hash->vencidas;
+}
+
+/* Destruye la estructura liberando la memoria pedida y llamando a la función
+ * destruir para cada par (clave, dato).
+ * Pre: La estructura hash fue inicializada
+ * Post: La estructura hash fue destruida
+ */
+void hash_destruir(hash_t *hash){
+	while(hash->instantaneas){
+		hash_snapshot_t* instantanea = hash->instantaneas;
+		hash->instantaneas = instantanea->sig;
+		liberar_instantanea(hash, instantanea);
+	}
+	if(hash->preservadas)
+		asignador_liberar(&hash->asignador, hash->preservadas);
+	if(hash->vieja)
+		destruir_tabla(hash, hash->vieja, hash->tam_vieja, hash->destruir);
+	destruir_tabla(hash, hash->tabla, hash->tam, hash->destruir);
+	if(hash->arena)
+		arena_destruir(hash->arena);
+	if(hash->rueda)
+		rueda_destruir(hash->rueda);
+	asignador_t asignador = hash->asignador;
+	asignador_liberar(&asignador, hash);
+}
+
+/* Instantaneas */
+
+/* Crea la instantanea con todas sus paginas leyendose de la tabla. Si no
+ * habia otras que leyeran de la tabla, preservadas empieza con la
+ * generacion anterior: las instantaneas viejas ya tienen todo copiado.
+ */
+hash_snapshot_t* hash_snapshot(hash_t *hash){
+	recolectar_instantaneas(hash);
+	if(hash->vieja)
+		migrar(hash, hash->tam_vieja);
+	size_t cant_paginas = cantidad_paginas(hash->tam);
+	hash_snapshot_t* instantanea = asignador_pedir(&hash->asignador, sizeof(hash_snapshot_t));
+	pagina_t** paginas = asignador_pedir(&hash->asignador, sizeof(pagina_t*) * cant_paginas);
+	uint64_t* preservadas = hash->preservadas;
+	if(!preservadas)
+		preservadas = asignador_pedir(&hash->asignador, sizeof(uint64_t) * cant_paginas);
+	if(!instantanea || !paginas || !preservadas || pthread_mutex_init(&instantanea->mutex, NULL) != 0){
+		if(instantanea)
+			asignador_liberar(&hash->asignador, instantanea);
+		if(paginas)
+			asignador_liberar(&hash->asignador, paginas);
+		if(preservadas && preservadas != hash->preservadas)
+			asignador_liberar(&hash->asignador, preservadas);
+		return NULL;
+	}
+	if(!hash->preservadas){
+		for(size_t p = 0; p < cant_paginas; p++)
+			preservadas[p] = hash->generacion;
+		hash->preservadas = preservadas;
+	}
+	for(size_t p = 0; p < cant_paginas; p++)
+		paginas[p] = NULL;
+	instantanea->hash = hash;
+	instantanea->paginas = paginas;
+	instantanea->tam = hash->tam;
+	instantanea->cant = hash->cant;
+	instantanea->generacion = ++hash->generacion;
+	instantanea->terminada = false;
+	instantanea->sig = hash->instantaneas;
+	hash->instantaneas = instantanea;
+	return instantanea;
+}
+
+void* hash_snapshot_obtener(const hash_snapshot_t *snapshot, const char *clave){
+	return hash_snapshot_obtener_n(snapshot, clave, strlen(clave));
+}
+
+void* hash_snapshot_obtener_n(const hash_snapshot_t *snapshot, const void *clave, size_t largo){
+	void* dato = NULL;
+	buscar_en_instantanea(snapshot, clave, largo, &dato);
+	return dato;
+}
+
+bool hash_snapshot_pertenece(const hash_snapshot_t *snapshot, const char *clave){
+	return hash_snapshot_pertenece_n(snapshot, clave, strlen(clave));
+}
+
+bool hash_snapshot_pertenece_n(const hash_snapshot_t *snapshot, const void *clave, size_t largo){
+	void* dato;
+	return buscar_en_instantanea(snapshot, clave, largo, &dato);
+}
+
+size_t hash_snapshot_cantidad(const hash_snapshot_t *snapshot){
+	return snapshot->cant;
+}
+
+/* Las paginas que se leen de la tabla se copian con malloc, y no con el
+ * asignador del hash, que no tiene por que poder usarse desde otro hilo.
+ */
+bool hash_snapshot_iterar(const hash_snapshot_t *snapshot, bool visitar(const char *clave, void *dato, void *extra), void *extra){
+	hash_snapshot_t* instantanea = (hash_snapshot_t*)snapshot;
+	asignador_t propio = {0};
+	size_t cant_paginas = cantidad_paginas(instantanea->tam);
+	for(size_t p = 0; p < cant_paginas; p++){
+		pthread_mutex_lock(&instantanea->mutex);
+		pagina_t* pagina = instantanea->paginas[p];
+		pagina_t* copia = pagina ? NULL : copiar_pagina(instantanea->hash, p, &propio);
+		pthread_mutex_unlock(&instantanea->mutex);
+		if(!pagina && !copia) return false;
+		const pagina_t* actual = pagina ? pagina : copia;
+		bool seguir = true;
+		for(size_t i = 0; i < POSICIONES_PAGINA && seguir; i++){
+			for(campo_hash_t* campo = actual->listas[i]; campo && seguir; campo = campo->sig)
+				seguir = visitar(clave_campo(campo), campo->valor, extra);
+		}
+		if(copia)
+			liberar_pagina(instantanea->hash, copia, &propio);
+		if(!seguir) break;
+	}
+	return true;
+}
+
+/* Solo la marca: la libera recolectar_instantaneas, en el hilo que
+ * modifica el hash.
+ */
+void hash_snapshot_destruir(hash_snapshot_t *snapshot){
+	pthread_mutex_lock(&snapshot->mutex);
+	snapshot->terminada = true;
+	pthread_mutex_unlock(&snapshot->mutex);
+}
+
+/* Iterador del hash */
+
+/* Recorre todos los campos del hash aplicando visitar a cada clave y su
+ * dato, hasta que visitar devuelva false. No pide memoria.
+ * Pre: el hash fue creado.
+ */
+void hash_iterar(const hash_t *hash, bool visitar(const char *clave, void *dato, void *extra), void *extra){
+	hash_iter_t iter;
+	hash_iter_inicializar(&iter, hash);
+	while(!hash_iter_al_final(&iter)){
+		campo_hash_t* campo = iter.actual;
+		if(!visitar(clave_campo(campo), campo->valor, extra))
+			return;
+		hash_iter_avanzar(&iter);
+	}
+}
+
+/* Inicializa un iterador guardado por el usuario. Lo ubica en el primer
+ * campo de la primera posicion no vacia de la tabla. Si todas estan
+ * vacias el campo actual es NULL.
+ * Pre: el hash fue creado.
+ */
+void hash_iter_inicializar(hash_iter_t *iter, const hash_t *hash){
+	iter->hash = hash;
+	iter->pos = 0;
+	avanzar_sobre_tabla(iter);
+}
+
+/* Crea iterador. Asigna el iterador al primer campo de la primera
+ * posicion no vacia de la tabla.
+ * Pre: el hash fue creado.
+ */
+hash_iter_t* hash_iter_crear(const hash_t *hash){
+	hash_iter_t* iter =  malloc(sizeof(hash_iter_t));
+	if(!iter) return NULL;
+	hash_iter_inicializar(iter, hash);
+	return iter;
+}
+
+/* Avanza iterador sobre un mismo hash.
+ * Pre: el iterador fue creado.
+ */
+bool hash_iter_avanzar(hash_iter_t *iter){
+	if (hash_iter_al_final(iter)) return false;
+	campo_hash_t* actual = iter->actual;
+	iter->actual = actual->sig;
+	if (iter->actual) return true;
+	iter->pos++;
+	return avanzar_sobre_tabla(iter);
+}
+
+/* Devuelve clave actual, esa clave no se puede modificar ni liberar.
+ */
+const char* hash_iter_ver_actual(const hash_iter_t *iter){
+	if(!iter || hash_iter_al_final(iter)) 
+		return NULL;
+	return clave_campo(iter->actual);
+}
+
+/* Devuelve la clave actual y guarda su largo en largo.
+ */
+const char* hash_iter_ver_actual_n(const hash_iter_t *iter, size_t *largo){
+	if(!iter || hash_iter_al_final(iter))
+		return NULL;
+	const campo_hash_t* actual = iter->actual;
+	*largo = actual->largo;
+	return clave_campo(actual);
+}
+
+/* Devuelve el dato del campo actual, sin buscar su clave.
+ */
+void* hash_iter_ver_dato(const hash_iter_t *iter){
+	if(!iter || hash_iter_al_final(iter))
+		return NULL;
+	const campo_hash_t* actual = iter->actual;
+	return actual->valor;
+}
+
+/* Comprueba si el iterador ya paso por todos los campos del hash.
+ */
+bool hash_iter_al_final(const hash_iter_t *iter){
+	return !iter->actual;
+}
+
+/* Destruye iterador.
+ * Pre: el iterador fue creado con hash_iter_crear.
+ */
+void hash_iter_destruir(hash_iter_t* iter){
+	free(iter);
+}
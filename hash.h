@@ -3,21 +3,149 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include "hash_funciones.h"
+#include "arena.h"
+
+/* Hay dos implementaciones de esta interfaz, se elige una al compilar:
+ *  - hash.c: hash abierto, cada posicion de la tabla es una lista
+ *    enlazada de campos.
+ *  - hash_cerrado.c: hash cerrado, los campos se guardan en linea en un
+ *    unico arreglo (sondeo lineal Robin Hood, borrado sin lapidas).
+ * Ambas se compilan junto con hash_funciones.c, arena.c, particion.c y
+ * rueda.c, con -pthread.
+ */
 
 // Los structs deben llamarse "hash" y "hash_iter".
 struct hash;
-struct hash_iter;
-
 typedef struct hash hash_t;
+
+// El iterador es publico para poder guardarlo en el stack e inicializarlo
+// con hash_iter_inicializar, sin pedir memoria. Sus campos son privados.
+struct hash_iter{
+	const hash_t *hash;
+	void *actual;
+	size_t pos;
+};
 typedef struct hash_iter hash_iter_t;
 
 // tipo de función para destruir dato
 typedef void (*hash_destruir_dato_t)(void *);
 
+// Politica de redimension. Los campos en cero toman el valor por
+// defecto de cada implementacion.
+typedef struct hash_politica{
+	double carga_maxima;       // se agranda al superarla (hash_cerrado.c: menor a 1)
+	double carga_minima;       // se achica al quedar por debajo; debe ser menor
+	                           // a carga_maxima / factor_crecimiento
+	size_t factor_crecimiento; // potencia de dos mayor o igual a 2
+	size_t tam_inicial;        // se redondea a potencia de dos; nunca se achica
+	                           // por debajo de este tamaño
+	bool nunca_achicar;
+} hash_politica_t;
+
+// Opciones de creacion del hash. Los campos en cero toman el valor
+// por defecto.
+typedef struct hash_opciones{
+	hash_funcion_t funcion; // NULL: HASH_FUNCION_PREDETERMINADA
+	uint64_t semilla;       // 0: una semilla aleatoria para cada tabla
+	// Si es true, al redimensionar se mantienen las dos tablas y los
+	// elementos se mueven de a poco en cada hash_guardar y hash_borrar, en
+	// lugar de todos juntos. Solo lo usa hash.c.
+	bool rehash_incremental;
+	hash_politica_t politica;
+	// Memoria de la tabla, los campos y las claves (NULL: malloc y free).
+	asignador_t asignador;
+	// Si es true, los campos salen de un slab y las claves se empaquetan
+	// en paginas de una arena, que se liberan todas juntas al destruir el
+	// hash. El lugar de las claves borradas no se reutiliza hasta entonces.
+	bool arena;
+	// Si es true, el hash no copia las claves sino que guarda el puntero
+	// recibido, que tiene que seguir valido y sin cambios mientras la clave
+	// este en el hash (por ejemplo, claves dentro de un archivo mapeado o de
+	// un conjunto de cadenas internadas). Las claves guardadas con las
+	// primitivas _n no necesitan terminar en '\0', y entonces tampoco
+	// terminan en '\0' al obtenerlas de un iterador. hash.c igual copia
+	// dentro del campo las claves cortas, que no piden memoria aparte.
+	bool claves_prestadas;
+	// Modo cache: si cache_entradas o cache_bytes no son 0, al guardar una
+	// clave nueva que los superaria se desalojan las claves usadas hace
+	// mas tiempo, destruyendo sus datos. Al reemplazar el dato de una
+	// clave se desaloja lo que haga falta para que entren sus bytes
+	// nuevos, sin desalojar esa clave. Los bytes de una clave son su
+	// largo mas uno, mas bytes_dato de su dato si no es NULL, calculados
+	// al guardarla: al sacarla se resta lo mismo aunque el dato haya
+	// cambiado. Una clave con mas bytes que cache_bytes no se guarda:
+	// hash_guardar devuelve false y el dato sigue siendo del usuario. hash_cerrado.c los anota junto a la copia de la clave, asi
+	// que no permite el modo cache con claves_prestadas. Las claves
+	// se marcan como usadas al guardarlas y al obtenerlas (hash_obtener y
+	// hash_obtener_ptr), por lo que en este modo hash_obtener modifica el
+	// hash. hash.c desaloja en orden LRU; hash_cerrado.c, con el
+	// algoritmo CLOCK.
+	size_t cache_entradas;
+	size_t cache_bytes;
+	size_t (*bytes_dato)(const void *dato);
+	// Si es true, se pueden guardar claves que vencen con hash_guardar_ttl.
+	// Cada clave guarda ademas cuando vence, y una rueda de tiempos ordena
+	// los vencimientos. Las claves vencidas se borran destruyendo su dato
+	// al buscarlas (por lo que hash_obtener modifica el hash) o con
+	// hash_expirar; mientras tanto se cuentan en hash_cantidad y aparecen
+	// en los iteradores. hash_cerrado.c guarda el vencimiento junto a la
+	// copia de la clave, asi que no lo permite con claves_prestadas.
+	bool vencimientos;
+	// Reloj de los vencimientos, en milisegundos (NULL: el reloj monotono
+	// del sistema).
+	uint64_t (*reloj)(void);
+} hash_opciones_t;
+
+// Largos distintos que distingue el histograma de hash_estadisticas; el
+// ultimo cuenta todos los mayores.
+#define HASH_LARGOS 16
+
+// Estado del hash devuelto por hash_estadisticas.
+typedef struct hash_estadisticas{
+	size_t cantidad;
+	size_t tam;           // posiciones de la tabla (la nueva, si hay un rehash en curso)
+	double carga;         // cantidad / tam
+	// hash.c: cuantas posiciones tienen una lista de i campos.
+	// hash_cerrado.c: cuantos campos estan a distancia i de su posicion ideal.
+	size_t histograma[HASH_LARGOS];
+	size_t max_sondeo;    // mayor cantidad de campos a mirar para encontrar una clave guardada
+	size_t redimensiones;
+	uint64_t ns_redimension;     // tiempo total de las redimensiones (reloj monotono)
+	uint64_t max_ns_redimension; // y de la mas lenta
+	size_t bytes_tabla;   // tablas y sus bitmaps
+	size_t bytes_campos;  // campos fuera de la tabla (solo hash.c)
+	size_t bytes_claves;  // claves fuera de los campos
+	// Busquedas con hash_obtener, hash_obtener_ptr y hash_pertenece (y sus
+	// variantes). Solo se cuentan en modo cache o si se compila con
+	// -DHASH_CONTADORES; si no, quedan en 0. Con los contadores el hash no
+	// se puede leer desde varios hilos a la vez.
+	uint64_t busquedas;
+	uint64_t aciertos;
+	uint64_t fallos;
+	size_t desalojos;     // claves desalojadas en modo cache
+	size_t bytes_cache;   // bytes guardados, segun las reglas del modo cache
+	size_t vencidas;      // claves borradas por vencer
+} hash_estadisticas_t;
+
 /* Crea el hash
  */
 hash_t *hash_crear(hash_destruir_dato_t destruir_dato);
 
+/* Crea el hash con las opciones indicadas. Si opciones es NULL equivale
+ * a hash_crear. Devuelve NULL si la politica de redimension es invalida
+ * o la combinacion de opciones no se permite.
+ * Al achicar se elige el menor tamaño cuya carga queda por debajo de
+ * carga_maxima / factor_crecimiento, para no volver a crecer enseguida.
+ */
+hash_t *hash_crear_con_opciones(hash_destruir_dato_t destruir_dato, const hash_opciones_t *opciones);
+
+/* Crea el hash con lugar para capacidad elementos sin redimensionar.
+ * La tabla no se achica por debajo de ese tamaño.
+ */
+hash_t *hash_crear_con_capacidad(hash_destruir_dato_t destruir_dato, size_t capacidad);
+
 /* Guarda un elemento en el hash, si la clave ya se encuentra en la
  * estructura, la reemplaza. De no poder guardarlo devuelve false.
  * Pre: La estructura hash fue inicializada
@@ -39,6 +167,14 @@ void *hash_borrar(hash_t *hash, const char *clave);
  */
 void *hash_obtener(const hash_t *hash, const char *clave);
 
+/* Obtiene la direccion donde se guarda el valor de un elemento del hash,
+ * o NULL si la clave no se encuentra. Permite leer y actualizar el valor
+ * con una sola busqueda; el valor anterior no se destruye. La direccion
+ * deja de ser valida al guardar o borrar cualquier elemento.
+ * Pre: La estructura hash fue inicializada
+ */
+void **hash_obtener_ptr(hash_t *hash, const char *clave);
+
 /* Determina si clave pertenece o no al hash.
  * Pre: La estructura hash fue inicializada
  */
@@ -49,28 +185,233 @@ bool hash_pertenece(const hash_t *hash, const char *clave);
  */
 size_t hash_cantidad(const hash_t *hash);
 
+/* Agranda la tabla para que entren capacidad elementos sin volver a
+ * redimensionar. Si ya tenia lugar no hace nada. Devuelve false si no se
+ * pudo pedir memoria, en cuyo caso el hash no cambia.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_reservar(hash_t *hash, size_t capacidad);
+
+/* Achica la tabla al menor tamaño en el que entran los elementos actuales
+ * respetando la carga maxima, aun por debajo del tamaño inicial.
+ * Devuelve false si no se pudo pedir memoria, en cuyo caso el hash no
+ * cambia.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_compactar(hash_t *hash);
+
+/* Completa estadisticas con el estado del hash. Recorre la tabla una
+ * vez, sin pedir memoria ni modificar el hash.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_estadisticas(const hash_t *hash, hash_estadisticas_t *estadisticas);
+
 /* Destruye la estructura liberando la memoria pedida y llamando a la función
  * destruir para cada par (clave, dato).
- * Pre: La estructura hash fue inicializada
+ * Pre: La estructura hash fue inicializada y sus instantaneas fueron
+ * destruidas.
  * Post: La estructura hash fue destruida
  */
 void hash_destruir(hash_t *hash);
 
+/* Claves binarias
+ *
+ * Variantes de las primitivas que reciben la clave como un bloque de
+ * largo bytes, que puede contener '\0' y no necesita terminar en '\0'.
+ * Las versiones _nh reciben ademas el hash de la clave ya calculado con
+ * hash_calcular, para no recorrerla de nuevo. Una clave guardada con
+ * hash_guardar es la misma que la de largo strlen(clave) guardada con
+ * hash_guardar_n.
+ */
+
+// Devuelve el valor de la funcion de hashing del hash para la clave.
+uint64_t hash_calcular(const hash_t *hash, const void *clave, size_t largo);
+
+bool hash_guardar_n(hash_t *hash, const void *clave, size_t largo, void *dato);
+void *hash_borrar_n(hash_t *hash, const void *clave, size_t largo);
+void *hash_obtener_n(const hash_t *hash, const void *clave, size_t largo);
+void **hash_obtener_ptr_n(hash_t *hash, const void *clave, size_t largo);
+bool hash_pertenece_n(const hash_t *hash, const void *clave, size_t largo);
+
+bool hash_guardar_nh(hash_t *hash, const void *clave, size_t largo, uint64_t h, void *dato);
+void *hash_borrar_nh(hash_t *hash, const void *clave, size_t largo, uint64_t h);
+void *hash_obtener_nh(const hash_t *hash, const void *clave, size_t largo, uint64_t h);
+void **hash_obtener_ptr_nh(hash_t *hash, const void *clave, size_t largo, uint64_t h);
+bool hash_pertenece_nh(const hash_t *hash, const void *clave, size_t largo, uint64_t h);
+
+/* Primitivas por lotes
+ *
+ * Equivalen a llamar a la primitiva correspondiente para cada una de las
+ * cant claves, en orden, pero calculan primero el hash de un grupo de
+ * claves y piden al procesador las posiciones de la tabla antes de
+ * recorrerlas, para que las esperas a memoria de claves distintas se
+ * superpongan.
+ */
+
+// Guarda en datos[i] el dato de claves[i], o NULL si no esta.
+void hash_obtener_lote(const hash_t *hash, const char *const claves[], size_t cant, void *datos[]);
+
+// Guarda datos[i] con la clave claves[i], agrandando la tabla una sola
+// vez al principio. Si no puede guardar alguno devuelve false; los
+// anteriores quedan guardados.
+bool hash_guardar_lote(hash_t *hash, const char *const claves[], void *const datos[], size_t cant);
+
+// Borra cada clave y guarda su dato en datos[i], o NULL si no estaba.
+void hash_borrar_lote(hash_t *hash, const char *const claves[], size_t cant, void *datos[]);
+
+/* Construccion paralela y fusion */
+
+// Que dato queda en hash_fusionar cuando una clave esta en los dos hash.
+typedef enum hash_fusion{
+	HASH_FUSION_UNION,         // el de destino; el de origen queda en origen
+	HASH_FUSION_SOBREESCRIBIR, // el de origen; el de destino se destruye
+} hash_fusion_t;
+
+// Crea un hash con las opciones recibidas (puede ser NULL) y guarda
+// datos[i] con la clave claves[i], como hash_guardar_lote: si una clave
+// se repite queda el ultimo dato y los anteriores se destruyen. Usa hasta
+// hilos hilos: cada uno calcula el hash de una parte del lote y despues
+// arma rangos de posiciones de la tabla, ya del tamaño final, sin
+// candados ni redimensiones. En modo arena, con un asignador propio o en
+// modo cache usa un solo hilo. Como las claves repetidas se descartan en
+// los hilos, destruir_dato tiene que poder llamarse desde varios hilos a
+// la vez. Devuelve NULL si no hay memoria o las opciones son invalidas;
+// los datos que no se destruyeron siguen siendo del usuario.
+hash_t *hash_construir_paralelo(const char *const claves[], void *const datos[], size_t cant, size_t hilos, hash_destruir_dato_t destruir_dato, const hash_opciones_t *opciones);
+
+// Pasa a destino las claves de origen, segun politica. Si los dos hash
+// piden la memoria de la misma forma, los campos se mueven sin copiar
+// las claves; si ademas usan la misma funcion y semilla, sin recalcular
+// su hash. Las claves que pasan a destino se sacan de origen, que sigue
+// siendo valido y se destruye aparte. Devuelve false si no hay memoria;
+// las claves ya pasadas quedan en destino y el resto en origen. Si lo
+// que falto fue la memoria para el vencimiento de una clave, esa clave
+// queda en destino sin vencimiento.
+// Pre: los dos hash fueron creados y son distintos, y sus datos se
+// destruyen con la misma funcion. Si destino tiene claves prestadas,
+// origen tambien. Si destino no tiene vencimientos, las claves de origen
+// pierden el suyo.
+bool hash_fusionar(hash_t *destino, hash_t *origen, hash_fusion_t politica);
+
+/* Vencimientos
+ *
+ * Solo en un hash creado con la opcion vencimientos. Guardar una clave
+ * con hash_guardar (o cualquier primitiva que no sea hash_guardar_ttl) la
+ * deja sin vencimiento.
+ */
+
+// Guarda el par (clave, dato) como hash_guardar, y la clave vence ttl
+// milisegundos despues (segun el reloj del hash). Si la clave ya estaba,
+// reemplaza su dato y su vencimiento. De no poder guardarlo devuelve
+// false; si lo que falto fue la memoria para el vencimiento, la clave
+// queda guardada sin vencimiento.
+// Pre: el hash fue creado con vencimientos.
+bool hash_guardar_ttl(hash_t *hash, const char *clave, void *dato, uint64_t ttl);
+bool hash_guardar_ttl_n(hash_t *hash, const void *clave, size_t largo, void *dato, uint64_t ttl);
+
+// Borra las claves vencidas, destruyendo sus datos, mirando como mucho
+// presupuesto vencimientos registrados (los de claves que ya se borraron
+// o se volvieron a guardar tambien cuentan). Cada vencimiento se mira una
+// sola vez, asi que llamarla seguido con un presupuesto chico reparte el
+// trabajo sin recorrer la tabla. Devuelve la cantidad de claves borradas.
+// Pre: el hash fue creado.
+size_t hash_expirar(hash_t *hash, size_t presupuesto);
+
+/* Instantaneas
+ *
+ * Una instantanea es una vista de solo lectura del hash tal como estaba
+ * al crearla, que se puede leer desde otros hilos mientras el hash se
+ * sigue modificando. No copia la tabla: la comparte con el hash, que
+ * antes de modificar por primera vez una pagina de la tabla (64
+ * posiciones) copia sus campos y claves para las instantaneas que todavia
+ * la leen de la tabla. Esa copia la comparten todas ellas, y se libera al
+ * destruirse la ultima. Redimensionar o fusionar copia de una vez las
+ * paginas que falten.
+ * Las primitivas de la instantanea se pueden llamar desde cualquier hilo,
+ * a la vez que se modifica el hash; hash_snapshot no, y tampoco las
+ * modificaciones del hash entre si. Mientras haya instantaneas, una
+ * modificacion puede fallar por no tener memoria para copiar una pagina:
+ * hash_guardar devuelve false, y hash_borrar y hash_obtener_ptr devuelven
+ * NULL sin modificar el hash.
+ * Las instantaneas no son duenas de los datos: si el hash destruye un
+ * dato que una instantanea todavia ve (al reemplazarlo, desalojarlo o
+ * vencer), la instantanea devuelve el puntero ya destruido. Tampoco
+ * miran los vencimientos: tienen las claves que habia al crearlas,
+ * vencidas o no.
+ */
+
+struct hash_snapshot;
+typedef struct hash_snapshot hash_snapshot_t;
+
+// Crea una instantanea del hash. Si hay un rehash incremental en curso,
+// primero lo termina. Devuelve NULL si no hay memoria.
+// Pre: el hash fue creado.
+hash_snapshot_t *hash_snapshot(hash_t *hash);
+
+// Igual que hash_obtener y hash_obtener_n, sobre el hash al momento de
+// crear la instantanea. No la modifican.
+// Pre: la instantanea fue creada.
+void *hash_snapshot_obtener(const hash_snapshot_t *snapshot, const char *clave);
+void *hash_snapshot_obtener_n(const hash_snapshot_t *snapshot, const void *clave, size_t largo);
+
+// Igual que hash_pertenece y hash_pertenece_n.
+// Pre: la instantanea fue creada.
+bool hash_snapshot_pertenece(const hash_snapshot_t *snapshot, const char *clave);
+bool hash_snapshot_pertenece_n(const hash_snapshot_t *snapshot, const void *clave, size_t largo);
+
+// Devuelve la cantidad de elementos que tenia el hash al crearla.
+// Pre: la instantanea fue creada.
+size_t hash_snapshot_cantidad(const hash_snapshot_t *snapshot);
+
+// Recorre la instantanea aplicando visitar a cada clave y su dato, hasta
+// que visitar devuelva false. Las paginas que todavia se leen de la tabla
+// se copian de a una antes de visitarlas; el hash solo espera mientras se
+// copia la pagina que quiere modificar. Devuelve false si no hubo memoria
+// para copiar alguna, y entonces el recorrido queda a medias.
+// Pre: la instantanea fue creada.
+bool hash_snapshot_iterar(const hash_snapshot_t *snapshot, bool visitar(const char *clave, void *dato, void *extra), void *extra);
+
+// Destruye la instantanea. Se puede llamar desde cualquier hilo: su
+// memoria la libera el hash mas adelante, al modificarse, en hash_snapshot
+// o en hash_destruir.
+// Pre: la instantanea fue creada y no se la vuelve a usar.
+void hash_snapshot_destruir(hash_snapshot_t *snapshot);
+
+/* Iterador interno del hash */
+
+// Recorre el hash aplicando visitar a cada clave y su dato, hasta que
+// visitar devuelva false. No pide memoria.
+// Pre: La estructura hash fue inicializada
+void hash_iterar(const hash_t *hash, bool visitar(const char *clave, void *dato, void *extra), void *extra);
+
 /* Iterador del hash */
 
 // Crea iterador
 hash_iter_t *hash_iter_crear(const hash_t *hash);
 
+// Inicializa un iterador guardado por el usuario (por ejemplo, en el
+// stack). No hace falta destruirlo.
+void hash_iter_inicializar(hash_iter_t *iter, const hash_t *hash);
+
 // Avanza iterador
 bool hash_iter_avanzar(hash_iter_t *iter);
 
 // Devuelve clave actual, esa clave no se puede modificar ni liberar.
 const char *hash_iter_ver_actual(const hash_iter_t *iter);
 
+// Igual que hash_iter_ver_actual, y ademas guarda el largo de la clave en
+// largo (la clave termina en un '\0' extra, salvo que sea prestada).
+const char *hash_iter_ver_actual_n(const hash_iter_t *iter, size_t *largo);
+
+// Devuelve el dato de la clave actual, o NULL si el iterador esta al
+// final. A diferencia de hash_obtener no busca la clave, asi que no
+// modifica el hash (no borra claves vencidas ni las marca como usadas).
+void *hash_iter_ver_dato(const hash_iter_t *iter);
+
 // Comprueba si terminó la iteración
 bool hash_iter_al_final(const hash_iter_t *iter);
 
-// Destruye iterador
+// Destruye iterador creado con hash_iter_crear
 void hash_iter_destruir(hash_iter_t* iter);
 
 #endif // HASH_H
@@ -0,0 +1,414 @@
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "hash_archivo.h"
+#define MAGIA "TDAHASH"
+#define VERSION 1
+#define ORDEN 0x01020304 // para rechazar archivos de otro orden de bytes
+#define TAM_BLOQUE 65536 // bytes que se suman juntos en la suma de control
+
+/* *****************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+/* Formato del archivo:
+ *  - el encabezado;
+ *  - tam ranuras (tabla de sondeo lineal, con carga de a lo sumo 1/2);
+ *  - un registro por clave: largo de la clave, largo del dato, la clave
+ *    con un '\0' al final y el dato, cada parte alineada a 8 bytes.
+ * Todas las posiciones son desplazamientos desde el inicio del archivo.
+ * El hash de las claves es hash_funcion_wy con la semilla del
+ * encabezado, que no depende del procesador.
+ */
+typedef struct encabezado{
+	char magia[8];
+	uint32_t version;
+	uint32_t orden;
+	uint64_t cant;
+	uint64_t tam;     // cantidad de ranuras, potencia de dos
+	uint64_t semilla;
+	uint64_t largo;   // largo total del archivo
+	uint64_t suma;    // suma de control de todo lo que sigue al encabezado
+} encabezado_t;
+
+typedef struct ranura{
+	uint64_t hash;
+	uint64_t desplazamiento; // 0 si la ranura esta vacia
+} ranura_t;
+
+typedef struct registro{
+	uint64_t largo_clave;
+	uint64_t largo_dato;
+} registro_t;
+
+struct hash_mmap{
+	const unsigned char* base;
+	size_t largo;
+	const encabezado_t* encabezado;
+	const ranura_t* ranuras;
+};
+
+struct hash_texto{
+	const char* base; // NULL si el archivo esta vacio
+	size_t largo;
+	hash_t* hash;     // clave: la de cada linea; dato: el comienzo de su valor
+};
+
+/* *****************************************************************
+ *                DEFINICION DE FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+/* Mapea todo el archivo de solo lectura y guarda su largo. Devuelve
+ * MAP_FAILED si no se pudo; un archivo vacio se mapea como NULL.
+ */
+static void* mapear(const char* ruta, size_t* largo){
+	int fd = open(ruta, O_RDONLY);
+	if(fd < 0) return MAP_FAILED;
+	struct stat info;
+	if(fstat(fd, &info)){
+		close(fd);
+		return MAP_FAILED;
+	}
+	*largo = (size_t)info.st_size;
+	void* base = *largo ? mmap(NULL, *largo, PROT_READ, MAP_SHARED, fd, 0) : NULL;
+	close(fd);
+	return base;
+}
+
+static uint64_t alinear(uint64_t n){
+	return (n + 7) & ~(uint64_t)7;
+}
+
+/* Completa con ceros hasta que la posicion del archivo quede alineada a
+ * 8 bytes.
+ */
+static bool rellenar(FILE* archivo){
+	static const char ceros[8];
+	off_t pos = ftello(archivo);
+	if(pos < 0) return false;
+	size_t falta = (size_t)(alinear((uint64_t)pos) - (uint64_t)pos);
+	return fwrite(ceros, 1, falta, archivo) == falta;
+}
+
+/* Escribe el registro de la clave al final del archivo y devuelve su
+ * desplazamiento, o 0 si hubo un error. El largo del dato se completa
+ * despues de escribirlo, porque serializar no lo informa.
+ */
+static uint64_t escribir_registro(FILE* archivo, const char* clave, size_t largo, const void* dato, hash_serializar_dato_t serializar){
+	off_t inicio = ftello(archivo);
+	registro_t registro = {largo, 0};
+	if(inicio < 0 || fwrite(&registro, sizeof(registro), 1, archivo) != 1)
+		return 0;
+	// Las claves prestadas pueden no terminar en '\0': se lo escribe aparte.
+	if(fwrite(clave, 1, largo, archivo) != largo || fputc('\0', archivo) == EOF || !rellenar(archivo))
+		return 0;
+	off_t inicio_dato = ftello(archivo);
+	if(serializar && !serializar(dato, archivo))
+		return 0;
+	off_t fin_dato = ftello(archivo);
+	if(inicio_dato < 0 || fin_dato < 0 || !rellenar(archivo))
+		return 0;
+	if(fin_dato != inicio_dato){
+		registro.largo_dato = (uint64_t)(fin_dato - inicio_dato);
+		if(fseeko(archivo, inicio, SEEK_SET) || fwrite(&registro, sizeof(registro), 1, archivo) != 1)
+			return 0;
+		if(fseeko(archivo, 0, SEEK_END))
+			return 0;
+	}
+	return (uint64_t)inicio;
+}
+
+/* Calcula la suma de control de los largo bytes que empiezan en datos,
+ * de a TAM_BLOQUE bytes, encadenando cada bloque con el anterior.
+ */
+static uint64_t sumar_bloque(const void* datos, size_t largo, uint64_t suma){
+	return hash_funcion_wy(datos, largo, suma);
+}
+
+/* Calcula la suma de control del archivo desde el fin del encabezado,
+ * leyendolo de nuevo.
+ */
+static bool sumar_archivo(FILE* archivo, uint64_t* suma){
+	unsigned char* bloque = malloc(TAM_BLOQUE);
+	if(!bloque) return false;
+	if(fflush(archivo) || fseeko(archivo, (off_t)sizeof(encabezado_t), SEEK_SET)){
+		free(bloque);
+		return false;
+	}
+	*suma = 0;
+	size_t leidos;
+	while((leidos = fread(bloque, 1, TAM_BLOQUE, archivo)) > 0)
+		*suma = sumar_bloque(bloque, leidos, *suma);
+	bool ok = !ferror(archivo);
+	free(bloque);
+	return ok;
+}
+
+/* Devuelve el registro que empieza en desplazamiento, o NULL si no entra
+ * entero en el mapeo (el archivo esta dañado o truncado): el encabezado
+ * del registro, la clave con su '\0' y el dato.
+ */
+static const registro_t* registro_en(const hash_mmap_t* hash, uint64_t desplazamiento){
+	if(desplazamiento % 8 || desplazamiento > hash->largo - sizeof(registro_t))
+		return NULL;
+	const registro_t* registro = (const registro_t*)(hash->base + desplazamiento);
+	uint64_t resto = hash->largo - desplazamiento - sizeof(registro_t);
+	if(registro->largo_clave >= resto || alinear(registro->largo_clave + 1) > resto)
+		return NULL;
+	if(registro->largo_dato > resto - alinear(registro->largo_clave + 1))
+		return NULL;
+	return registro;
+}
+
+/* Busca la clave en el archivo mapeado. Devuelve su registro, o NULL si
+ * no esta. Mira como mucho tam ranuras, por si el archivo no tiene
+ * ninguna vacia, y saltea los registros que no entran en el mapeo.
+ */
+static const registro_t* buscar_registro(const hash_mmap_t* hash, const void* clave, size_t largo){
+	const encabezado_t* encabezado = hash->encabezado;
+	uint64_t h = hash_funcion_wy(clave, largo, encabezado->semilla);
+	uint64_t mascara = encabezado->tam - 1;
+	uint64_t i = h & mascara;
+	for(uint64_t vistas = 0; vistas < encabezado->tam && hash->ranuras[i].desplazamiento; vistas++, i = (i + 1) & mascara){
+		const ranura_t* ranura = &hash->ranuras[i];
+		if(ranura->hash != h)
+			continue;
+		const registro_t* registro = registro_en(hash, ranura->desplazamiento);
+		if(registro && registro->largo_clave == largo && memcmp(registro + 1, clave, largo) == 0)
+			return registro;
+	}
+	return NULL;
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DEL ARCHIVO
+ * *****************************************************************/
+
+bool hash_guardar_archivo(const hash_t* hash, const char* ruta, hash_serializar_dato_t serializar){
+	encabezado_t encabezado;
+	memset(&encabezado, 0, sizeof(encabezado));
+	memcpy(encabezado.magia, MAGIA, sizeof(MAGIA));
+	encabezado.version = VERSION;
+	encabezado.orden = ORDEN;
+	encabezado.cant = hash_cantidad(hash);
+	encabezado.tam = 1;
+	while(encabezado.tam < 2 * encabezado.cant)
+		encabezado.tam <<= 1;
+	encabezado.semilla = hash_semilla_aleatoria(hash);
+
+	// Se escribe en ruta.tmp y se renombra al final, para que ruta tenga
+	// siempre el archivo anterior o el nuevo completo.
+	char* temporal = malloc(strlen(ruta) + sizeof(".tmp"));
+	ranura_t* ranuras = calloc((size_t)encabezado.tam, sizeof(ranura_t));
+	FILE* archivo = NULL;
+	if(temporal && ranuras){
+		strcpy(temporal, ruta);
+		strcat(temporal, ".tmp");
+		archivo = fopen(temporal, "wb+");
+	}
+	if(!archivo){
+		free(temporal);
+		free(ranuras);
+		return false;
+	}
+	off_t inicio_registros = (off_t)(sizeof(encabezado_t) + sizeof(ranura_t) * encabezado.tam);
+	bool ok = fseeko(archivo, inicio_registros, SEEK_SET) == 0;
+
+	hash_iter_t iter;
+	uint64_t mascara = encabezado.tam - 1;
+	for(hash_iter_inicializar(&iter, hash); ok && !hash_iter_al_final(&iter); hash_iter_avanzar(&iter)){
+		size_t largo;
+		const char* clave = hash_iter_ver_actual_n(&iter, &largo);
+		uint64_t desplazamiento = escribir_registro(archivo, clave, largo, hash_iter_ver_dato(&iter), serializar);
+		if(!desplazamiento){
+			ok = false;
+			break;
+		}
+		uint64_t h = hash_funcion_wy(clave, largo, encabezado.semilla);
+		uint64_t i = h & mascara;
+		while(ranuras[i].desplazamiento)
+			i = (i + 1) & mascara;
+		ranuras[i].hash = h;
+		ranuras[i].desplazamiento = desplazamiento;
+	}
+
+	if(ok){
+		off_t fin = ftello(archivo);
+		encabezado.largo = (uint64_t)fin;
+		ok = fin >= 0 && fseeko(archivo, (off_t)sizeof(encabezado_t), SEEK_SET) == 0
+			&& fwrite(ranuras, sizeof(ranura_t), (size_t)encabezado.tam, archivo) == encabezado.tam
+			&& sumar_archivo(archivo, &encabezado.suma)
+			&& fseeko(archivo, 0, SEEK_SET) == 0
+			&& fwrite(&encabezado, sizeof(encabezado), 1, archivo) == 1
+			&& fflush(archivo) == 0
+			&& fsync(fileno(archivo)) == 0;
+	}
+	free(ranuras);
+	if(fclose(archivo))
+		ok = false;
+	if(ok)
+		ok = rename(temporal, ruta) == 0;
+	if(!ok)
+		remove(temporal);
+	free(temporal);
+	return ok;
+}
+
+hash_mmap_t* hash_abrir_mmap(const char* ruta){
+	size_t largo;
+	void* base = mapear(ruta, &largo);
+	if(base == MAP_FAILED) return NULL;
+	if(largo < sizeof(encabezado_t)){
+		if(base)
+			munmap(base, largo);
+		return NULL;
+	}
+
+	const encabezado_t* encabezado = base;
+	bool valido = memcmp(encabezado->magia, MAGIA, sizeof(MAGIA)) == 0
+		&& encabezado->version == VERSION && encabezado->orden == ORDEN
+		&& encabezado->largo == largo
+		&& encabezado->tam > 0 && (encabezado->tam & (encabezado->tam - 1)) == 0
+		&& encabezado->cant < encabezado->tam
+		&& encabezado->tam <= (largo - sizeof(encabezado_t)) / sizeof(ranura_t);
+	hash_mmap_t* hash = valido ? malloc(sizeof(hash_mmap_t)) : NULL;
+	if(!hash){
+		munmap(base, largo);
+		return NULL;
+	}
+	hash->base = base;
+	hash->largo = largo;
+	hash->encabezado = encabezado;
+	hash->ranuras = (const ranura_t*)(encabezado + 1);
+	return hash;
+}
+
+bool hash_mmap_verificar(const hash_mmap_t* hash){
+	uint64_t suma = 0;
+	for(size_t pos = sizeof(encabezado_t); pos < hash->largo; pos += TAM_BLOQUE){
+		size_t largo = hash->largo - pos < TAM_BLOQUE ? hash->largo - pos : TAM_BLOQUE;
+		suma = sumar_bloque(hash->base + pos, largo, suma);
+	}
+	return suma == hash->encabezado->suma;
+}
+
+const void* hash_mmap_obtener(const hash_mmap_t* hash, const char* clave, size_t* largo){
+	return hash_mmap_obtener_n(hash, clave, strlen(clave), largo);
+}
+
+const void* hash_mmap_obtener_n(const hash_mmap_t* hash, const void* clave, size_t largo_clave, size_t* largo){
+	const registro_t* registro = buscar_registro(hash, clave, largo_clave);
+	if(!registro) return NULL;
+	if(largo)
+		*largo = (size_t)registro->largo_dato;
+	return (const unsigned char*)(registro + 1) + alinear(registro->largo_clave + 1);
+}
+
+bool hash_mmap_pertenece(const hash_mmap_t* hash, const char* clave){
+	return buscar_registro(hash, clave, strlen(clave)) != NULL;
+}
+
+bool hash_mmap_pertenece_n(const hash_mmap_t* hash, const void* clave, size_t largo_clave){
+	return buscar_registro(hash, clave, largo_clave) != NULL;
+}
+
+size_t hash_mmap_cantidad(const hash_mmap_t* hash){
+	return (size_t)hash->encabezado->cant;
+}
+
+void hash_mmap_cerrar(hash_mmap_t* hash){
+	munmap((void*)hash->base, hash->largo);
+	free(hash);
+}
+
+/* Archivos de texto */
+
+/* Cuenta las lineas antes de indexarlas, para armar la tabla de una vez,
+ * y guarda cada clave con hash_guardar_n apuntando al mapeo.
+ */
+hash_texto_t* hash_abrir_texto(const char* ruta, const hash_opciones_t* opciones){
+	hash_opciones_t opc;
+	memset(&opc, 0, sizeof(opc));
+	if(opciones) opc = *opciones;
+	opc.claves_prestadas = true;
+
+	size_t largo;
+	void* base = mapear(ruta, &largo);
+	if(base == MAP_FAILED) return NULL;
+	hash_texto_t* texto = malloc(sizeof(hash_texto_t));
+	hash_t* hash = hash_crear_con_opciones(NULL, &opc);
+	if(!texto || !hash){
+		free(texto);
+		if(hash)
+			hash_destruir(hash);
+		if(base)
+			munmap(base, largo);
+		return NULL;
+	}
+	texto->base = base;
+	texto->largo = largo;
+	texto->hash = hash;
+
+	const char* fin = texto->base + largo;
+	size_t lineas = 0;
+	for(const char* p = texto->base; p < fin; lineas++){
+		const char* salto = memchr(p, '\n', (size_t)(fin - p));
+		p = salto ? salto + 1 : fin;
+	}
+	bool ok = hash_reservar(hash, lineas);
+	for(const char* linea = texto->base; ok && linea < fin;){
+		const char* salto = memchr(linea, '\n', (size_t)(fin - linea));
+		const char* fin_linea = salto ? salto : fin;
+		if(fin_linea > linea && fin_linea[-1] == '\r')
+			fin_linea--;
+		if(fin_linea > linea){
+			const char* tab = memchr(linea, '\t', (size_t)(fin_linea - linea));
+			const char* fin_clave = tab ? tab : fin_linea;
+			const char* valor = tab ? tab + 1 : fin_linea;
+			ok = hash_guardar_n(hash, linea, (size_t)(fin_clave - linea), (void*)valor);
+		}
+		linea = salto ? salto + 1 : fin;
+	}
+	if(!ok){
+		hash_texto_cerrar(texto);
+		return NULL;
+	}
+	return texto;
+}
+
+const char* hash_texto_obtener(const hash_texto_t* texto, const char* clave, size_t* largo){
+	return hash_texto_obtener_n(texto, clave, strlen(clave), largo);
+}
+
+/* El largo del valor se calcula buscando el fin de su linea.
+ */
+const char* hash_texto_obtener_n(const hash_texto_t* texto, const void* clave, size_t largo_clave, size_t* largo){
+	const char* valor = hash_obtener_n(texto->hash, clave, largo_clave);
+	if(!valor) return NULL;
+	if(largo){
+		const char* fin = texto->base + texto->largo;
+		const char* salto = memchr(valor, '\n', (size_t)(fin - valor));
+		const char* fin_valor = salto ? salto : fin;
+		if(fin_valor > valor && fin_valor[-1] == '\r')
+			fin_valor--;
+		*largo = (size_t)(fin_valor - valor);
+	}
+	return valor;
+}
+
+const hash_t* hash_texto_hash(const hash_texto_t* texto){
+	return texto->hash;
+}
+
+void hash_texto_cerrar(hash_texto_t* texto){
+	hash_destruir(texto->hash);
+	if(texto->base)
+		munmap((void*)texto->base, texto->largo);
+	free(texto);
+}
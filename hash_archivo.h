@@ -0,0 +1,121 @@
+#ifndef HASH_ARCHIVO_H
+#define HASH_ARCHIVO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "hash.h"
+
+/* Guardado de un hash en un archivo y lectura del archivo mapeado en
+ * memoria, sin reconstruir el hash: abrir el archivo no depende de la
+ * cantidad de claves y no pide memoria por clave. El archivo solo tiene
+ * desplazamientos (no punteros), asi que se puede mapear en cualquier
+ * direccion. Los datos se leen como bytes dentro del mapeo.
+ * Tambien se puede indexar un archivo de texto de claves y valores sin
+ * copiarlo (ver hash_abrir_texto).
+ * Se compila junto con una de las implementaciones de hash.h y usa
+ * open, mmap y fseeko de POSIX.
+ */
+
+struct hash_mmap;
+typedef struct hash_mmap hash_mmap_t;
+
+struct hash_texto;
+typedef struct hash_texto hash_texto_t;
+
+// Tipo de funcion para escribir un dato en el archivo. Devuelve false si
+// no pudo escribirlo. Lo que escriba es lo que devuelve hash_mmap_obtener
+// para esa clave.
+typedef bool (*hash_serializar_dato_t)(const void *dato, FILE *archivo);
+
+/* Escribe en ruta todas las claves del hash y sus datos, escritos con
+ * serializar (si es NULL, los datos quedan vacios). Devuelve false si no
+ * se pudo escribir el archivo. Escribe primero ruta con ".tmp" agregado,
+ * lo baja a disco y lo renombra a ruta: si falla o se corta, ruta sigue
+ * teniendo el archivo anterior (si habia). No modifica el hash: las
+ * claves vencidas que todavia no se borraron tambien se escriben.
+ * Pre: el hash fue creado.
+ */
+bool hash_guardar_archivo(const hash_t *hash, const char *ruta, hash_serializar_dato_t serializar);
+
+/* Mapea en memoria un archivo escrito con hash_guardar_archivo, de solo
+ * lectura. Verifica el encabezado (version, tamaños) pero no la suma de
+ * control, para no leer todo el archivo; para eso esta
+ * hash_mmap_verificar. Aun sin verificarlo, las busquedas en un archivo
+ * dañado no leen fuera del mapeo: ignoran los registros que no entran.
+ * Post: devuelve el hash mapeado, o NULL si el archivo no se pudo abrir
+ * o no es valido.
+ */
+hash_mmap_t *hash_abrir_mmap(const char *ruta);
+
+/* Recorre todo el archivo y devuelve true si la suma de control coincide
+ * con la del encabezado.
+ * Pre: el hash mapeado fue abierto.
+ */
+bool hash_mmap_verificar(const hash_mmap_t *hash);
+
+/* Devuelve el dato de la clave y guarda su largo en largo (si no es
+ * NULL), o NULL si la clave no esta. El dato vive dentro del mapeo: no se
+ * puede modificar ni liberar, y es valido hasta hash_mmap_cerrar. Esta
+ * alineado a 8 bytes.
+ * Pre: el hash mapeado fue abierto.
+ */
+const void *hash_mmap_obtener(const hash_mmap_t *hash, const char *clave, size_t *largo);
+const void *hash_mmap_obtener_n(const hash_mmap_t *hash, const void *clave, size_t largo_clave, size_t *largo);
+
+/* Determina si la clave esta en el archivo.
+ * Pre: el hash mapeado fue abierto.
+ */
+bool hash_mmap_pertenece(const hash_mmap_t *hash, const char *clave);
+bool hash_mmap_pertenece_n(const hash_mmap_t *hash, const void *clave, size_t largo_clave);
+
+/* Devuelve la cantidad de claves del archivo.
+ * Pre: el hash mapeado fue abierto.
+ */
+size_t hash_mmap_cantidad(const hash_mmap_t *hash);
+
+/* Desmapea el archivo.
+ * Pre: el hash mapeado fue abierto.
+ * Post: los datos obtenidos dejan de ser validos.
+ */
+void hash_mmap_cerrar(hash_mmap_t *hash);
+
+/* Archivos de texto */
+
+/* Mapea en memoria un archivo de texto con un par por linea: la clave va
+ * hasta la primera tabulacion y el valor desde ahi hasta el fin de la
+ * linea (sin un '\r' final). Una linea sin tabulacion es una clave con
+ * valor vacio, y las lineas vacias se saltean. Si una clave se repite
+ * queda la ultima linea.
+ * Indexa las lineas en un hash creado con opciones (puede ser NULL) y
+ * claves prestadas: las claves y los valores quedan dentro del mapeo, sin
+ * copiarlos, y con hash_cerrado.c o en modo arena no se pide memoria por
+ * clave fuera de la tabla.
+ * Post: devuelve el archivo indexado, o NULL si no se pudo abrir o no hay
+ * memoria.
+ */
+hash_texto_t *hash_abrir_texto(const char *ruta, const hash_opciones_t *opciones);
+
+/* Devuelve el valor de la clave y guarda su largo en largo (si no es
+ * NULL), o NULL si la clave no esta. El valor vive dentro del mapeo: no
+ * termina en '\0', no se puede modificar ni liberar, y es valido hasta
+ * hash_texto_cerrar.
+ * Pre: el archivo fue abierto.
+ */
+const char *hash_texto_obtener(const hash_texto_t *texto, const char *clave, size_t *largo);
+const char *hash_texto_obtener_n(const hash_texto_t *texto, const void *clave, size_t largo_clave, size_t *largo);
+
+/* Devuelve el hash del archivo, para consultarlo o recorrerlo con las
+ * primitivas de hash.h. Sus claves no terminan en '\0' y sus datos son
+ * el comienzo de cada valor (ver hash_texto_obtener para el largo).
+ * Pre: el archivo fue abierto.
+ */
+const hash_t *hash_texto_hash(const hash_texto_t *texto);
+
+/* Destruye el hash y desmapea el archivo.
+ * Pre: el archivo fue abierto.
+ * Post: las claves y valores obtenidos dejan de ser validos.
+ */
+void hash_texto_cerrar(hash_texto_t *texto);
+
+#endif // HASH_ARCHIVO_H
@@ -0,0 +1,1688 @@
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hash.h"
+#include "bitmap.h"
+#include "particion.h"
+#include "robin_hood.h"
+#include "rueda.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+// Politica de redimension por defecto
+#define TAM_INICIAL 64 // siempre potencia de dos
+#define COEF_REDIM 2
+#define UMBRAL_MAX 0.7
+#define LOTE 16 // claves que se preparan juntas en las primitivas por lotes
+#define GRUPO 16 // bytes de control que se comparan juntos al buscar
+#define VACIO 0x80 // byte de control de una posicion vacia
+#define SIN_VENCIMIENTO UINT64_MAX
+#define BITS_PAGINA 6 // las instantaneas copian la tabla de a 64 posiciones
+#define POSICIONES_PAGINA ((size_t)1 << BITS_PAGINA)
+#define RECOLECTAR_CADA 1024 // modificaciones entre recolecciones de instantaneas destruidas
+// Etiqueta de 7 bits del hash que se guarda en el byte de control. No
+// usa los bits bajos (la posicion) ni los altos (hash_concurrente los usa
+// para elegir el segmento, y serian iguales en toda la tabla).
+#define ETIQUETA(h) ((uint8_t)(((uint64_t)(h) >> 40) & 0x7f))
+
+// En modo cache, bit del largo de un campo que indica que se uso desde
+// la ultima pasada de la manecilla (ver desalojar). LARGO lo descarta.
+#define USADO ((size_t)1 << (sizeof(size_t) * 8 - 1))
+#define LARGO(campo) ((campo)->largo & ~USADO)
+
+// Cuenta una busqueda en las estadisticas, si se compilo con
+// HASH_CONTADORES o el hash esta en modo cache. Modifica el hash aunque
+// la primitiva lo reciba como const (siempre se lo pide con malloc).
+#ifdef HASH_CONTADORES
+#define CONTAR_SIEMPRE true
+#else
+#define CONTAR_SIEMPRE false
+#endif
+#define CONTAR_BUSQUEDA(hash, encontrada) do{ \
+	if(CONTAR_SIEMPRE || (hash)->cache){ \
+		((hash_t*)(hash))->busquedas++; \
+		if(encontrada) ((hash_t*)(hash))->aciertos++; \
+	} \
+}while(0)
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PRECARGAR(p) __builtin_prefetch(p)
+#else
+#define PRECARGAR(p) ((void)(p))
+#endif
+/* *****************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+/* Hash cerrado: los campos se guardan en linea dentro de un unico
+ * arreglo y las colisiones se resuelven con sondeo lineal Robin Hood.
+ * El borrado desplaza hacia atras a los campos siguientes, por lo que
+ * no hacen falta lapidas (un campo vacio tiene clave NULL).
+ * Cada posicion tiene ademas un byte de control, VACIO o la etiqueta del
+ * hash de su clave, y la busqueda compara GRUPO bytes de control a la
+ * vez antes de mirar los campos.
+ */
+struct campo_hash{
+	char* clave;
+	void* valor;
+	size_t hash; // valor completo de la funcion de hashing
+	size_t largo; // largo de la clave, sin contar el '\0' (mas USADO)
+}typedef campo_hash_t;
+
+// La tabla es un arreglo de tam campos seguido de un bitmap con las
+// posiciones ocupadas (ver ocupadas) y de los bytes de control (ver
+// control).
+struct hash{
+	campo_hash_t* tabla;
+	size_t tam; // siempre potencia de dos
+	size_t cant;
+	hash_destruir_dato_t destruir;
+	hash_funcion_t funcion;
+	uint64_t semilla;
+	hash_politica_t politica;
+	asignador_t asignador;
+	arena_t* arena; // NULL si las claves no se guardan en una arena
+	bool prestadas; // las claves son del usuario (ver hash_opciones_t)
+	size_t max_distancia; // cota de la distancia de los campos a su posicion ideal
+	// Modo cache (ver hash_opciones_t)
+	bool cache;
+	size_t cache_entradas;
+	size_t cache_bytes;
+	size_t (*bytes_dato)(const void* dato);
+	size_t bytes;
+	size_t manecilla; // proxima posicion que mira desalojar
+	// Vencimientos (ver hash_opciones_t). Cada clave se copia con su
+	// vencimiento delante (ver vencimiento), y los registros de la rueda la
+	// identifican por su direccion, que no cambia al moverse el campo.
+	rueda_t* rueda; // NULL si no hay vencimientos
+	uint64_t (*reloj)(void);
+	// Estadisticas (ver hash_estadisticas)
+	size_t redimensiones;
+	uint64_t ns_redimension;
+	uint64_t max_ns_redimension;
+	uint64_t busquedas;
+	uint64_t aciertos;
+	size_t desalojos;
+	size_t vencidas;
+	// Instantaneas (ver hash_snapshot), de la mas nueva a la mas vieja.
+	// preservadas[p] es la generacion de la ultima instantanea para la que
+	// se copio la pagina p; es NULL si ninguna lee paginas de la tabla.
+	hash_snapshot_t* instantaneas;
+	uint64_t generacion;
+	uint64_t* preservadas;
+	size_t hasta_recolectar;
+};
+
+// Copia de una pagina de la tabla (o de toda la tabla, si es mas chica)
+// que guardan las instantaneas, con claves propias. La comparten las
+// instantaneas que todavia leian la pagina de la tabla al copiarla.
+struct pagina{
+	size_t refs;
+	campo_hash_t campos[POSICIONES_PAGINA];
+}typedef pagina_t;
+
+// Cada pagina de una instantanea se lee de su copia o, mientras el hash
+// no la modifique, de la tabla del hash, que entonces tiene el mismo tam.
+struct hash_snapshot{
+	hash_t* hash;
+	pthread_mutex_t mutex; // protege paginas y terminada
+	pagina_t** paginas; // NULL: la pagina se lee de la tabla
+	size_t tam;
+	size_t cant;
+	uint64_t generacion;
+	bool terminada; // el usuario la destruyo (ver recolectar_instantaneas)
+	struct hash_snapshot* sig; // la siguiente mas vieja
+};
+
+// Trabajo de un hilo de hash_construir_paralelo: ubicar las claves de la
+// particion p en su propio rango de la tabla. Las que no entran antes del
+// final del rango se guardan en desbordados y las ubica despues un solo
+// hilo.
+struct rango{
+	hash_t* hash;
+	const particion_t* particion;
+	const char* const* claves;
+	void* const* datos;
+	size_t p;
+	size_t cant; // claves ubicadas en el rango
+	size_t max_distancia;
+	campo_hash_t* desbordados;
+	size_t cant_desbordados;
+	bool ok; // false si no hubo memoria
+}typedef rango_t;
+
+/* *****************************************************************
+ *                DEFINICION DE FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+/* Devuelve la menor potencia de dos mayor o igual a n.
+ */
+static size_t potencia_de_dos(size_t n){
+	size_t tam = 1;
+	while(tam < n)
+		tam <<= 1;
+	return tam;
+}
+
+/* Completa los campos en cero de la politica con los valores por defecto.
+ * Devuelve false si la politica recibida es invalida. La carga maxima
+ * tiene que ser menor a 1 para que siempre quede un campo vacio.
+ */
+static bool normalizar_politica(hash_politica_t* politica){
+	if(politica->carga_maxima == 0)
+		politica->carga_maxima = UMBRAL_MAX;
+	if(politica->factor_crecimiento == 0)
+		politica->factor_crecimiento = COEF_REDIM;
+	// Por defecto se achica con la mitad de la carga que queda al crecer.
+	if(politica->carga_minima == 0)
+		politica->carga_minima = politica->carga_maxima / (double)(2 * politica->factor_crecimiento);
+	politica->tam_inicial = politica->tam_inicial ? potencia_de_dos(politica->tam_inicial) : TAM_INICIAL;
+
+	size_t factor = politica->factor_crecimiento;
+	if(politica->carga_maxima <= 0 || politica->carga_maxima >= 1 || factor < 2 || (factor & (factor - 1)) != 0)
+		return false;
+	return politica->nunca_achicar || (politica->carga_minima > 0 &&
+		politica->carga_minima < politica->carga_maxima / (double)factor);
+}
+
+/* Devuelve el tamaño al que hay que llevar la tabla para que la carga
+ * quede por debajo de carga_maxima / factor_crecimiento, o el tamaño
+ * actual si no corresponde achicarla.
+ */
+static size_t tam_achicado(const hash_t* hash){
+	const hash_politica_t* politica = &hash->politica;
+	size_t tam = hash->tam;
+	if(politica->nunca_achicar || (double)hash->cant >= politica->carga_minima * (double)tam)
+		return tam;
+	double carga_objetivo = politica->carga_maxima / (double)politica->factor_crecimiento;
+	while(tam / 2 >= politica->tam_inicial && (double)hash->cant <= carga_objetivo * (double)(tam / 2))
+		tam /= 2;
+	return tam;
+}
+
+/* Devuelve el tamaño de tabla necesario para guardar n elementos sin
+ * superar la carga maxima.
+ */
+static size_t tam_para(const hash_politica_t* politica, size_t n){
+	return potencia_de_dos((size_t)((double)n / politica->carga_maxima) + 1);
+}
+
+/* Distancia entre la posicion pos y la posicion ideal del campo que la
+ * ocupa.
+ */
+static size_t distancia(const hash_t* hash, size_t pos){
+	return robin_distancia(hash->tabla[pos].hash, pos, hash->tam - 1);
+}
+
+static uint64_t* ocupadas(campo_hash_t* tabla, size_t tam);
+static uint8_t* control(campo_hash_t* tabla, size_t tam);
+
+/* Devuelve una mascara con el bit k en 1 si el byte k del grupo que
+ * empieza en bytes es igual a byte. Con SSE2 compara los GRUPO bytes en
+ * una sola instruccion.
+ */
+static uint32_t grupo_iguales(const uint8_t* bytes, uint8_t byte){
+#if defined(__SSE2__)
+	__m128i grupo = _mm_loadu_si128((const __m128i*)bytes);
+	return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(grupo, _mm_set1_epi8((char)byte)));
+#else
+	uint32_t mascara = 0;
+	for(size_t k = 0; k < GRUPO; k++)
+		mascara |= (uint32_t)(bytes[k] == byte) << k;
+	return mascara;
+#endif
+}
+
+/* Escribe el byte de control de la posicion i. Los bytes de las
+ * primeras posiciones se repiten despues del final, para que un grupo
+ * que empieza cerca del final se pueda leer de corrido.
+ */
+static void poner_control(uint8_t* bytes, size_t tam, size_t i, uint8_t byte){
+	bytes[i] = byte;
+	for(size_t j = i + tam; j < tam + GRUPO; j += tam)
+		bytes[j] = byte;
+}
+
+/* Busca la posicion de la clave en la tabla. Devuelve true y la guarda
+ * en pos si la encontro. Recorre los bytes de control de a GRUPO desde
+ * la posicion ideal y solo mira los campos cuya etiqueta coincide; corta
+ * en el primer campo vacio o al superar max_distancia, por lo que una
+ * clave que no esta suele descartarse con una sola comparacion.
+ */
+static bool buscar_posicion(const hash_t* hash, const void* clave, size_t largo, size_t h, size_t* pos){
+	size_t mascara = hash->tam - 1;
+	const uint8_t* bytes = control(hash->tabla, hash->tam);
+	uint8_t etiqueta = ETIQUETA(h);
+	for(size_t g = 0; g <= hash->max_distancia; g += GRUPO){
+		size_t base = ((h & mascara) + g) & mascara;
+		uint32_t candidatos = grupo_iguales(bytes + base, etiqueta);
+		uint32_t vacias = grupo_iguales(bytes + base, VACIO);
+		if(vacias)
+			candidatos &= (vacias & (0u - vacias)) - 1;
+		if(hash->max_distancia - g + 1 < GRUPO)
+			candidatos &= ((uint32_t)1 << (hash->max_distancia - g + 1)) - 1;
+		while(candidatos){
+			size_t i = (base + bitmap_primer_bit(candidatos)) & mascara;
+			const campo_hash_t* campo = &hash->tabla[i];
+			if(campo->hash == h && LARGO(campo) == largo && memcmp(campo->clave, clave, largo) == 0){
+				*pos = i;
+				return true;
+			}
+			candidatos &= candidatos - 1;
+		}
+		if(vacias) return false;
+	}
+	return false;
+}
+
+/* Inserta el campo en la tabla recibida sin verificar duplicados. Lo
+ * ubica en el primer campo mas cercano a su posicion ideal que el, y
+ * corre un lugar hacia adelante al resto del tramo. Devuelve la mayor
+ * distancia a su posicion ideal de los campos que ubico.
+ * Pre: la tabla tiene al menos un campo vacio.
+ */
+static size_t insertar_campo(campo_hash_t* tabla, size_t tam, campo_hash_t campo){
+	size_t mascara = tam - 1;
+	uint8_t* bytes = control(tabla, tam);
+	size_t pos = campo.hash & mascara, d = 0;
+	ROBIN_SONDEAR(pos, d, mascara, tabla[pos].clave && robin_distancia(tabla[pos].hash, pos, mascara) >= d);
+	size_t max = d, fin = pos;
+	ROBIN_FIN_TRAMO(fin, mascara, tabla[fin].clave);
+	bitmap_marcar(ocupadas(tabla, tam), fin);
+	ROBIN_CORRER_ADELANTE(pos, fin, anterior, mascara){
+		tabla[fin] = tabla[anterior];
+		poner_control(bytes, tam, fin, bytes[anterior]);
+		size_t d_fin = robin_distancia(tabla[fin].hash, fin, mascara);
+		if(d_fin > max) max = d_fin;
+	}
+	tabla[pos] = campo;
+	poner_control(bytes, tam, pos, ETIQUETA(campo.hash));
+	return max;
+}
+
+/* Pide una tabla de tam campos vacios. Devuelve NULL si no hay memoria.
+ */
+static campo_hash_t* crear_tabla(const hash_t* hash, size_t tam){
+	size_t bytes_bitmap = sizeof(uint64_t) * bitmap_palabras(tam);
+	campo_hash_t* tabla = asignador_pedir(&hash->asignador, sizeof(campo_hash_t) * tam + bytes_bitmap + tam + GRUPO);
+	if(!tabla) return NULL;
+	for(size_t i = 0; i < tam; i++)
+		tabla[i].clave = NULL;
+	memset(tabla + tam, 0, bytes_bitmap);
+	memset(control(tabla, tam), VACIO, tam + GRUPO);
+	return tabla;
+}
+
+/* Devuelve el bitmap de la tabla, guardado a continuacion de sus tam
+ * campos. El bit de una posicion esta en 1 si y solo si esta ocupada.
+ */
+static uint64_t* ocupadas(campo_hash_t* tabla, size_t tam){
+	return (uint64_t*)(tabla + tam);
+}
+
+/* Devuelve los tam + GRUPO bytes de control de la tabla, guardados a
+ * continuacion del bitmap.
+ */
+static uint8_t* control(campo_hash_t* tabla, size_t tam){
+	return (uint8_t*)(ocupadas(tabla, tam) + bitmap_palabras(tam));
+}
+
+/* Devuelve donde guarda la clave el momento en que vence, justo antes de
+ * su primer byte.
+ * Pre: el hash tiene vencimientos y la clave se copio con copiar_clave.
+ */
+static uint64_t* vencimiento(char* clave){
+	return (uint64_t*)(void*)clave - 1;
+}
+
+/* Devuelve cuantos bytes van delante de cada copia de clave: en modo
+ * cache los que sumo a hash->bytes (ver bytes_clave), y con vencimientos
+ * el vencimiento, justo antes de la clave.
+ */
+static size_t prefijo_clave(const hash_t* hash){
+	return (hash->cache ? sizeof(uint64_t) : 0) + (hash->rueda ? sizeof(uint64_t) : 0);
+}
+
+/* Devuelve donde guarda la clave los bytes que sumo al modo cache al
+ * guardarla, para restar lo mismo al sacarla: el dato puede cambiar
+ * despues (con hash_obtener_ptr, o cambiar de tamaño) y bytes_dato dar
+ * otra cosa.
+ * Pre: el hash esta en modo cache y la clave se copio con copiar_clave.
+ */
+static uint64_t* bytes_clave(const hash_t* hash, char* clave){
+	return (uint64_t*)(void*)(clave - prefijo_clave(hash));
+}
+
+/* Copia la clave en memoria propia del hash (en la arena si la hay). Con
+ * claves prestadas devuelve la misma clave. La copia va despues de su
+ * prefijo (ver prefijo_clave), con el vencimiento sin vencer.
+ */
+static char* copiar_clave(const hash_t* hash, const void* clave, size_t largo){
+	if(hash->prestadas)
+		return (char*)clave;
+	size_t extra = prefijo_clave(hash);
+	char* copia = hash->arena ? arena_pedir(hash->arena, extra + largo + 1) : asignador_pedir(&hash->asignador, extra + largo + 1);
+	if(!copia) return NULL;
+	copia += extra;
+	if(hash->rueda)
+		*vencimiento(copia) = SIN_VENCIMIENTO;
+	memcpy(copia, clave, largo);
+	copia[largo] = '\0';
+	return copia;
+}
+
+/* Libera una clave copiada con copiar_clave. Las de la arena se liberan
+ * al destruir el hash, y las prestadas son del usuario.
+ */
+static void liberar_clave(const hash_t* hash, char* clave){
+	if(!hash->arena && !hash->prestadas)
+		asignador_liberar(&hash->asignador, clave - prefijo_clave(hash));
+}
+
+/* Devuelve true si el campo tiene vencimiento y ya vencio. Solo consulta
+ * el reloj para los campos con vencimiento.
+ */
+static bool vencido(const hash_t* hash, const campo_hash_t* campo){
+	if(!hash->rueda) return false;
+	uint64_t vence = *vencimiento(campo->clave);
+	return vence != SIN_VENCIMIENTO && vence <= hash->reloj();
+}
+
+/* Devuelve cuantas paginas de instantanea tiene una tabla de tam
+ * posiciones.
+ */
+static size_t cantidad_paginas(size_t tam){
+	return (tam + POSICIONES_PAGINA - 1) >> BITS_PAGINA;
+}
+
+/* Libera una pagina copiada con copiar_pagina, con el mismo asignador.
+ */
+static void liberar_pagina(const hash_t* hash, pagina_t* pagina, const asignador_t* asignador){
+	for(size_t i = 0; i < POSICIONES_PAGINA && !hash->prestadas; i++){
+		if(pagina->campos[i].clave)
+			asignador_liberar(asignador, pagina->campos[i].clave);
+	}
+	asignador_liberar(asignador, pagina);
+}
+
+/* Copia la pagina p de la tabla con claves pedidas al asignador, sin su
+ * vencimiento ni el bit USADO. No modifica el hash, asi que una
+ * instantanea la puede llamar desde otro hilo. Devuelve NULL si no hay
+ * memoria.
+ */
+static pagina_t* copiar_pagina(const hash_t* hash, size_t p, const asignador_t* asignador){
+	pagina_t* pagina = asignador_pedir(asignador, sizeof(pagina_t));
+	if(!pagina) return NULL;
+	pagina->refs = 0;
+	for(size_t i = 0; i < POSICIONES_PAGINA; i++)
+		pagina->campos[i].clave = NULL;
+	size_t base = p << BITS_PAGINA;
+	size_t n = hash->tam - base < POSICIONES_PAGINA ? hash->tam - base : POSICIONES_PAGINA;
+	for(size_t i = 0; i < n; i++){
+		const campo_hash_t* campo = &hash->tabla[base + i];
+		if(!campo->clave) continue;
+		char* clave = campo->clave;
+		if(!hash->prestadas){
+			clave = asignador_pedir(asignador, LARGO(campo) + 1);
+			if(!clave){
+				liberar_pagina(hash, pagina, asignador);
+				return NULL;
+			}
+			memcpy(clave, campo->clave, LARGO(campo) + 1);
+		}
+		pagina->campos[i] = *campo;
+		pagina->campos[i].clave = clave;
+		pagina->campos[i].largo = LARGO(campo);
+	}
+	return pagina;
+}
+
+/* Libera la instantanea, y las copias de paginas que ya no usa ninguna
+ * otra.
+ * Pre: el usuario la destruyo, o se esta destruyendo el hash.
+ */
+static void liberar_instantanea(hash_t* hash, hash_snapshot_t* instantanea){
+	size_t cant_paginas = cantidad_paginas(instantanea->tam);
+	for(size_t p = 0; p < cant_paginas; p++){
+		pagina_t* pagina = instantanea->paginas[p];
+		if(pagina && --pagina->refs == 0)
+			liberar_pagina(hash, pagina, &hash->asignador);
+	}
+	pthread_mutex_destroy(&instantanea->mutex);
+	asignador_liberar(&hash->asignador, instantanea->paginas);
+	asignador_liberar(&hash->asignador, instantanea);
+}
+
+/* Libera las instantaneas que el usuario ya destruyo. Como
+ * hash_snapshot_destruir puede correr en otro hilo, solo las marca, y la
+ * memoria (pedida al asignador del hash) se libera aca. Si no queda
+ * ninguna, ya no hay paginas que copiar.
+ */
+static void recolectar_instantaneas(hash_t* hash){
+	hash_snapshot_t** enlace = &hash->instantaneas;
+	while(*enlace){
+		hash_snapshot_t* instantanea = *enlace;
+		pthread_mutex_lock(&instantanea->mutex);
+		bool terminada = instantanea->terminada;
+		pthread_mutex_unlock(&instantanea->mutex);
+		if(terminada){
+			*enlace = instantanea->sig;
+			liberar_instantanea(hash, instantanea);
+		}else{
+			enlace = &instantanea->sig;
+		}
+	}
+	hash->hasta_recolectar = RECOLECTAR_CADA;
+	if(!hash->instantaneas && hash->preservadas){
+		asignador_liberar(&hash->asignador, hash->preservadas);
+		hash->preservadas = NULL;
+	}
+}
+
+/* Se llama antes de modificar la pagina p de la tabla: la copia para las
+ * instantaneas que todavia la leen de la tabla (las de generacion mayor a
+ * preservadas[p]), que desde entonces leen la copia. Cada RECOLECTAR_CADA
+ * llamadas, ademas, libera las instantaneas destruidas. Devuelve false si
+ * no hay memoria para la copia.
+ */
+static bool preservar_pagina(hash_t* hash, size_t p){
+	if(!hash->instantaneas) return true;
+	if(--hash->hasta_recolectar == 0 || (hash->preservadas && hash->preservadas[p] != hash->generacion))
+		recolectar_instantaneas(hash);
+	if(!hash->preservadas || hash->preservadas[p] == hash->generacion)
+		return true;
+	size_t refs = 0;
+	for(hash_snapshot_t* instantanea = hash->instantaneas; instantanea && instantanea->generacion > hash->preservadas[p]; instantanea = instantanea->sig)
+		refs++;
+	if(refs){
+		pagina_t* copia = copiar_pagina(hash, p, &hash->asignador);
+		if(!copia) return false;
+		copia->refs = refs;
+		for(hash_snapshot_t* instantanea = hash->instantaneas; instantanea && instantanea->generacion > hash->preservadas[p]; instantanea = instantanea->sig){
+			pthread_mutex_lock(&instantanea->mutex);
+			instantanea->paginas[p] = copia;
+			pthread_mutex_unlock(&instantanea->mutex);
+		}
+	}
+	hash->preservadas[p] = hash->generacion;
+	return true;
+}
+
+/* Preserva las paginas desde la de pos hasta la del primer campo vacio a
+ * partir de pos: las que puede tocar una insercion Robin Hood o un
+ * corrimiento hacia atras que empiezan en pos.
+ */
+static bool preservar_corrida(hash_t* hash, size_t pos){
+	if(!hash->preservadas)
+		return preservar_pagina(hash, pos >> BITS_PAGINA);
+	size_t i = pos;
+	while(true){
+		size_t p = i >> BITS_PAGINA;
+		if(!preservar_pagina(hash, p)) return false;
+		size_t fin = (p + 1) << BITS_PAGINA;
+		if(fin > hash->tam) fin = hash->tam;
+		while(i < fin && hash->tabla[i].clave)
+			i++;
+		if(i < fin) return true;
+		i = fin & (hash->tam - 1);
+	}
+}
+
+/* Preserva todas las paginas, antes de una modificacion que puede mover
+ * campos de cualquier posicion. Despues ninguna instantanea lee de la
+ * tabla. Devuelve false si no hay memoria; las paginas ya copiadas quedan.
+ */
+static bool preservar_todo(hash_t* hash){
+	size_t cant_paginas = cantidad_paginas(hash->tam);
+	for(size_t p = 0; p < cant_paginas && hash->preservadas; p++){
+		if(!preservar_pagina(hash, p))
+			return false;
+	}
+	if(hash->preservadas){
+		asignador_liberar(&hash->asignador, hash->preservadas);
+		hash->preservadas = NULL;
+	}
+	return true;
+}
+
+/* Busca la clave en la instantanea desde su posicion ideal hasta el
+ * primer campo vacio, de a una pagina: en su copia o en la tabla del
+ * hash, con el mutex tomado para que el hash no copie la pagina y la
+ * modifique mientras tanto. Si la encuentra guarda su dato en dato.
+ */
+static bool buscar_en_instantanea(const hash_snapshot_t* snapshot, const void* clave, size_t largo, void** dato){
+	hash_snapshot_t* instantanea = (hash_snapshot_t*)snapshot;
+	const hash_t* hash = instantanea->hash;
+	size_t h = (size_t)hash_calcular(hash, clave, largo);
+	size_t i = h & (instantanea->tam - 1);
+	while(true){
+		size_t p = i >> BITS_PAGINA;
+		size_t base = p << BITS_PAGINA;
+		size_t fin = base + POSICIONES_PAGINA < instantanea->tam ? base + POSICIONES_PAGINA : instantanea->tam;
+		bool terminada = false, encontrada = false;
+		pthread_mutex_lock(&instantanea->mutex);
+		const pagina_t* pagina = instantanea->paginas[p];
+		for(; i < fin && !terminada; i++){
+			const campo_hash_t* campo = pagina ? &pagina->campos[i - base] : &hash->tabla[i];
+			if(!campo->clave){
+				terminada = true;
+			}else if(campo->hash == h && LARGO(campo) == largo && memcmp(campo->clave, clave, largo) == 0){
+				*dato = campo->valor;
+				terminada = encontrada = true;
+			}
+		}
+		pthread_mutex_unlock(&instantanea->mutex);
+		if(terminada) return encontrada;
+		i = fin & (instantanea->tam - 1);
+	}
+}
+
+/* Devuelve el reloj monotono del sistema en nanosegundos.
+ */
+static uint64_t ahora_ns(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+/* Suma a las estadisticas una redimension que empezo en inicio (segun
+ * ahora_ns).
+ */
+static void registrar_redimension(hash_t* hash, uint64_t inicio){
+	uint64_t ns = ahora_ns() - inicio;
+	hash->redimensiones++;
+	hash->ns_redimension += ns;
+	if(ns > hash->max_ns_redimension)
+		hash->max_ns_redimension = ns;
+}
+
+/* Modifica el hash pasado por parametro redimensionandolo. Los campos se
+ * reubican con el hash guardado, sin recalcularlo ni copiar las claves.
+ * Devuelve false si no se pudo pedir memoria.
+ */
+static bool hash_redimensionar(hash_t* hash, size_t tam_nuevo){
+	uint64_t inicio = ahora_ns();
+	if(!preservar_todo(hash)) return false;
+	campo_hash_t* tabla_nueva = crear_tabla(hash, tam_nuevo);
+	if(!tabla_nueva) return false;
+	size_t max_distancia = 0;
+	uint64_t* bits = ocupadas(hash->tabla, hash->tam);
+	for(size_t i = bitmap_siguiente(bits, hash->tam, 0); i < hash->tam; i = bitmap_siguiente(bits, hash->tam, i + 1)){
+		size_t d = insertar_campo(tabla_nueva, tam_nuevo, hash->tabla[i]);
+		if(d > max_distancia) max_distancia = d;
+	}
+	asignador_liberar(&hash->asignador, hash->tabla);
+	hash->max_distancia = max_distancia;
+	hash->tabla = tabla_nueva;
+	hash->tam = tam_nuevo;
+	hash->manecilla = 0;
+	registrar_redimension(hash, inicio);
+	return true;
+}
+
+/* Saca el campo de la posicion i, corriendo hacia atras a los campos
+ * desplazados, sin liberar su clave ni su dato.
+ */
+static void quitar_posicion(hash_t* hash, size_t i){
+	// max_distancia sigue siendo una cota valida.
+	size_t mascara = hash->tam - 1;
+	uint8_t* bytes = control(hash->tabla, hash->tam);
+	ROBIN_CORRER_ATRAS(i, j, mascara, hash->tabla[j].clave && distancia(hash, j) > 0){
+		hash->tabla[i] = hash->tabla[j];
+		poner_control(bytes, hash->tam, i, bytes[j]);
+	}
+	hash->tabla[i].clave = NULL;
+	poner_control(bytes, hash->tam, i, VACIO);
+	bitmap_desmarcar(ocupadas(hash->tabla, hash->tam), i);
+	hash->cant--;
+}
+
+/* Devuelve cuantos bytes cuenta una clave de largo recibido con su dato
+ * para cache_bytes.
+ */
+static size_t bytes_entrada(const hash_t* hash, size_t largo, const void* dato){
+	size_t bytes = largo + 1;
+	if(hash->bytes_dato && dato)
+		bytes += hash->bytes_dato(dato);
+	return bytes;
+}
+
+/* Suma bytes a los del modo cache y los anota en la clave.
+ */
+static void sumar_bytes(hash_t* hash, char* clave, size_t bytes){
+	*bytes_clave(hash, clave) = bytes;
+	hash->bytes += bytes;
+}
+
+/* Resta de los bytes del modo cache lo que sumo la clave.
+ */
+static void restar_bytes(hash_t* hash, char* clave){
+	hash->bytes -= (size_t)*bytes_clave(hash, clave);
+}
+
+/* Devuelve true si guardar una clave nueva de bytes_nuevos bytes
+ * superaria los limites del modo cache.
+ */
+static bool excede_cache(const hash_t* hash, size_t bytes_nuevos){
+	return (hash->cache_entradas && hash->cant + 1 > hash->cache_entradas)
+		|| (hash->cache_bytes && hash->bytes + bytes_nuevos > hash->cache_bytes);
+}
+
+/* Desaloja un campo con el algoritmo CLOCK: la manecilla recorre los
+ * campos ocupados borrando el bit USADO de cada uno, hasta encontrar uno
+ * que no lo tenia, que es el que se desaloja destruyendo su dato. Da
+ * como mucho una vuelta entera a la tabla. Las claves nuevas entran sin
+ * el bit, asi que una clave que no se volvio a pedir sale antes que las
+ * que si. Nunca desaloja la clave excepto (puede ser NULL). Devuelve
+ * false si no hay memoria para preservar las paginas que toca.
+ * Pre: el hash esta en modo cache y tiene alguna clave que no es excepto.
+ */
+static bool desalojar(hash_t* hash, const char* excepto){
+	uint64_t* bits = ocupadas(hash->tabla, hash->tam);
+	size_t i = hash->manecilla;
+	while(true){
+		i = bitmap_siguiente(bits, hash->tam, i);
+		if(i == hash->tam){
+			i = 0;
+			continue;
+		}
+		campo_hash_t* campo = &hash->tabla[i];
+		if(!(campo->largo & USADO) && campo->clave != excepto)
+			break;
+		if(!preservar_pagina(hash, i >> BITS_PAGINA))
+			return false;
+		campo->largo &= ~USADO;
+		i++;
+	}
+	if(!preservar_corrida(hash, i))
+		return false;
+	campo_hash_t campo = hash->tabla[i];
+	quitar_posicion(hash, i);
+	hash->manecilla = i;
+	restar_bytes(hash, campo.clave);
+	hash->desalojos++;
+	if(hash->destruir)
+		hash->destruir(campo.valor);
+	liberar_clave(hash, campo.clave);
+	return true;
+}
+
+/* Saca el campo vencido de la posicion i y lo destruye junto con su dato.
+ */
+static void expirar_posicion(hash_t* hash, size_t i){
+	campo_hash_t campo = hash->tabla[i];
+	quitar_posicion(hash, i);
+	if(hash->cache)
+		restar_bytes(hash, campo.clave);
+	hash->vencidas++;
+	if(hash->destruir)
+		hash->destruir(campo.valor);
+	liberar_clave(hash, campo.clave);
+}
+
+/* Busca la clave como buscar_posicion, pero si vencio la borra (salvo que
+ * no haya memoria para preservar sus paginas) y devuelve false. Por eso
+ * modifica el hash aunque lo reciba como const.
+ */
+static bool buscar_vigente(const hash_t* hash, const void* clave, size_t largo, size_t h, size_t* pos){
+	if(!buscar_posicion(hash, clave, largo, h, pos))
+		return false;
+	if(!vencido(hash, &hash->tabla[*pos]))
+		return true;
+	if(preservar_corrida((hash_t*)hash, *pos))
+		expirar_posicion((hash_t*)hash, *pos);
+	return false;
+}
+
+/* Guarda en la clave el momento en que vence y lo registra en la rueda.
+ * Si no hay memoria para registrarlo, la deja sin vencimiento y devuelve
+ * false.
+ */
+static bool fijar_vencimiento(hash_t* hash, char* clave, size_t h, uint64_t vence){
+	*vencimiento(clave) = vence;
+	if(vence == SIN_VENCIMIENTO || rueda_agregar(hash->rueda, h, clave, vence))
+		return true;
+	*vencimiento(clave) = SIN_VENCIMIENTO;
+	return false;
+}
+
+/* Busca el campo de un registro de la rueda entre los que estan a menos
+ * de max_distancia de la posicion ideal de su hash. Compara la direccion
+ * de la clave sin leerla, porque puede haberse liberado. Devuelve false
+ * si el campo ya no esta o cambio de vencimiento.
+ */
+static bool buscar_registro(const hash_t* hash, const rueda_registro_t* registro, size_t* pos){
+	size_t mascara = hash->tam - 1;
+	size_t h = (size_t)registro->h;
+	for(size_t d = 0; d <= hash->max_distancia; d++){
+		size_t i = (h + d) & mascara;
+		const campo_hash_t* campo = &hash->tabla[i];
+		if(!campo->clave) return false;
+		if(campo->hash == h && (const void*)campo->clave == registro->id){
+			*pos = i;
+			return *vencimiento(campo->clave) == registro->vence;
+		}
+	}
+	return false;
+}
+
+/* Devuelve true si la clave ordenadas[k] vuelve a aparecer mas adelante
+ * en el lote. Las repeticiones tienen la misma posicion ideal, asi que
+ * solo se miran las claves siguientes con esa posicion.
+ */
+static bool repetida_despues(const rango_t* rango, const size_t* ordenadas, size_t k, size_t cant){
+	const particion_t* particion = rango->particion;
+	size_t mascara = rango->hash->tam - 1;
+	size_t i = ordenadas[k];
+	for(size_t j = k + 1; j < cant; j++){
+		size_t otra = ordenadas[j];
+		if((particion->hs[otra] & mascara) != (particion->hs[i] & mascara))
+			return false;
+		if(particion->hs[otra] == particion->hs[i] && particion->largos[otra] == particion->largos[i]
+			&& memcmp(rango->claves[otra], rango->claves[i], particion->largos[i]) == 0)
+			return true;
+	}
+	return false;
+}
+
+/* Ubica las claves de la particion del rango. Las ordena por posicion
+ * ideal contando (de forma estable, para que las repetidas sigan en el
+ * orden del lote) y deja cada una en la primera posicion libre desde su
+ * posicion ideal, que es donde la dejaria el sondeo Robin Hood. Solo toca
+ * las posiciones del rango, que empieza y termina en un borde de palabra
+ * del bitmap, por lo que corre en paralelo con los demas rangos.
+ */
+static void armar_rango(void* arg){
+	rango_t* rango = arg;
+	hash_t* hash = rango->hash;
+	const particion_t* particion = rango->particion;
+	size_t desde = particion->inicio[rango->p];
+	size_t cant = particion->inicio[rango->p + 1] - desde;
+	size_t largo_rango = (size_t)1 << particion->corrimiento;
+	size_t base = rango->p << particion->corrimiento;
+	size_t mascara = hash->tam - 1;
+	size_t* cuentas = calloc(largo_rango + 1, sizeof(size_t));
+	size_t* ordenadas = malloc(sizeof(size_t) * (cant ? cant : 1));
+	rango->desbordados = malloc(sizeof(campo_hash_t) * (cant ? cant : 1));
+	if(!cuentas || !ordenadas || !rango->desbordados){
+		rango->ok = false;
+		free(cuentas);
+		free(ordenadas);
+		return;
+	}
+	for(size_t k = desde; k < desde + cant; k++)
+		cuentas[(particion->hs[particion->orden[k]] & mascara) - base + 1]++;
+	for(size_t j = 1; j <= largo_rango; j++)
+		cuentas[j] += cuentas[j - 1];
+	for(size_t k = desde; k < desde + cant; k++){
+		size_t i = particion->orden[k];
+		ordenadas[cuentas[(particion->hs[i] & mascara) - base]++] = i;
+	}
+	free(cuentas);
+
+	uint8_t* bytes = control(hash->tabla, hash->tam);
+	size_t libre = base;
+	for(size_t k = 0; k < cant; k++){
+		size_t i = ordenadas[k];
+		if(repetida_despues(rango, ordenadas, k, cant)){
+			if(hash->destruir)
+				hash->destruir(rango->datos[i]);
+			continue;
+		}
+		campo_hash_t campo;
+		campo.clave = copiar_clave(hash, rango->claves[i], particion->largos[i]);
+		if(!campo.clave){
+			rango->ok = false;
+			break;
+		}
+		campo.valor = rango->datos[i];
+		campo.hash = (size_t)particion->hs[i];
+		campo.largo = particion->largos[i];
+		size_t ideal = campo.hash & mascara;
+		size_t pos = ideal > libre ? ideal : libre;
+		if(pos >= base + largo_rango){
+			rango->desbordados[rango->cant_desbordados++] = campo;
+			continue;
+		}
+		hash->tabla[pos] = campo;
+		poner_control(bytes, hash->tam, pos, ETIQUETA(campo.hash));
+		bitmap_marcar(ocupadas(hash->tabla, hash->tam), pos);
+		if(pos - ideal > rango->max_distancia)
+			rango->max_distancia = pos - ideal;
+		libre = pos + 1;
+		rango->cant++;
+	}
+	free(ordenadas);
+}
+
+/* Guarda la clave como hash_guardar_nh y devuelve la copia que quedo en
+ * el hash (la direccion que la identifica en la rueda), o NULL si no se
+ * pudo.
+ */
+static char* guardar_clave(hash_t *hash, const void *clave, size_t largo, uint64_t h, void *dato){
+	if(!clave) return NULL;
+	size_t bytes_nuevos = hash->cache ? bytes_entrada(hash, largo, dato) : 0;
+	if(hash->cache_bytes && bytes_nuevos > hash->cache_bytes)
+		return NULL;
+	size_t pos;
+	if(buscar_posicion(hash, clave, largo, (size_t)h, &pos)){
+		if(hash->cache_bytes){
+			// Se desaloja por la diferencia de bytes, nunca la clave que se
+			// reemplaza: si fuera la unica, los bytes nuevos ya entrarian.
+			// Cada desalojo puede correrla de posicion.
+			char* copia = hash->tabla[pos].clave;
+			size_t desalojos = hash->desalojos;
+			while(hash->bytes - (size_t)*bytes_clave(hash, copia) + bytes_nuevos > hash->cache_bytes){
+				if(!desalojar(hash, copia))
+					return NULL;
+			}
+			if(hash->desalojos != desalojos)
+				buscar_posicion(hash, clave, largo, (size_t)h, &pos);
+		}
+		if(!preservar_pagina(hash, pos >> BITS_PAGINA))
+			return NULL;
+		campo_hash_t* campo = &hash->tabla[pos];
+		if(hash->cache){
+			restar_bytes(hash, campo->clave);
+			sumar_bytes(hash, campo->clave, bytes_nuevos);
+			campo->largo |= USADO;
+		}
+		if(hash->destruir)
+			hash->destruir(campo->valor);
+		campo->valor = dato;
+		if(hash->rueda)
+			*vencimiento(campo->clave) = SIN_VENCIMIENTO;
+		return campo->clave;
+	}
+	if(hash->cache){
+		while(hash->cant > 0 && excede_cache(hash, bytes_nuevos)){
+			if(!desalojar(hash, NULL))
+				return NULL;
+		}
+	}
+	if((double)(hash->cant + 1) > hash->politica.carga_maxima * (double)hash->tam){
+		// Si no se pudo agrandar, se sigue mientras quede lugar libre.
+		if(!hash_redimensionar(hash, hash->tam * hash->politica.factor_crecimiento) && hash->cant + 1 >= hash->tam)
+			return NULL;
+	}
+	if(!preservar_corrida(hash, (size_t)h & (hash->tam - 1)))
+		return NULL;
+	campo_hash_t campo;
+	campo.clave = copiar_clave(hash, clave, largo);
+	if(!campo.clave) return NULL;
+	campo.valor = dato;
+	campo.hash = (size_t)h;
+	campo.largo = largo;
+	size_t d = insertar_campo(hash->tabla, hash->tam, campo);
+	if(d > hash->max_distancia)
+		hash->max_distancia = d;
+	hash->cant++;
+	if(hash->cache)
+		sumar_bytes(hash, campo.clave, bytes_nuevos);
+	return campo.clave;
+}
+
+/* Devuelve true si las claves de origen se pueden pasar a destino sin
+ * copiarlas: los dos las piden al mismo asignador, fuera de una arena,
+ * ninguno esta en modo cache ni tiene vencimientos, y las claves son
+ * prestadas en los dos o en ninguno.
+ */
+static bool campos_compatibles(const hash_t* destino, const hash_t* origen){
+	return !destino->arena && !origen->arena && !destino->cache && !origen->cache
+		&& !destino->rueda && !origen->rueda
+		&& destino->prestadas == origen->prestadas
+		&& destino->asignador.pedir == origen->asignador.pedir
+		&& destino->asignador.liberar == origen->asignador.liberar
+		&& destino->asignador.ctx == origen->asignador.ctx;
+}
+
+/* Avanza la posicion del iterador hasta el proximo campo ocupado, o hasta
+ * el final de la tabla, salteando de a 64 posiciones vacias con el bitmap.
+ */
+static void avanzar_sobre_tabla(hash_iter_t* iter){
+	const hash_t* hash = iter->hash;
+	iter->pos = bitmap_siguiente(ocupadas(hash->tabla, hash->tam), hash->tam, iter->pos);
+}
+
+/* Calcula el largo y el hash de las cant claves de un lote, y pide al
+ * procesador el campo de la posicion ideal de cada una. En una segunda
+ * pasada, cuando esos campos ya suelen estar en cache, pide sus claves,
+ * de modo que las esperas se superponen en lugar de sumarse.
+ * Pre: cant es como mucho LOTE
+ */
+static void preparar_lote(const hash_t* hash, const char* const claves[], size_t cant, size_t largos[], uint64_t hs[]){
+	for(size_t i = 0; i < cant; i++){
+		largos[i] = strlen(claves[i]);
+		hs[i] = hash->funcion(claves[i], largos[i], hash->semilla);
+		PRECARGAR(&hash->tabla[hs[i] & (hash->tam - 1)]);
+	}
+	for(size_t i = 0; i < cant; i++)
+		PRECARGAR(hash->tabla[hs[i] & (hash->tam - 1)].clave);
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DEL HASH
+ * *****************************************************************/
+
+/* Crea el hash
+ */
+hash_t* hash_crear(hash_destruir_dato_t destruir_dato){
+	return hash_crear_con_opciones(destruir_dato, NULL);
+}
+
+/* Crea el hash con las opciones recibidas. Si opciones es NULL usa las
+ * predeterminadas. Devuelve NULL si la politica es invalida.
+ */
+hash_t* hash_crear_con_opciones(hash_destruir_dato_t destruir_dato, const hash_opciones_t* opciones){
+	hash_politica_t politica = {0};
+	if(opciones)
+		politica = opciones->politica;
+	if(!normalizar_politica(&politica)) return NULL;
+
+	asignador_t asignador = {0};
+	if(opciones)
+		asignador = opciones->asignador;
+	hash_t* hash = asignador_pedir(&asignador, sizeof(hash_t));
+	if(!hash) return NULL;
+	hash->asignador = asignador;
+	hash->prestadas = opciones && opciones->claves_prestadas;
+	hash->cache_entradas = opciones ? opciones->cache_entradas : 0;
+	hash->cache_bytes = opciones ? opciones->cache_bytes : 0;
+	hash->bytes_dato = opciones ? opciones->bytes_dato : NULL;
+	hash->cache = hash->cache_entradas || hash->cache_bytes;
+	hash->bytes = 0;
+	hash->manecilla = 0;
+	// En modo cache lo que suma cada clave va delante de su copia.
+	if(hash->cache && hash->prestadas){
+		asignador_liberar(&asignador, hash);
+		return NULL;
+	}
+	hash->reloj = opciones && opciones->reloj ? opciones->reloj : rueda_reloj;
+	hash->rueda = NULL;
+	if(opciones && opciones->vencimientos){
+		// El vencimiento va delante de la copia de cada clave.
+		if(hash->prestadas){
+			asignador_liberar(&asignador, hash);
+			return NULL;
+		}
+		hash->rueda = rueda_crear(&asignador, hash->reloj());
+		if(!hash->rueda){
+			asignador_liberar(&asignador, hash);
+			return NULL;
+		}
+	}
+	hash->arena = NULL;
+	if(opciones && opciones->arena){
+		hash->arena = arena_crear(&asignador);
+		if(!hash->arena){
+			if(hash->rueda)
+				rueda_destruir(hash->rueda);
+			asignador_liberar(&asignador, hash);
+			return NULL;
+		}
+	}
+	hash->tabla = crear_tabla(hash, politica.tam_inicial);
+	if(!hash->tabla){
+		if(hash->arena)
+			arena_destruir(hash->arena);
+		if(hash->rueda)
+			rueda_destruir(hash->rueda);
+		asignador_liberar(&asignador, hash);
+		return NULL;
+	}
+	hash->politica = politica;
+	hash->tam = politica.tam_inicial;
+	hash->cant = 0;
+	hash->max_distancia = 0;
+	hash->redimensiones = 0;
+	hash->ns_redimension = 0;
+	hash->max_ns_redimension = 0;
+	hash->busquedas = 0;
+	hash->aciertos = 0;
+	hash->desalojos = 0;
+	hash->vencidas = 0;
+	hash->instantaneas = NULL;
+	hash->generacion = 0;
+	hash->preservadas = NULL;
+	hash->hasta_recolectar = RECOLECTAR_CADA;
+	hash->destruir = destruir_dato;
+	hash->funcion = HASH_FUNCION_PREDETERMINADA;
+	hash->semilla = 0;
+	if(opciones){
+		if(opciones->funcion)
+			hash->funcion = opciones->funcion;
+		hash->semilla = opciones->semilla;
+	}
+	if(!hash->semilla)
+		hash->semilla = hash_semilla_aleatoria(hash);
+	return hash;
+}
+
+/* Crea el hash con lugar para capacidad elementos sin redimensionar.
+ */
+hash_t* hash_crear_con_capacidad(hash_destruir_dato_t destruir_dato, size_t capacidad){
+	hash_opciones_t opciones = {0};
+	opciones.politica.carga_maxima = UMBRAL_MAX;
+	opciones.politica.tam_inicial = tam_para(&opciones.politica, capacidad);
+	return hash_crear_con_opciones(destruir_dato, &opciones);
+}
+
+/* Guarda un elemento en el hash, si la clave ya se encuentra en la
+ * estructura, la reemplaza. De no poder guardarlo devuelve false.
+ * Pre: La estructura hash fue inicializada
+ * Post: Se almacenó el par (clave, dato)
+ */
+bool hash_guardar(hash_t *hash, const char *clave, void *dato){
+	if(!clave) return false;
+	return hash_guardar_n(hash, clave, strlen(clave), dato);
+}
+
+/* Borra un elemento del hash y devuelve el dato asociado.  Devuelve
+ * NULL si el dato no estaba.
+ * Pre: La estructura hash fue inicializada
+ * Post: El elemento fue borrado de la estructura y se lo devuelve
+ * en el caso de que estuviera guardado. Queda en manos del usuario
+ * la memoria de ese dato guardado.
+ */
+void* hash_borrar(hash_t *hash, const char *clave){
+	return hash_borrar_n(hash, clave, strlen(clave));
+}
+
+/* Obtiene el valor de un elemento del hash, si la clave no se encuentra
+ * devuelve NULL.
+ * Pre: La estructura hash fue inicializada
+ */
+void* hash_obtener(const hash_t *hash, const char *clave){
+	return hash_obtener_n(hash, clave, strlen(clave));
+}
+
+/* Obtiene la direccion donde se guarda el valor de la clave, o NULL si
+ * la clave no se encuentra.
+ * Pre: La estructura hash fue inicializada
+ */
+void** hash_obtener_ptr(hash_t *hash, const char *clave){
+	return hash_obtener_ptr_n(hash, clave, strlen(clave));
+}
+
+/* Determina si clave pertenece o no al hash.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_pertenece(const hash_t* hash, const char* clave){
+	return hash_pertenece_n(hash, clave, strlen(clave));
+}
+
+/* Claves binarias */
+
+/* Devuelve el valor de la funcion de hashing del hash para la clave.
+ */
+uint64_t hash_calcular(const hash_t *hash, const void *clave, size_t largo){
+	return hash->funcion(clave, largo, hash->semilla);
+}
+
+bool hash_guardar_n(hash_t *hash, const void *clave, size_t largo, void *dato){
+	if(!clave) return false;
+	return hash_guardar_nh(hash, clave, largo, hash_calcular(hash, clave, largo), dato);
+}
+
+void* hash_borrar_n(hash_t *hash, const void *clave, size_t largo){
+	return hash_borrar_nh(hash, clave, largo, hash_calcular(hash, clave, largo));
+}
+
+void* hash_obtener_n(const hash_t *hash, const void *clave, size_t largo){
+	return hash_obtener_nh(hash, clave, largo, hash_calcular(hash, clave, largo));
+}
+
+void** hash_obtener_ptr_n(hash_t *hash, const void *clave, size_t largo){
+	return hash_obtener_ptr_nh(hash, clave, largo, hash_calcular(hash, clave, largo));
+}
+
+bool hash_pertenece_n(const hash_t *hash, const void *clave, size_t largo){
+	return hash_pertenece_nh(hash, clave, largo, hash_calcular(hash, clave, largo));
+}
+
+/* Guarda la clave de largo y hash recibidos, sin vencimiento. Es la que
+ * hace el trabajo de hash_guardar y hash_guardar_n.
+ * Pre: La estructura hash fue inicializada, h es hash_calcular de la clave
+ */
+bool hash_guardar_nh(hash_t *hash, const void *clave, size_t largo, uint64_t h, void *dato){
+	return guardar_clave(hash, clave, largo, h, dato) != NULL;
+}
+
+/* Borra la clave de largo y hash recibidos y devuelve su dato.
+ * Pre: La estructura hash fue inicializada, h es hash_calcular de la clave
+ */
+void* hash_borrar_nh(hash_t *hash, const void *clave, size_t largo, uint64_t h){
+	size_t i;
+	if(hash->cant == 0 || !buscar_vigente(hash, clave, largo, (size_t)h, &i) || !preservar_corrida(hash, i))
+		return NULL;
+	void* dato = hash->tabla[i].valor;
+	if(hash->cache)
+		restar_bytes(hash, hash->tabla[i].clave);
+	liberar_clave(hash, hash->tabla[i].clave);
+	// Corrimiento hacia atras: los campos desplazados vuelven un lugar.
+	quitar_posicion(hash, i);
+
+	size_t tam_nuevo = tam_achicado(hash);
+	if(tam_nuevo != hash->tam)
+		hash_redimensionar(hash, tam_nuevo);
+	return dato;
+}
+
+/* En modo cache marca la clave como usada, y con vencimientos borra la
+ * clave si vencio, por lo que modifica el hash aunque lo reciba como
+ * const.
+ */
+void* hash_obtener_nh(const hash_t *hash, const void *clave, size_t largo, uint64_t h){
+	size_t pos;
+	bool esta = buscar_vigente(hash, clave, largo, (size_t)h, &pos);
+	CONTAR_BUSQUEDA(hash, esta);
+	if(!esta)
+		return NULL;
+	if(hash->cache && !(hash->tabla[pos].largo & USADO) && preservar_pagina((hash_t*)hash, pos >> BITS_PAGINA))
+		hash->tabla[pos].largo |= USADO;
+	return hash->tabla[pos].valor;
+}
+
+/* El dato se puede modificar a traves del puntero, asi que antes se
+ * preserva su pagina.
+ */
+void** hash_obtener_ptr_nh(hash_t *hash, const void *clave, size_t largo, uint64_t h){
+	size_t pos;
+	bool esta = buscar_vigente(hash, clave, largo, (size_t)h, &pos);
+	CONTAR_BUSQUEDA(hash, esta);
+	if(!esta || !preservar_pagina(hash, pos >> BITS_PAGINA))
+		return NULL;
+	if(hash->cache)
+		hash->tabla[pos].largo |= USADO;
+	return &hash->tabla[pos].valor;
+}
+
+bool hash_pertenece_nh(const hash_t *hash, const void *clave, size_t largo, uint64_t h){
+	size_t pos;
+	bool esta = buscar_vigente(hash, clave, largo, (size_t)h, &pos);
+	CONTAR_BUSQUEDA(hash, esta);
+	return esta;
+}
+
+/* Primitivas por lotes */
+
+void hash_obtener_lote(const hash_t *hash, const char *const claves[], size_t cant, void *datos[]){
+	size_t largos[LOTE];
+	uint64_t hs[LOTE];
+	for(size_t base = 0; base < cant; base += LOTE){
+		size_t n = cant - base < LOTE ? cant - base : LOTE;
+		preparar_lote(hash, claves + base, n, largos, hs);
+		for(size_t i = 0; i < n; i++)
+			datos[base + i] = hash_obtener_nh(hash, claves[base + i], largos[i], hs[i]);
+	}
+}
+
+/* Agranda la tabla de antemano para el peor caso (todas las claves
+ * nuevas); si no hay memoria para eso, cada guardar agranda por su
+ * cuenta.
+ */
+bool hash_guardar_lote(hash_t *hash, const char *const claves[], void *const datos[], size_t cant){
+	hash_reservar(hash, hash->cant + cant);
+	size_t largos[LOTE];
+	uint64_t hs[LOTE];
+	for(size_t base = 0; base < cant; base += LOTE){
+		size_t n = cant - base < LOTE ? cant - base : LOTE;
+		preparar_lote(hash, claves + base, n, largos, hs);
+		for(size_t i = 0; i < n; i++){
+			if(!hash_guardar_nh(hash, claves[base + i], largos[i], hs[i], datos[base + i]))
+				return false;
+		}
+	}
+	return true;
+}
+
+void hash_borrar_lote(hash_t *hash, const char *const claves[], size_t cant, void *datos[]){
+	size_t largos[LOTE];
+	uint64_t hs[LOTE];
+	for(size_t base = 0; base < cant; base += LOTE){
+		size_t n = cant - base < LOTE ? cant - base : LOTE;
+		preparar_lote(hash, claves + base, n, largos, hs);
+		for(size_t i = 0; i < n; i++)
+			datos[base + i] = hash_borrar_nh(hash, claves[base + i], largos[i], hs[i]);
+	}
+}
+
+/* Construccion paralela y fusion */
+
+/* Crea el hash y ubica las claves del lote en paralelo: particion_crear
+ * calcula los hash y reparte las claves por rango de la tabla, cada hilo
+ * arma su rango con armar_rango, y al final se insertan una por una las
+ * claves que desbordaron su rango.
+ */
+hash_t* hash_construir_paralelo(const char* const claves[], void* const datos[], size_t cant, size_t hilos, hash_destruir_dato_t destruir_dato, const hash_opciones_t* opciones){
+	hash_t* hash = hash_crear_con_opciones(destruir_dato, opciones);
+	if(!hash) return NULL;
+	bool ok;
+	if(hash->cache){
+		ok = hash_guardar_lote(hash, claves, datos, cant);
+	}else{
+		ok = hash_reservar(hash, cant);
+		if(hilos == 0 || hash->arena || hash->asignador.pedir)
+			hilos = 1;
+		size_t particiones = particion_cantidad(hilos, hash->tam, BITS_PALABRA);
+		particion_t particion;
+		rango_t* rangos = NULL;
+		if(ok)
+			ok = particion_crear(&particion, claves, cant, hash->funcion, hash->semilla, hash->tam, particiones, hilos);
+		if(ok){
+			rangos = calloc(particiones, sizeof(rango_t));
+			ok = rangos != NULL;
+			if(!ok)
+				particion_destruir(&particion);
+		}
+		if(ok){
+			for(size_t p = 0; p < particiones; p++){
+				rangos[p].hash = hash;
+				rangos[p].particion = &particion;
+				rangos[p].claves = claves;
+				rangos[p].datos = datos;
+				rangos[p].p = p;
+				rangos[p].ok = true;
+			}
+			particion_ejecutar(armar_rango, rangos, sizeof(rango_t), particiones, hilos);
+			for(size_t p = 0; p < particiones; p++){
+				hash->cant += rangos[p].cant;
+				if(rangos[p].max_distancia > hash->max_distancia)
+					hash->max_distancia = rangos[p].max_distancia;
+				ok = ok && rangos[p].ok;
+			}
+			for(size_t p = 0; p < particiones; p++){
+				for(size_t k = 0; k < rangos[p].cant_desbordados; k++){
+					campo_hash_t campo = rangos[p].desbordados[k];
+					if(!ok){
+						liberar_clave(hash, campo.clave);
+						continue;
+					}
+					size_t d = insertar_campo(hash->tabla, hash->tam, campo);
+					if(d > hash->max_distancia)
+						hash->max_distancia = d;
+					hash->cant++;
+				}
+				free(rangos[p].desbordados);
+			}
+			free(rangos);
+			particion_destruir(&particion);
+		}
+	}
+	if(!ok){
+		hash->destruir = NULL;
+		hash_destruir(hash);
+		return NULL;
+	}
+	return hash;
+}
+
+/* Pasa las claves de origen a destino. Al sacar una clave de origen el
+ * corrimiento hacia atras trae la siguiente a la misma posicion, por lo
+ * que se la vuelve a mirar antes de avanzar.
+ */
+bool hash_fusionar(hash_t* destino, hash_t* origen, hash_fusion_t politica){
+	bool mover = campos_compatibles(destino, origen);
+	bool mismo_hash = destino->funcion == origen->funcion && destino->semilla == origen->semilla;
+	if(!preservar_todo(destino) || !preservar_todo(origen))
+		return false;
+	if(!hash_reservar(destino, destino->cant + origen->cant))
+		return false;
+	uint64_t* bits = ocupadas(origen->tabla, origen->tam);
+	size_t i = bitmap_siguiente(bits, origen->tam, 0);
+	bool ok = true;
+	while(i < origen->tam){
+		campo_hash_t* campo = &origen->tabla[i];
+		size_t largo = LARGO(campo);
+		size_t h = mismo_hash ? campo->hash : (size_t)hash_calcular(destino, campo->clave, largo);
+		size_t pos;
+		bool esta = buscar_posicion(destino, campo->clave, largo, h, &pos);
+		if(esta && politica == HASH_FUSION_UNION){
+			i = bitmap_siguiente(bits, origen->tam, i + 1);
+			continue;
+		}
+		if(!mover){
+			char* copia = guardar_clave(destino, campo->clave, largo, h, campo->valor);
+			if(!copia)
+				return false;
+			// Sin memoria para el vencimiento la clave pasa igual, sin
+			// vencimiento: el dato ya es de destino.
+			if(origen->rueda && destino->rueda)
+				ok = fijar_vencimiento(destino, copia, h, *vencimiento(campo->clave));
+			if(origen->cache)
+				restar_bytes(origen, campo->clave);
+			liberar_clave(origen, campo->clave);
+		}else if(esta){
+			if(destino->destruir)
+				destino->destruir(destino->tabla[pos].valor);
+			destino->tabla[pos].valor = campo->valor;
+			liberar_clave(origen, campo->clave);
+		}else{
+			campo_hash_t nuevo = *campo;
+			nuevo.hash = h;
+			size_t d = insertar_campo(destino->tabla, destino->tam, nuevo);
+			if(d > destino->max_distancia)
+				destino->max_distancia = d;
+			destino->cant++;
+		}
+		quitar_posicion(origen, i);
+		if(!ok)
+			return false;
+		i = bitmap_siguiente(bits, origen->tam, i);
+	}
+	return true;
+}
+
+/* Vencimientos */
+
+bool hash_guardar_ttl(hash_t *hash, const char *clave, void *dato, uint64_t ttl){
+	if(!clave) return false;
+	return hash_guardar_ttl_n(hash, clave, strlen(clave), dato, ttl);
+}
+
+/* El vencimiento se satura: un ttl que no entra en el reloj no vence.
+ */
+bool hash_guardar_ttl_n(hash_t *hash, const void *clave, size_t largo, void *dato, uint64_t ttl){
+	if(!hash->rueda) return false;
+	uint64_t h = hash_calcular(hash, clave, largo);
+	char* copia = guardar_clave(hash, clave, largo, h, dato);
+	if(!copia) return false;
+	uint64_t ahora = hash->reloj();
+	uint64_t vence = ttl < SIN_VENCIMIENTO - ahora ? ahora + ttl : SIN_VENCIMIENTO;
+	return fijar_vencimiento(hash, copia, (size_t)h, vence);
+}
+
+/* Saca de la rueda los vencimientos que ya pasaron y borra los campos que
+ * todavia coinciden con el suyo. Al final achica la tabla si corresponde,
+ * una sola vez.
+ */
+size_t hash_expirar(hash_t *hash, size_t presupuesto){
+	if(!hash->rueda) return 0;
+	uint64_t ahora = hash->reloj();
+	size_t vencidas = 0;
+	rueda_registro_t registro;
+	for(; presupuesto > 0 && rueda_sacar(hash->rueda, ahora, &registro); presupuesto--){
+		size_t pos;
+		if(!buscar_registro(hash, &registro, &pos) || !preservar_corrida(hash, pos)) continue;
+		expirar_posicion(hash, pos);
+		vencidas++;
+	}
+	if(vencidas){
+		size_t tam_nuevo = tam_achicado(hash);
+		if(tam_nuevo != hash->tam)
+			hash_redimensionar(hash, tam_nuevo);
+	}
+	return vencidas;
+}
+
+/* Devuelve la cantidad de elementos del hash.
+ * Pre: La estructura hash fue inicializada
+ */
+size_t hash_cantidad(const hash_t* hash){
+	return hash->cant;
+}
+
+/* Agranda la tabla para que entren capacidad elementos sin volver a
+ * redimensionar.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_reservar(hash_t *hash, size_t capacidad){
+	size_t tam_nuevo = tam_para(&hash->politica, capacidad);
+	if(tam_nuevo <= hash->tam) return true;
+	return hash_redimensionar(hash, tam_nuevo);
+}
+
+/* Achica la tabla al menor tamaño en el que entran los elementos actuales.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_compactar(hash_t *hash){
+	size_t tam_nuevo = tam_para(&hash->politica, hash->cant);
+	if(tam_nuevo >= hash->tam) return true;
+	return hash_redimensionar(hash, tam_nuevo);
+}
+
+/* Completa las estadisticas recorriendo los campos ocupados una vez. El
+ * histograma es de distancias a la posicion ideal; los campos estan en
+ * la tabla, asi que bytes_campos queda en 0.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_estadisticas(const hash_t *hash, hash_estadisticas_t *estadisticas){
+	memset(estadisticas, 0, sizeof(*estadisticas));
+	estadisticas->cantidad = hash->cant;
+	estadisticas->tam = hash->tam;
+	estadisticas->carga = (double)hash->cant / (double)hash->tam;
+	estadisticas->bytes_tabla = sizeof(campo_hash_t) * hash->tam + sizeof(uint64_t) * bitmap_palabras(hash->tam) + hash->tam + GRUPO;
+	uint64_t* bits = ocupadas(hash->tabla, hash->tam);
+	for(size_t i = bitmap_siguiente(bits, hash->tam, 0); i < hash->tam; i = bitmap_siguiente(bits, hash->tam, i + 1)){
+		size_t d = distancia(hash, i);
+		estadisticas->histograma[d < HASH_LARGOS ? d : HASH_LARGOS - 1]++;
+		if(d + 1 > estadisticas->max_sondeo)
+			estadisticas->max_sondeo = d + 1;
+		if(!hash->prestadas)
+			estadisticas->bytes_claves += LARGO(&hash->tabla[i]) + 1 + (hash->rueda ? sizeof(uint64_t) : 0);
+	}
+	estadisticas->redimensiones = hash->redimensiones;
+	estadisticas->ns_redimension = hash->ns_redimension;
+	estadisticas->max_ns_redimension = hash->max_ns_redimension;
+	estadisticas->busquedas = hash->busquedas;
+	estadisticas->aciertos = hash->aciertos;
+	estadisticas->fallos = hash->busquedas - hash->aciertos;
+	estadisticas->desalojos = hash->desalojos;
+	estadisticas->bytes_cache = hash->bytes;
+	estadisticas->vencidas = hash->vencidas;
+}
+
+/* Destruye la estructura liberando la memoria pedida y llamando a la función
+ * destruir para cada par (clave, dato).
+ * Pre: La estructura hash fue inicializada
+ * Post: La estructura hash fue destruida
+ */
+void hash_destruir(hash_t *hash){
+	while(hash->instantaneas){
+		hash_snapshot_t* instantanea = hash->instantaneas;
+		hash->instantaneas = instantanea->sig;
+		liberar_instantanea(hash, instantanea);
+	}
+	if(hash->preservadas)
+		asignador_liberar(&hash->asignador, hash->preservadas);
+	uint64_t* bits = ocupadas(hash->tabla, hash->tam);
+	for(size_t i = bitmap_siguiente(bits, hash->tam, 0); i < hash->tam && (hash->destruir || (!hash->arena && !hash->prestadas)); i = bitmap_siguiente(bits, hash->tam, i + 1)){
+		if(hash->destruir)
+			hash->destruir(hash->tabla[i].valor);
+		liberar_clave(hash, hash->tabla[i].clave);
+	}
+	asignador_liberar(&hash->asignador, hash->tabla);
+	if(hash->arena)
+		arena_destruir(hash->arena);
+	if(hash->rueda)
+		rueda_destruir(hash->rueda);
+	asignador_t asignador = hash->asignador;
+	asignador_liberar(&asignador, hash);
+}
+
+/* Instantaneas */
+
+/* Crea la instantanea con todas sus paginas leyendose de la tabla. Si no
+ * habia otras que leyeran de la tabla, preservadas empieza con la
+ * generacion anterior: las instantaneas viejas ya tienen todo copiado.
+ */
+hash_snapshot_t* hash_snapshot(hash_t *hash){
+	recolectar_instantaneas(hash);
+	size_t cant_paginas = cantidad_paginas(hash->tam);
+	hash_snapshot_t* instantanea = asignador_pedir(&hash->asignador, sizeof(hash_snapshot_t));
+	pagina_t** paginas = asignador_pedir(&hash->asignador, sizeof(pagina_t*) * cant_paginas);
+	uint64_t* preservadas = hash->preservadas;
+	if(!preservadas)
+		preservadas = asignador_pedir(&hash->asignador, sizeof(uint64_t) * cant_paginas);
+	if(!instantanea || !paginas || !preservadas || pthread_mutex_init(&instantanea->mutex, NULL) != 0){
+		if(instantanea)
+			asignador_liberar(&hash->asignador, instantanea);
+		if(paginas)
+			asignador_liberar(&hash->asignador, paginas);
+		if(preservadas && preservadas != hash->preservadas)
+			asignador_liberar(&hash->asignador, preservadas);
+		return NULL;
+	}
+	if(!hash->preservadas){
+		for(size_t p = 0; p < cant_paginas; p++)
+			preservadas[p] = hash->generacion;
+		hash->preservadas = preservadas;
+	}
+	for(size_t p = 0; p < cant_paginas; p++)
+		paginas[p] = NULL;
+	instantanea->hash = hash;
+	instantanea->paginas = paginas;
+	instantanea->tam = hash->tam;
+	instantanea->cant = hash->cant;
+	instantanea->generacion = ++hash->generacion;
+	instantanea->terminada = false;
+	instantanea->sig = hash->instantaneas;
+	hash->instantaneas = instantanea;
+	return instantanea;
+}
+
+void* hash_snapshot_obtener(const hash_snapshot_t *snapshot, const char *clave){
+	return hash_snapshot_obtener_n(snapshot, clave, strlen(clave));
+}
+
+void* hash_snapshot_obtener_n(const hash_snapshot_t *snapshot, const void *clave, size_t largo){
+	void* dato = NULL;
+	buscar_en_instantanea(snapshot, clave, largo, &dato);
+	return dato;
+}
+
+bool hash_snapshot_pertenece(const hash_snapshot_t *snapshot, const char *clave){
+	return hash_snapshot_pertenece_n(snapshot, clave, strlen(clave));
+}
+
+bool hash_snapshot_pertenece_n(const hash_snapshot_t *snapshot, const void *clave, size_t largo){
+	void* dato;
+	return buscar_en_instantanea(snapshot, clave, largo, &dato);
+}
+
+size_t hash_snapshot_cantidad(const hash_snapshot_t *snapshot){
+	return snapshot->cant;
+}
+
+/* Las paginas que se leen de la tabla se copian con malloc, y no con el
+ * asignador del hash, que no tiene por que poder usarse desde otro hilo.
+ */
+bool hash_snapshot_iterar(const hash_snapshot_t *snapshot, bool visitar(const char *clave, void *dato, void *extra), void *extra){
+	hash_snapshot_t* instantanea = (hash_snapshot_t*)snapshot;
+	asignador_t propio = {0};
+	size_t cant_paginas = cantidad_paginas(instantanea->tam);
+	for(size_t p = 0; p < cant_paginas; p++){
+		pthread_mutex_lock(&instantanea->mutex);
+		pagina_t* pagina = instantanea->paginas[p];
+		pagina_t* copia = pagina ? NULL : copiar_pagina(instantanea->hash, p, &propio);
+		pthread_mutex_unlock(&instantanea->mutex);
+		if(!pagina && !copia) return false;
+		const pagina_t* actual = pagina ? pagina : copia;
+		bool seguir = true;
+		for(size_t i = 0; i < POSICIONES_PAGINA && seguir; i++){
+			if(actual->campos[i].clave)
+				seguir = visitar(actual->campos[i].clave, actual->campos[i].valor, extra);
+		}
+		if(copia)
+			liberar_pagina(instantanea->hash, copia, &propio);
+		if(!seguir) break;
+	}
+	return true;
+}
+
+/* Solo la marca: la libera recolectar_instantaneas, en el hilo que
+ * modifica el hash.
+ */
+void hash_snapshot_destruir(hash_snapshot_t *snapshot){
+	pthread_mutex_lock(&snapshot->mutex);
+	snapshot->terminada = true;
+	pthread_mutex_unlock(&snapshot->mutex);
+}
+
+/* Iterador del hash */
+
+/* Recorre todos los campos del hash aplicando visitar a cada clave y su
+ * dato, hasta que visitar devuelva false. No pide memoria.
+ * Pre: el hash fue creado.
+ */
+void hash_iterar(const hash_t *hash, bool visitar(const char *clave, void *dato, void *extra), void *extra){
+	uint64_t* bits = ocupadas(hash->tabla, hash->tam);
+	for(size_t i = bitmap_siguiente(bits, hash->tam, 0); i < hash->tam; i = bitmap_siguiente(bits, hash->tam, i + 1)){
+		if(!visitar(hash->tabla[i].clave, hash->tabla[i].valor, extra))
+			return;
+	}
+}
+
+/* Inicializa un iterador guardado por el usuario en el primer campo
+ * ocupado de la tabla.
+ * Pre: el hash fue creado.
+ */
+void hash_iter_inicializar(hash_iter_t *iter, const hash_t *hash){
+	iter->hash = hash;
+	iter->actual = NULL;
+	iter->pos = 0;
+	avanzar_sobre_tabla(iter);
+}
+
+/* Crea iterador. Lo ubica en el primer campo ocupado de la tabla.
+ * Pre: el hash fue creado.
+ */
+hash_iter_t* hash_iter_crear(const hash_t *hash){
+	hash_iter_t* iter = malloc(sizeof(hash_iter_t));
+	if(!iter) return NULL;
+	hash_iter_inicializar(iter, hash);
+	return iter;
+}
+
+/* Avanza iterador sobre un mismo hash.
+ * Pre: el iterador fue creado.
+ */
+bool hash_iter_avanzar(hash_iter_t *iter){
+	if(hash_iter_al_final(iter)) return false;
+	iter->pos++;
+	avanzar_sobre_tabla(iter);
+	return !hash_iter_al_final(iter);
+}
+
+/* Devuelve clave actual, esa clave no se puede modificar ni liberar.
+ */
+const char* hash_iter_ver_actual(const hash_iter_t *iter){
+	if(!iter || hash_iter_al_final(iter))
+		return NULL;
+	return iter->hash->tabla[iter->pos].clave;
+}
+
+/* Devuelve la clave actual y guarda su largo en largo.
+ */
+const char* hash_iter_ver_actual_n(const hash_iter_t *iter, size_t *largo){
+	if(!iter || hash_iter_al_final(iter))
+		return NULL;
+	*largo = LARGO(&iter->hash->tabla[iter->pos]);
+	return iter->hash->tabla[iter->pos].clave;
+}
+
+/* Devuelve el dato del campo actual, sin buscar su clave.
+ */
+void* hash_iter_ver_dato(const hash_iter_t *iter){
+	if(!iter || hash_iter_al_final(iter))
+		return NULL;
+	return iter->hash->tabla[iter->pos].valor;
+}
+
+/* Comprueba si el iterador recorrio toda la tabla.
+ */
+bool hash_iter_al_final(const hash_iter_t *iter){
+	return iter->pos >= iter->hash->tam;
+}
+
+/* Destruye iterador.
+ * Pre: el iterador fue creado con hash_iter_crear.
+ */
+void hash_iter_destruir(hash_iter_t* iter){
+	free(iter);
+}
@@ -0,0 +1,186 @@
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hash_concurrente.h"
+#define SEGMENTOS_INICIAL 64
+#define TAM_LINEA 64
+
+// Con contadores cada busqueda escribe en el hash (ver hash_estadisticas).
+#ifdef HASH_CONTADORES
+#define BUSQUEDA_ESCRIBE true
+#else
+#define BUSQUEDA_ESCRIBE false
+#endif
+
+/* *****************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+// El relleno separa los candados de segmentos vecinos en lineas de cache
+// distintas, para que los hilos que usan segmentos distintos no se
+// estorben.
+typedef struct segmento{
+	pthread_rwlock_t candado;
+	hash_t* hash;
+	char relleno[TAM_LINEA];
+} segmento_t;
+
+// Todos los segmentos comparten funcion y semilla, asi el hash de una
+// clave se calcula una sola vez: los bits altos eligen el segmento y los
+// bajos la posicion dentro de su tabla.
+struct hash_concurrente{
+	segmento_t* segmentos;
+	size_t cant_segmentos;
+	unsigned corrimiento; // 64 - log2(cant_segmentos)
+	hash_funcion_t funcion;
+	uint64_t semilla;
+	// Las busquedas modifican los segmentos (modo cache, vencimientos o
+	// contadores), asi que se hacen con el candado de escritura.
+	bool busqueda_escribe;
+};
+
+/* *****************************************************************
+ *                DEFINICION DE FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+static segmento_t* segmento_de(const hash_concurrente_t* hash, uint64_t h){
+	size_t i = hash->cant_segmentos == 1 ? 0 : (size_t)(h >> hash->corrimiento);
+	return &hash->segmentos[i];
+}
+
+/* Bloquea el segmento para buscar una clave: para lectura, salvo que
+ * las busquedas modifiquen el hash.
+ */
+static void bloquear_busqueda(const hash_concurrente_t* hash, segmento_t* seg){
+	if(hash->busqueda_escribe)
+		pthread_rwlock_wrlock(&seg->candado);
+	else
+		pthread_rwlock_rdlock(&seg->candado);
+}
+
+/* Destruye los primeros cant segmentos.
+ */
+static void destruir_segmentos(segmento_t* segmentos, size_t cant){
+	for(size_t i = 0; i < cant; i++){
+		hash_destruir(segmentos[i].hash);
+		pthread_rwlock_destroy(&segmentos[i].candado);
+	}
+	free(segmentos);
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DEL HASH CONCURRENTE
+ * *****************************************************************/
+
+hash_concurrente_t* hash_concurrente_crear(hash_destruir_dato_t destruir_dato, const hash_opciones_t* opciones, size_t segmentos){
+	hash_concurrente_t* hash = malloc(sizeof(hash_concurrente_t));
+	if(!hash) return NULL;
+	hash_opciones_t opc;
+	memset(&opc, 0, sizeof(opc));
+	if(opciones) opc = *opciones;
+	if(!opc.funcion) opc.funcion = HASH_FUNCION_PREDETERMINADA;
+	hash->funcion = opc.funcion;
+	if(!opc.semilla) opc.semilla = hash_semilla_aleatoria(hash);
+	hash->semilla = opc.semilla;
+	hash->busqueda_escribe = BUSQUEDA_ESCRIBE || opc.cache_entradas || opc.cache_bytes || opc.vencimientos;
+
+	if(!segmentos) segmentos = SEGMENTOS_INICIAL;
+	hash->cant_segmentos = 1;
+	hash->corrimiento = 64;
+	while(hash->cant_segmentos < segmentos){
+		hash->cant_segmentos <<= 1;
+		hash->corrimiento--;
+	}
+	hash->segmentos = malloc(sizeof(segmento_t) * hash->cant_segmentos);
+	if(!hash->segmentos){
+		free(hash);
+		return NULL;
+	}
+	for(size_t i = 0; i < hash->cant_segmentos; i++){
+		segmento_t* seg = &hash->segmentos[i];
+		seg->hash = hash_crear_con_opciones(destruir_dato, &opc);
+		if(!seg->hash){
+			destruir_segmentos(hash->segmentos, i);
+			free(hash);
+			return NULL;
+		}
+		if(pthread_rwlock_init(&seg->candado, NULL)){
+			hash_destruir(seg->hash);
+			destruir_segmentos(hash->segmentos, i);
+			free(hash);
+			return NULL;
+		}
+	}
+	return hash;
+}
+
+bool hash_concurrente_guardar(hash_concurrente_t* hash, const char* clave, void* dato){
+	size_t largo = strlen(clave);
+	uint64_t h = hash->funcion(clave, largo, hash->semilla);
+	segmento_t* seg = segmento_de(hash, h);
+	pthread_rwlock_wrlock(&seg->candado);
+	bool ok = hash_guardar_nh(seg->hash, clave, largo, h, dato);
+	pthread_rwlock_unlock(&seg->candado);
+	return ok;
+}
+
+void* hash_concurrente_borrar(hash_concurrente_t* hash, const char* clave){
+	size_t largo = strlen(clave);
+	uint64_t h = hash->funcion(clave, largo, hash->semilla);
+	segmento_t* seg = segmento_de(hash, h);
+	pthread_rwlock_wrlock(&seg->candado);
+	void* dato = hash_borrar_nh(seg->hash, clave, largo, h);
+	pthread_rwlock_unlock(&seg->candado);
+	return dato;
+}
+
+bool hash_concurrente_obtener(const hash_concurrente_t* hash, const char* clave, void copiar(const void* dato, void* extra), void* extra){
+	size_t largo = strlen(clave);
+	uint64_t h = hash->funcion(clave, largo, hash->semilla);
+	segmento_t* seg = segmento_de(hash, h);
+	bloquear_busqueda(hash, seg);
+	// Un dato NULL tambien es una clave que esta.
+	void* dato = hash_obtener_nh(seg->hash, clave, largo, h);
+	bool esta = dato || hash_pertenece_nh(seg->hash, clave, largo, h);
+	if(esta) copiar(dato, extra);
+	pthread_rwlock_unlock(&seg->candado);
+	return esta;
+}
+
+bool hash_concurrente_visitar(hash_concurrente_t* hash, const char* clave, void visitar(void** dato, void* extra), void* extra){
+	size_t largo = strlen(clave);
+	uint64_t h = hash->funcion(clave, largo, hash->semilla);
+	segmento_t* seg = segmento_de(hash, h);
+	pthread_rwlock_wrlock(&seg->candado);
+	void** dato = hash_obtener_ptr_nh(seg->hash, clave, largo, h);
+	if(dato) visitar(dato, extra);
+	pthread_rwlock_unlock(&seg->candado);
+	return dato != NULL;
+}
+
+bool hash_concurrente_pertenece(const hash_concurrente_t* hash, const char* clave){
+	size_t largo = strlen(clave);
+	uint64_t h = hash->funcion(clave, largo, hash->semilla);
+	segmento_t* seg = segmento_de(hash, h);
+	bloquear_busqueda(hash, seg);
+	bool esta = hash_pertenece_nh(seg->hash, clave, largo, h);
+	pthread_rwlock_unlock(&seg->candado);
+	return esta;
+}
+
+size_t hash_concurrente_cantidad(const hash_concurrente_t* hash){
+	size_t cant = 0;
+	for(size_t i = 0; i < hash->cant_segmentos; i++){
+		segmento_t* seg = &hash->segmentos[i];
+		pthread_rwlock_rdlock(&seg->candado);
+		cant += hash_cantidad(seg->hash);
+		pthread_rwlock_unlock(&seg->candado);
+	}
+	return cant;
+}
+
+void hash_concurrente_destruir(hash_concurrente_t* hash){
+	destruir_segmentos(hash->segmentos, hash->cant_segmentos);
+	free(hash);
+}
@@ -0,0 +1,81 @@
+#ifndef HASH_CONCURRENTE_H
+#define HASH_CONCURRENTE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hash.h"
+
+/* Hash que se puede usar desde varios hilos a la vez. Las claves se
+ * reparten en segmentos segun los bits altos de su hash, y cada segmento
+ * es un hash_t con su propio candado de lectura y escritura: las
+ * lecturas de un mismo segmento no se bloquean entre si, y las
+ * escrituras solo bloquean su segmento. Cada segmento se redimensiona
+ * por su cuenta, sin detener a los demas, pero lo hace un solo hilo con
+ * el segmento bloqueado: no hay redimension cooperativa entre hilos, ni
+ * lecturas sin candado (con liberacion diferida por epocas). En modo
+ * cache, con vencimientos o con -DHASH_CONTADORES las busquedas
+ * modifican el hash, y entonces tambien bloquean su segmento para
+ * escritura: las lecturas de un mismo segmento se hacen de a una.
+ * Se compila junto con una de las implementaciones de hash.h, y con
+ * -pthread.
+ */
+
+struct hash_concurrente;
+typedef struct hash_concurrente hash_concurrente_t;
+
+/* Crea el hash con la cantidad de segmentos indicada (0: 64), que se
+ * redondea a potencia de dos. Las opciones valen para cada segmento
+ * (puede ser NULL); si se indica un asignador, debe poder usarse desde
+ * varios hilos a la vez.
+ * Post: devuelve el hash, o NULL si no hay memoria o las opciones son
+ * invalidas.
+ */
+hash_concurrente_t *hash_concurrente_crear(hash_destruir_dato_t destruir_dato, const hash_opciones_t *opciones, size_t segmentos);
+
+/* Igual que hash_guardar. Si la clave ya estaba, el dato anterior se
+ * destruye con la funcion destruir.
+ * Pre: el hash fue creado.
+ */
+bool hash_concurrente_guardar(hash_concurrente_t *hash, const char *clave, void *dato);
+
+/* Igual que hash_borrar.
+ * Pre: el hash fue creado.
+ */
+void *hash_concurrente_borrar(hash_concurrente_t *hash, const char *clave);
+
+/* Busca la clave y, si esta, aplica copiar a su dato mientras se tiene
+ * el segmento bloqueado, para que copie lo que necesite antes de que otro
+ * hilo pueda reemplazar o borrar la clave y destruir el dato. copiar no
+ * debe modificar el dato ni usar el hash. Devuelve false si la clave no
+ * esta.
+ * Pre: el hash fue creado.
+ */
+bool hash_concurrente_obtener(const hash_concurrente_t *hash, const char *clave, void copiar(const void *dato, void *extra), void *extra);
+
+/* Busca la clave y, si esta, aplica visitar a la direccion de su dato
+ * mientras se tiene el segmento bloqueado para escritura, de modo que se
+ * puede leer y actualizar el dato sin que otro hilo lo cambie. Devuelve
+ * false si la clave no esta.
+ * Pre: el hash fue creado.
+ */
+bool hash_concurrente_visitar(hash_concurrente_t *hash, const char *clave, void visitar(void **dato, void *extra), void *extra);
+
+/* Igual que hash_pertenece.
+ * Pre: el hash fue creado.
+ */
+bool hash_concurrente_pertenece(const hash_concurrente_t *hash, const char *clave);
+
+/* Devuelve la cantidad de elementos. Si otros hilos estan guardando o
+ * borrando, el valor puede no corresponder a ningun instante preciso.
+ * Pre: el hash fue creado.
+ */
+size_t hash_concurrente_cantidad(const hash_concurrente_t *hash);
+
+/* Destruye el hash llamando a destruir para cada dato.
+ * Pre: el hash fue creado y ningun otro hilo lo esta usando.
+ * Post: el hash fue destruido.
+ */
+void hash_concurrente_destruir(hash_concurrente_t *hash);
+
+#endif // HASH_CONCURRENTE_H
@@ -0,0 +1,238 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hash_congelado.h"
+#include "bitmap.h"
+#define CLAVES_POR_CUBETA 4 // promedio; mas claves ocupan menos pero tardan mas en armarse
+#define INTENTOS 8 // semillas que se prueban antes de rendirse
+#define MEZCLA_1 0x9e3779b97f4a7c15ULL
+#define MEZCLA_2 0xbf58476d1ce4e5b9ULL
+
+/* *****************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+typedef struct entrada{
+	void* valor;
+	size_t desplazamiento; // de la clave dentro del bloque de claves
+	size_t largo;
+} entrada_t;
+
+/* Las claves se reparten en cubetas segun su hash, y cada cubeta tiene
+ * un piloto: el numero que, mezclado con el hash de cada una de sus
+ * claves, les da una posicion libre en entradas. Los pilotos se buscan
+ * al congelar, empezando por las cubetas mas grandes.
+ */
+struct hash_congelado{
+	size_t cant;
+	size_t cant_cubetas;
+	uint64_t semilla;
+	uint32_t* pilotos;   // uno por cubeta
+	entrada_t* entradas; // una por clave, en la posicion que le toca
+	char* claves;        // todas las claves, cada una seguida de '\0'
+};
+
+// Clave del hash original mientras se arma el congelado.
+typedef struct clave_temp{
+	const char* clave;
+	size_t largo;
+	void* dato;
+	uint64_t h;
+	size_t pos;
+} clave_temp_t;
+
+/* *****************************************************************
+ *                DEFINICION DE FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+/* Lleva x a [0, n) con la parte alta de x * n, que usa los bits altos de
+ * x y evita la division de x % n.
+ */
+static size_t reducir(uint64_t x, size_t n){
+	return (size_t)(((__uint128_t)x * n) >> 64);
+}
+
+static size_t cubeta(const hash_congelado_t* hash, uint64_t h){
+	return reducir(h, hash->cant_cubetas);
+}
+
+/* Devuelve la posicion de la clave de hash h con el piloto de su cubeta.
+ */
+static size_t posicion(const hash_congelado_t* hash, uint64_t h, uint32_t piloto){
+	uint64_t x = h ^ (piloto * MEZCLA_1);
+	x ^= x >> 32;
+	x *= MEZCLA_2;
+	x ^= x >> 29;
+	return reducir(x, hash->cant);
+}
+
+// Ordena de mayor a menor.
+static int comparar_cubetas(const void* a, const void* b){
+	uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+	return (x < y) - (x > y);
+}
+
+/* Busca el piloto de cada cubeta para las claves, con el hash ya
+ * calculado, y guarda la posicion de cada una. Devuelve false si no hay
+ * memoria o si alguna cubeta no tiene piloto con la semilla actual.
+ */
+static bool buscar_pilotos(hash_congelado_t* hash, clave_temp_t* claves){
+	size_t n = hash->cant, r = hash->cant_cubetas;
+	size_t* inicio = calloc(r, sizeof(size_t));
+	size_t* miembros = malloc(sizeof(size_t) * n);
+	uint64_t* orden = malloc(sizeof(uint64_t) * r);
+	uint64_t* ocupadas = calloc(bitmap_palabras(n), sizeof(uint64_t));
+	bool ok = inicio && miembros && orden && ocupadas;
+
+	if(ok){
+		// Agrupa las claves por cubeta, y ordena las cubetas por tamaño
+		// guardando (tamaño, cubeta) en cada elemento de orden.
+		// inicio[b] cuenta primero las claves de la cubeta b, despues
+		// dice donde termina y al final donde empieza.
+		for(size_t i = 0; i < n; i++)
+			inicio[cubeta(hash, claves[i].h)]++;
+		for(size_t b = 0; b < r; b++){
+			orden[b] = (uint64_t)inicio[b] << 32 | b;
+			if(b > 0) inicio[b] += inicio[b - 1];
+		}
+		for(size_t i = n; i-- > 0;)
+			miembros[--inicio[cubeta(hash, claves[i].h)]] = i;
+		qsort(orden, r, sizeof(uint64_t), comparar_cubetas);
+	}
+
+	uint64_t limite = (uint64_t)n * 16 + 1024;
+	if(limite > UINT32_MAX) limite = UINT32_MAX;
+	for(size_t k = 0; ok && k < r && orden[k] >> 32; k++){
+		size_t b = (size_t)(orden[k] & UINT32_MAX);
+		size_t* miembros_b = miembros + inicio[b];
+		size_t tam = (size_t)(orden[k] >> 32);
+		uint32_t piloto = 0;
+		for(;; piloto++){
+			if(piloto == limite){
+				ok = false;
+				break;
+			}
+			size_t j = 0;
+			for(; j < tam; j++){
+				clave_temp_t* c = &claves[miembros_b[j]];
+				c->pos = posicion(hash, c->h, piloto);
+				if(bitmap_esta(ocupadas, c->pos)) break;
+				bitmap_marcar(ocupadas, c->pos);
+			}
+			if(j == tam) break;
+			while(j-- > 0)
+				bitmap_desmarcar(ocupadas, claves[miembros_b[j]].pos);
+		}
+		hash->pilotos[b] = piloto;
+	}
+	free(inicio);
+	free(miembros);
+	free(orden);
+	free(ocupadas);
+	return ok;
+}
+
+/* Busca la unica entrada en la que puede estar la clave y compara su
+ * clave. Devuelve la entrada, o NULL si la clave no esta.
+ */
+static const entrada_t* buscar_entrada(const hash_congelado_t* hash, const void* clave, size_t largo){
+	if(!hash->cant) return NULL;
+	uint64_t h = hash_funcion_wy(clave, largo, hash->semilla);
+	const entrada_t* entrada = &hash->entradas[posicion(hash, h, hash->pilotos[cubeta(hash, h)])];
+	if(entrada->largo != largo || memcmp(hash->claves + entrada->desplazamiento, clave, largo) != 0)
+		return NULL;
+	return entrada;
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DEL HASH CONGELADO
+ * *****************************************************************/
+
+hash_congelado_t* hash_congelar(const hash_t* hash){
+	hash_congelado_t* congelado = calloc(1, sizeof(hash_congelado_t));
+	if(!congelado) return NULL;
+	size_t n = hash_cantidad(hash);
+	congelado->cant = n;
+	// Sin claves no hay tablas: las busquedas terminan antes de mirarlas.
+	if(n == 0) return congelado;
+	congelado->cant_cubetas = n / CLAVES_POR_CUBETA + 1;
+	clave_temp_t* claves = malloc(sizeof(clave_temp_t) * n);
+	congelado->pilotos = malloc(sizeof(uint32_t) * congelado->cant_cubetas);
+	congelado->entradas = malloc(sizeof(entrada_t) * n);
+	if(!claves || !congelado->pilotos || !congelado->entradas){
+		free(claves);
+		hash_congelado_destruir(congelado);
+		return NULL;
+	}
+
+	hash_iter_t iter;
+	size_t i = 0, total = 0;
+	for(hash_iter_inicializar(&iter, hash); !hash_iter_al_final(&iter); hash_iter_avanzar(&iter), i++){
+		claves[i].clave = hash_iter_ver_actual_n(&iter, &claves[i].largo);
+		claves[i].dato = hash_iter_ver_dato(&iter);
+		total += claves[i].largo + 1;
+	}
+	congelado->claves = malloc(total);
+
+	bool ok = false;
+	for(int intento = 0; congelado->claves && !ok && intento < INTENTOS; intento++){
+		congelado->semilla = hash_semilla_aleatoria(congelado) ^ (uint64_t)intento;
+		for(i = 0; i < n; i++)
+			claves[i].h = hash_funcion_wy(claves[i].clave, claves[i].largo, congelado->semilla);
+		ok = buscar_pilotos(congelado, claves);
+	}
+	if(!ok){
+		free(claves);
+		hash_congelado_destruir(congelado);
+		return NULL;
+	}
+
+	size_t desplazamiento = 0;
+	for(i = 0; i < n; i++){
+		entrada_t* entrada = &congelado->entradas[claves[i].pos];
+		entrada->valor = claves[i].dato;
+		entrada->desplazamiento = desplazamiento;
+		entrada->largo = claves[i].largo;
+		memcpy(congelado->claves + desplazamiento, claves[i].clave, claves[i].largo);
+		congelado->claves[desplazamiento + claves[i].largo] = '\0';
+		desplazamiento += claves[i].largo + 1;
+	}
+	free(claves);
+	return congelado;
+}
+
+void* hash_congelado_obtener(const hash_congelado_t* hash, const char* clave){
+	return hash_congelado_obtener_n(hash, clave, strlen(clave));
+}
+
+void* hash_congelado_obtener_n(const hash_congelado_t* hash, const void* clave, size_t largo){
+	const entrada_t* entrada = buscar_entrada(hash, clave, largo);
+	return entrada ? entrada->valor : NULL;
+}
+
+bool hash_congelado_pertenece(const hash_congelado_t* hash, const char* clave){
+	return buscar_entrada(hash, clave, strlen(clave)) != NULL;
+}
+
+bool hash_congelado_pertenece_n(const hash_congelado_t* hash, const void* clave, size_t largo){
+	return buscar_entrada(hash, clave, largo) != NULL;
+}
+
+size_t hash_congelado_cantidad(const hash_congelado_t* hash){
+	return hash->cant;
+}
+
+void hash_congelado_iterar(const hash_congelado_t* hash, bool visitar(const char* clave, void* dato, void* extra), void* extra){
+	for(size_t i = 0; i < hash->cant; i++){
+		const entrada_t* entrada = &hash->entradas[i];
+		if(!visitar(hash->claves + entrada->desplazamiento, entrada->valor, extra))
+			return;
+	}
+}
+
+void hash_congelado_destruir(hash_congelado_t* hash){
+	free(hash->pilotos);
+	free(hash->entradas);
+	free(hash->claves);
+	free(hash);
+}
@@ -0,0 +1,59 @@
+#ifndef HASH_CONGELADO_H
+#define HASH_CONGELADO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "hash.h"
+
+/* Hash congelado: copia de solo lectura de un hash, para tablas que se
+ * arman una vez y despues solo se consultan. Usa una funcion de hashing
+ * perfecta minima (al estilo PTHash): cada clave tiene una posicion
+ * propia en un arreglo de exactamente tantas entradas como claves, de
+ * modo que una busqueda mira una sola entrada y compara una sola clave.
+ * Las claves se copian juntas en un unico bloque de memoria.
+ * Se compila junto con una de las implementaciones de hash.h.
+ */
+
+struct hash_congelado;
+typedef struct hash_congelado hash_congelado_t;
+
+/* Crea un hash congelado con las claves y los datos actuales del hash.
+ * Los datos no se copian: siguen siendo del hash original (o de quien
+ * los haya creado) y hash_congelado_destruir no los destruye. No
+ * modifica el hash: las claves vencidas que todavia no se borraron
+ * tambien quedan en el congelado.
+ * Pre: el hash fue creado.
+ * Post: devuelve el hash congelado, o NULL si no hay memoria o no se
+ * encontro una funcion perfecta para las claves.
+ */
+hash_congelado_t *hash_congelar(const hash_t *hash);
+
+/* Igual que hash_obtener y hash_obtener_n.
+ * Pre: el hash congelado fue creado.
+ */
+void *hash_congelado_obtener(const hash_congelado_t *hash, const char *clave);
+void *hash_congelado_obtener_n(const hash_congelado_t *hash, const void *clave, size_t largo);
+
+/* Igual que hash_pertenece y hash_pertenece_n.
+ * Pre: el hash congelado fue creado.
+ */
+bool hash_congelado_pertenece(const hash_congelado_t *hash, const char *clave);
+bool hash_congelado_pertenece_n(const hash_congelado_t *hash, const void *clave, size_t largo);
+
+/* Devuelve la cantidad de claves.
+ * Pre: el hash congelado fue creado.
+ */
+size_t hash_congelado_cantidad(const hash_congelado_t *hash);
+
+/* Igual que hash_iterar: aplica visitar a cada clave y su dato hasta que
+ * devuelva false.
+ * Pre: el hash congelado fue creado.
+ */
+void hash_congelado_iterar(const hash_congelado_t *hash, bool visitar(const char *clave, void *dato, void *extra), void *extra);
+
+/* Libera la memoria del hash congelado, sin destruir los datos.
+ * Pre: el hash congelado fue creado.
+ */
+void hash_congelado_destruir(hash_congelado_t *hash);
+
+#endif // HASH_CONGELADO_H
@@ -0,0 +1,32 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* *****************************************************************
+ *                DEFINICION DE FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+/* Mezcla final de splitmix64: reparte todos los bits de x, para que
+ * enteros consecutivos (o punteros alineados) no caigan en posiciones
+ * consecutivas.
+ */
+static uint64_t mezclar_entero(uint64_t x){
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+static char* copiar_cadena(const char* cadena){
+	size_t largo = strlen(cadena);
+	char* copia = malloc(largo + 1);
+	if(copia)
+		memcpy(copia, cadena, largo + 1);
+	return copia;
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DE LAS VARIANTES
+ * *****************************************************************/
+
+#define HASH_ESPECIALIZADO_IMPLEMENTACION
+#include "hash_especializado.h"
@@ -0,0 +1,54 @@
+#ifndef HASH_ESPECIALIZADO_H
+#define HASH_ESPECIALIZADO_H
+
+#include <stdint.h>
+#include "hash.h"
+
+/* Variantes del hash generadas con la plantilla hash_plano.h, para los
+ * usos en los que hash_t desperdicia memoria y tiempo:
+ *  - hash_set_t: conjunto de cadenas, sin dato por clave.
+ *  - hash_u64_t: claves enteras de 64 bits, sin convertirlas a cadena.
+ *  - hash_ptr_t: claves que son punteros (se compara la direccion, no lo
+ *    apuntado).
+ * Las primitivas se llaman como las de hash.h con otro prefijo
+ * (hash_u64_guardar, hash_set_pertenece, ...). Se compila junto con
+ * hash_especializado.c y hash_funciones.c.
+ */
+
+#ifdef HASH_ESPECIALIZADO_IMPLEMENTACION
+#define PLANO_IMPLEMENTACION
+#endif
+
+#define PLANO_NOMBRE hash_set
+#define PLANO_CLAVE const char *
+#define PLANO_CON_VALOR 0
+#define PLANO_HASHEAR(semilla, clave) hash_funcion_wy(clave, strlen(clave), semilla)
+#define PLANO_IGUALES(a, b) (strcmp(a, b) == 0)
+#define PLANO_COPIAR(destino, clave) (((destino) = copiar_cadena(clave)) != NULL)
+#define PLANO_LIBERAR(clave) free((char *)(clave))
+#define PLANO_GUARDAR_HASH 1
+#include "hash_plano.h"
+
+#define PLANO_NOMBRE hash_u64
+#define PLANO_CLAVE uint64_t
+#define PLANO_CON_VALOR 1
+#define PLANO_HASHEAR(semilla, clave) mezclar_entero((clave) ^ (semilla))
+#define PLANO_IGUALES(a, b) ((a) == (b))
+#define PLANO_COPIAR(destino, clave) ((destino) = (clave), true)
+#define PLANO_LIBERAR(clave) ((void)(clave))
+#define PLANO_GUARDAR_HASH 0
+#include "hash_plano.h"
+
+#define PLANO_NOMBRE hash_ptr
+#define PLANO_CLAVE const void *
+#define PLANO_CON_VALOR 1
+#define PLANO_HASHEAR(semilla, clave) mezclar_entero((uint64_t)(uintptr_t)(clave) ^ (semilla))
+#define PLANO_IGUALES(a, b) ((a) == (b))
+#define PLANO_COPIAR(destino, clave) ((destino) = (clave), true)
+#define PLANO_LIBERAR(clave) ((void)(clave))
+#define PLANO_GUARDAR_HASH 0
+#include "hash_plano.h"
+
+#undef PLANO_IMPLEMENTACION
+
+#endif // HASH_ESPECIALIZADO_H
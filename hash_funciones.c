@@ -0,0 +1,178 @@
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "hash_funciones.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define HAY_CRC32C_X86 1
+#endif
+
+/* Constantes de mezcla de wyhash. */
+#define SECRETO_0 0xa0761d6478bd642fULL
+#define SECRETO_1 0xe7037ed1a0b428dbULL
+#define SECRETO_2 0x8ebc6af09c88c6e3ULL
+#define SECRETO_3 0x589965cc75374cc3ULL
+
+/* *****************************************************************
+ *                DEFINICION DE FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+/* Multiplica a por b en 128 bits y deja la parte baja en a y la alta
+ * en b.
+ */
+static void multiplicar_128(uint64_t* a, uint64_t* b){
+#ifdef __SIZEOF_INT128__
+	__uint128_t r = (__uint128_t)*a * *b;
+	*a = (uint64_t)r;
+	*b = (uint64_t)(r >> 64);
+#else
+	uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+	uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	uint64_t t = rl + (rm0 << 32), c = t < rl;
+	uint64_t lo = t + (rm1 << 32);
+	c += lo < t;
+	*a = lo;
+	*b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static uint64_t mezclar(uint64_t a, uint64_t b){
+	multiplicar_128(&a, &b);
+	return a ^ b;
+}
+
+static uint64_t leer_8(const unsigned char* p){
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static uint64_t leer_4(const unsigned char* p){
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+/* Lee claves de 1 a 3 bytes sin salirse de la memoria de la clave. */
+static uint64_t leer_3(const unsigned char* p, size_t largo){
+	return ((uint64_t)p[0] << 16) | ((uint64_t)p[largo >> 1] << 8) | p[largo - 1];
+}
+
+#ifdef HAY_CRC32C_X86
+/* CRC32C por hardware sobre dos carriles, para tener 64 bits de
+ * resultado. El CRC es lineal, asi que por si solo dos claves que chocan
+ * chocan con cualquier semilla: cada bloque de 16 bytes se mezcla antes
+ * con la semilla con una multiplicacion de 128 bits, y cada carril
+ * recibe una mitad del producto.
+ */
+__attribute__((target("sse4.2")))
+static uint64_t hash_funcion_crc32c(const void* clave, size_t largo, uint64_t semilla){
+	const unsigned char* p = clave;
+	uint64_t k0 = semilla ^ SECRETO_0, k1 = mezclar(semilla ^ SECRETO_1, SECRETO_2);
+	uint64_t c0 = (uint32_t)semilla, c1 = semilla >> 32;
+	uint64_t a, b;
+	size_t i = largo;
+	if(largo <= 16){
+		if(largo >= 4){
+			size_t corrimiento = (largo >> 3) << 2;
+			a = (leer_4(p) << 32) | leer_4(p + corrimiento);
+			b = (leer_4(p + largo - 4) << 32) | leer_4(p + largo - 4 - corrimiento);
+		}else if(largo > 0){
+			a = leer_3(p, largo);
+			b = 0;
+		}else{
+			a = b = 0;
+		}
+	}else{
+		for(; i > 16; i -= 16, p += 16){
+			a = leer_8(p) ^ k0;
+			b = leer_8(p + 8) ^ k1;
+			multiplicar_128(&a, &b);
+			c0 = _mm_crc32_u64(c0, a);
+			c1 = _mm_crc32_u64(c1, b);
+		}
+		a = leer_8(p + i - 16);
+		b = leer_8(p + i - 8);
+	}
+	a ^= k0;
+	b ^= k1 ^ largo;
+	multiplicar_128(&a, &b);
+	c0 = _mm_crc32_u64(c0, a);
+	c1 = _mm_crc32_u64(c1, b);
+	return mezclar((c1 << 32 | c0) ^ SECRETO_0, semilla ^ SECRETO_2);
+}
+#endif
+
+/* *****************************************************************
+ *                    FUNCIONES DE HASHING
+ * *****************************************************************/
+
+uint64_t hash_funcion_wy(const void* clave, size_t largo, uint64_t semilla){
+	const unsigned char* p = clave;
+	uint64_t a, b;
+	semilla ^= mezclar(semilla ^ SECRETO_0, SECRETO_1);
+	if(largo <= 16){
+		if(largo >= 4){
+			size_t corrimiento = (largo >> 3) << 2;
+			a = (leer_4(p) << 32) | leer_4(p + corrimiento);
+			b = (leer_4(p + largo - 4) << 32) | leer_4(p + largo - 4 - corrimiento);
+		}else if(largo > 0){
+			a = leer_3(p, largo);
+			b = 0;
+		}else{
+			a = b = 0;
+		}
+	}else{
+		size_t i = largo;
+		if(i > 48){
+			uint64_t semilla1 = semilla, semilla2 = semilla;
+			do{
+				semilla = mezclar(leer_8(p) ^ SECRETO_1, leer_8(p + 8) ^ semilla);
+				semilla1 = mezclar(leer_8(p + 16) ^ SECRETO_2, leer_8(p + 24) ^ semilla1);
+				semilla2 = mezclar(leer_8(p + 32) ^ SECRETO_3, leer_8(p + 40) ^ semilla2);
+				p += 48;
+				i -= 48;
+			}while(i > 48);
+			semilla ^= semilla1 ^ semilla2;
+		}
+		while(i > 16){
+			semilla = mezclar(leer_8(p) ^ SECRETO_1, leer_8(p + 8) ^ semilla);
+			i -= 16;
+			p += 16;
+		}
+		a = leer_8(p + i - 16);
+		b = leer_8(p + i - 8);
+	}
+	a ^= SECRETO_1;
+	b ^= semilla;
+	multiplicar_128(&a, &b);
+	return mezclar(a ^ SECRETO_0 ^ largo, b ^ SECRETO_1);
+}
+
+uint64_t hash_funcion_fnv(const void* clave, size_t largo, uint64_t semilla){
+	const unsigned char* p = clave;
+	uint64_t hashvalue = 14695981039346656037ULL ^ semilla;
+	for(size_t i = 0; i < largo; i++){
+		hashvalue ^= p[i];
+		hashvalue *= 1099511628211ULL;
+	}
+	return hashvalue;
+}
+
+hash_funcion_t hash_funcion_acelerada(void){
+#ifdef HAY_CRC32C_X86
+	if(__builtin_cpu_supports("sse4.2"))
+		return hash_funcion_crc32c;
+#endif
+	return hash_funcion_wy;
+}
+
+uint64_t hash_semilla_aleatoria(const void* extra){
+	int local;
+	uint64_t semilla = (uint64_t)time(NULL);
+	semilla = mezclar(semilla ^ SECRETO_0, (uint64_t)clock() ^ SECRETO_1);
+	semilla = mezclar(semilla ^ (uint64_t)(uintptr_t)&local, SECRETO_2);
+	semilla = mezclar(semilla ^ (uint64_t)(uintptr_t)extra, SECRETO_3);
+	return semilla ? semilla : SECRETO_0;
+}
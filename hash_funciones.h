@@ -0,0 +1,46 @@
+#ifndef HASH_FUNCIONES_H
+#define HASH_FUNCIONES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* *****************************************************************
+ *                    FUNCIONES DE HASHING
+ * *****************************************************************/
+
+// Tipo de funcion de hashing: recibe la clave, su largo en bytes y una
+// semilla, y devuelve el valor de hash completo (64 bits).
+typedef uint64_t (*hash_funcion_t)(const void *clave, size_t largo, uint64_t semilla);
+
+// Funcion que usa el hash si no se elige otra. Se puede redefinir al
+// compilar, por ejemplo -DHASH_FUNCION_PREDETERMINADA=hash_funcion_fnv.
+#ifndef HASH_FUNCION_PREDETERMINADA
+#define HASH_FUNCION_PREDETERMINADA hash_funcion_wy
+#endif
+
+/* Hashing al estilo wyhash: consume la clave de a 8 bytes y mezcla con
+ * multiplicaciones de 64x64 -> 128 bits. Es la funcion predeterminada.
+ */
+uint64_t hash_funcion_wy(const void *clave, size_t largo, uint64_t semilla);
+
+/* FNV-1a de a un byte. Es lenta, pero simple y estable entre
+ * plataformas.
+ */
+uint64_t hash_funcion_fnv(const void *clave, size_t largo, uint64_t semilla);
+
+/* Devuelve la funcion mas rapida para el procesador en el que se esta
+ * ejecutando: CRC32C por hardware si hay SSE4.2, si no hash_funcion_wy.
+ * Con CRC32C cada bloque de la clave se mezcla con la semilla antes de
+ * entrar al CRC, asi que las colisiones cambian con la semilla igual que
+ * con hash_funcion_wy.
+ */
+hash_funcion_t hash_funcion_acelerada(void);
+
+/* Devuelve una semilla difícil de predecir desde afuera del proceso.
+ * extra se mezcla con la semilla para que dos tablas creadas en el
+ * mismo instante no la compartan (por ejemplo, la direccion de la
+ * tabla). No es apta para usos criptograficos.
+ */
+uint64_t hash_semilla_aleatoria(const void *extra);
+
+#endif // HASH_FUNCIONES_H
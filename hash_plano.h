@@ -0,0 +1,404 @@
+/* Plantilla de hash plano: una tabla de sondeo lineal ordenada (Robin
+ * Hood) con las claves y los datos en linea, sin punteros por elemento.
+ * No tiene guarda de inclusion: se incluye una vez por cada variante,
+ * despues de definir
+ *   PLANO_NOMBRE       prefijo de los nombres (hash_u64 da hash_u64_t,
+ *                      hash_u64_crear, hash_u64_guardar, ...)
+ *   PLANO_CLAVE        tipo de la clave
+ *   PLANO_CON_VALOR    1 si cada clave tiene un dato (void*), 0 si es un
+ *                      conjunto
+ * Siempre declara el tipo y las primitivas. Si ademas esta definido
+ * PLANO_IMPLEMENTACION, las define, usando:
+ *   PLANO_HASHEAR(semilla, clave)   hash de 64 bits de la clave
+ *   PLANO_IGUALES(a, b)             si dos claves son iguales
+ *   PLANO_COPIAR(destino, clave)    guarda la clave en destino; false si
+ *                                   no hay memoria
+ *   PLANO_LIBERAR(clave)            libera una clave copiada
+ *   PLANO_GUARDAR_HASH              1 para guardar el hash de cada clave
+ *                                   (si es caro de recalcular)
+ * Ver hash_especializado.h.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hash.h"
+#include "robin_hood.h"
+
+#define PLANO_UNIR_(a, b) a##b
+#define PLANO_UNIR(a, b) PLANO_UNIR_(a, b)
+#define PLANO_F(nombre) PLANO_UNIR(PLANO_NOMBRE, nombre)
+#define PLANO_T PLANO_F(_t)
+
+/* *****************************************************************
+ *                    PRIMITIVAS DEL HASH PLANO
+ * *****************************************************************/
+
+typedef struct PLANO_NOMBRE PLANO_T;
+
+/* Crea el hash. Si tiene datos, destruir_dato se aplica a cada uno al
+ * borrarlo por reemplazo o al destruir el hash (puede ser NULL).
+ */
+#if PLANO_CON_VALOR
+PLANO_T *PLANO_F(_crear)(hash_destruir_dato_t destruir_dato);
+#else
+PLANO_T *PLANO_F(_crear)(void);
+#endif
+
+/* Guarda la clave (con su dato). Si ya estaba, reemplaza el dato. De no
+ * poder guardarla devuelve false.
+ * Pre: el hash fue creado.
+ */
+#if PLANO_CON_VALOR
+bool PLANO_F(_guardar)(PLANO_T *hash, PLANO_CLAVE clave, void *dato);
+#else
+bool PLANO_F(_guardar)(PLANO_T *hash, PLANO_CLAVE clave);
+#endif
+
+/* Borra la clave. Devuelve su dato (o NULL si no estaba); en un
+ * conjunto, si estaba.
+ * Pre: el hash fue creado.
+ */
+#if PLANO_CON_VALOR
+void *PLANO_F(_borrar)(PLANO_T *hash, PLANO_CLAVE clave);
+
+/* Devuelve el dato de la clave, o NULL si no esta.
+ * Pre: el hash fue creado.
+ */
+void *PLANO_F(_obtener)(const PLANO_T *hash, PLANO_CLAVE clave);
+#else
+bool PLANO_F(_borrar)(PLANO_T *hash, PLANO_CLAVE clave);
+#endif
+
+/* Determina si la clave pertenece al hash.
+ * Pre: el hash fue creado.
+ */
+bool PLANO_F(_pertenece)(const PLANO_T *hash, PLANO_CLAVE clave);
+
+/* Devuelve la cantidad de claves.
+ * Pre: el hash fue creado.
+ */
+size_t PLANO_F(_cantidad)(const PLANO_T *hash);
+
+/* Agranda la tabla para que entren capacidad claves sin volver a
+ * redimensionar. Devuelve false si no hay memoria.
+ * Pre: el hash fue creado.
+ */
+bool PLANO_F(_reservar)(PLANO_T *hash, size_t capacidad);
+
+/* Aplica visitar a cada clave (y su dato) hasta que devuelva false.
+ * Pre: el hash fue creado.
+ */
+#if PLANO_CON_VALOR
+void PLANO_F(_iterar)(const PLANO_T *hash, bool visitar(PLANO_CLAVE clave, void *dato, void *extra), void *extra);
+#else
+void PLANO_F(_iterar)(const PLANO_T *hash, bool visitar(PLANO_CLAVE clave, void *extra), void *extra);
+#endif
+
+/* Destruye el hash, y los datos si se indico destruir_dato.
+ * Pre: el hash fue creado.
+ */
+void PLANO_F(_destruir)(PLANO_T *hash);
+
+#ifdef PLANO_IMPLEMENTACION
+
+#include <stdlib.h>
+#define PLANO_TAM_INICIAL 16 // siempre potencia de dos
+#define PLANO_CARGA_MAXIMA 0.8
+#define PLANO_DISTANCIA_MAX 255 // distancias[i] es un byte
+
+/* *****************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+typedef struct PLANO_F(_entrada){
+	PLANO_CLAVE clave;
+#if PLANO_CON_VALOR
+	void *valor;
+#endif
+#if PLANO_GUARDAR_HASH
+	uint64_t hash;
+#endif
+} PLANO_F(_entrada_t);
+
+// distancias[i] es 0 si la posicion esta vacia, o uno mas que la
+// distancia del campo a su posicion ideal. Las claves de cada tramo
+// ocupado quedan ordenadas por posicion ideal, asi que una busqueda corta
+// en cuanto encuentra una distancia menor a la que lleva.
+struct PLANO_NOMBRE{
+	PLANO_F(_entrada_t) *entradas;
+	uint8_t *distancias;
+	size_t tam;
+	size_t cant;
+	uint64_t semilla;
+#if PLANO_CON_VALOR
+	hash_destruir_dato_t destruir;
+#endif
+};
+
+/* *****************************************************************
+ *                DEFINICION DE FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+static uint64_t PLANO_F(_hash_entrada)(const PLANO_T *hash, const PLANO_F(_entrada_t) *entrada){
+#if PLANO_GUARDAR_HASH
+	(void)hash;
+	return entrada->hash;
+#else
+	return PLANO_HASHEAR(hash->semilla, entrada->clave);
+#endif
+}
+
+/* Busca la clave de hash h. Si esta devuelve true y su posicion en pos;
+ * si no, guarda en pos donde habria que insertarla y en distancia la
+ * distancia que le tocaria ahi (mayor a PLANO_DISTANCIA_MAX si no entra).
+ */
+static bool PLANO_F(_buscar)(const PLANO_T *hash, PLANO_CLAVE clave, uint64_t h, size_t *pos, unsigned *distancia){
+	size_t mascara = hash->tam - 1;
+	size_t i = (size_t)h & mascara;
+	unsigned d = 1;
+	ROBIN_SONDEAR(i, d, mascara, d <= PLANO_DISTANCIA_MAX && hash->distancias[i] >= d){
+		if(hash->distancias[i] != d) continue;
+#if PLANO_GUARDAR_HASH
+		if(hash->entradas[i].hash != h) continue;
+#endif
+		if(PLANO_IGUALES(hash->entradas[i].clave, clave)){
+			*pos = i;
+			return true;
+		}
+	}
+	*pos = i;
+	if(distancia) *distancia = d;
+	return false;
+}
+
+/* Inserta la entrada en pos, con la distancia indicada, corriendo un
+ * lugar hacia adelante el resto del tramo. Devuelve false sin modificar
+ * nada si algun campo quedaria a mas de PLANO_DISTANCIA_MAX.
+ */
+static bool PLANO_F(_insertar_en)(PLANO_T *hash, size_t pos, unsigned distancia, PLANO_F(_entrada_t) entrada){
+	if(distancia > PLANO_DISTANCIA_MAX) return false;
+	size_t mascara = hash->tam - 1;
+	size_t fin = pos;
+	ROBIN_FIN_TRAMO(fin, mascara, hash->distancias[fin]){
+		if(hash->distancias[fin] == PLANO_DISTANCIA_MAX) return false;
+	}
+	ROBIN_CORRER_ADELANTE(pos, fin, anterior, mascara){
+		hash->entradas[fin] = hash->entradas[anterior];
+		hash->distancias[fin] = (uint8_t)(hash->distancias[anterior] + 1);
+	}
+	hash->entradas[pos] = entrada;
+	hash->distancias[pos] = (uint8_t)distancia;
+	return true;
+}
+
+/* Reubica todas las entradas en una tabla de tam_nuevo posiciones.
+ * Devuelve false si no hay memoria o si alguna quedaria demasiado lejos
+ * de su posicion ideal; en ambos casos el hash no cambia.
+ */
+static bool PLANO_F(_redimensionar)(PLANO_T *hash, size_t tam_nuevo){
+	PLANO_T nuevo = *hash;
+	nuevo.tam = tam_nuevo;
+	nuevo.entradas = malloc(sizeof(PLANO_F(_entrada_t)) * tam_nuevo);
+	nuevo.distancias = calloc(tam_nuevo, 1);
+	bool ok = nuevo.entradas && nuevo.distancias;
+	for(size_t i = 0; ok && i < hash->tam; i++){
+		if(!hash->distancias[i]) continue;
+		size_t pos;
+		unsigned distancia;
+		PLANO_F(_buscar)(&nuevo, hash->entradas[i].clave, PLANO_F(_hash_entrada)(hash, &hash->entradas[i]), &pos, &distancia);
+		ok = PLANO_F(_insertar_en)(&nuevo, pos, distancia, hash->entradas[i]);
+	}
+	if(!ok){
+		free(nuevo.entradas);
+		free(nuevo.distancias);
+		return false;
+	}
+	free(hash->entradas);
+	free(hash->distancias);
+	*hash = nuevo;
+	return true;
+}
+
+/* Agranda la tabla al doble, o mas si al doble alguna entrada quedaria
+ * demasiado lejos de su posicion ideal.
+ */
+static bool PLANO_F(_crecer)(PLANO_T *hash){
+	for(size_t tam = hash->tam * 2; tam <= hash->tam * 16; tam *= 2){
+		if(PLANO_F(_redimensionar)(hash, tam))
+			return true;
+	}
+	return false;
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DEL HASH PLANO
+ * *****************************************************************/
+
+#if PLANO_CON_VALOR
+PLANO_T *PLANO_F(_crear)(hash_destruir_dato_t destruir_dato){
+#else
+PLANO_T *PLANO_F(_crear)(void){
+#endif
+	PLANO_T *hash = malloc(sizeof(PLANO_T));
+	if(!hash) return NULL;
+	hash->tam = PLANO_TAM_INICIAL;
+	hash->cant = 0;
+	hash->entradas = malloc(sizeof(PLANO_F(_entrada_t)) * hash->tam);
+	hash->distancias = calloc(hash->tam, 1);
+	if(!hash->entradas || !hash->distancias){
+		free(hash->entradas);
+		free(hash->distancias);
+		free(hash);
+		return NULL;
+	}
+	hash->semilla = hash_semilla_aleatoria(hash);
+#if PLANO_CON_VALOR
+	hash->destruir = destruir_dato;
+#endif
+	return hash;
+}
+
+#if PLANO_CON_VALOR
+bool PLANO_F(_guardar)(PLANO_T *hash, PLANO_CLAVE clave, void *dato){
+#else
+bool PLANO_F(_guardar)(PLANO_T *hash, PLANO_CLAVE clave){
+#endif
+	uint64_t h = PLANO_HASHEAR(hash->semilla, clave);
+	size_t pos;
+	unsigned distancia;
+	if(PLANO_F(_buscar)(hash, clave, h, &pos, &distancia)){
+#if PLANO_CON_VALOR
+		if(hash->destruir)
+			hash->destruir(hash->entradas[pos].valor);
+		hash->entradas[pos].valor = dato;
+#endif
+		return true;
+	}
+	if((double)(hash->cant + 1) > PLANO_CARGA_MAXIMA * (double)hash->tam){
+		if(!PLANO_F(_crecer)(hash)) return false;
+		PLANO_F(_buscar)(hash, clave, h, &pos, &distancia);
+	}
+
+	PLANO_F(_entrada_t) entrada;
+	if(!PLANO_COPIAR(entrada.clave, clave)) return false;
+#if PLANO_CON_VALOR
+	entrada.valor = dato;
+#endif
+#if PLANO_GUARDAR_HASH
+	entrada.hash = h;
+#endif
+	while(!PLANO_F(_insertar_en)(hash, pos, distancia, entrada)){
+		if(!PLANO_F(_crecer)(hash)){
+			PLANO_LIBERAR(entrada.clave);
+			return false;
+		}
+		PLANO_F(_buscar)(hash, clave, h, &pos, &distancia);
+	}
+	hash->cant++;
+	return true;
+}
+
+#if PLANO_CON_VALOR
+void *PLANO_F(_borrar)(PLANO_T *hash, PLANO_CLAVE clave){
+#else
+bool PLANO_F(_borrar)(PLANO_T *hash, PLANO_CLAVE clave){
+#endif
+	size_t i;
+	if(!PLANO_F(_buscar)(hash, clave, PLANO_HASHEAR(hash->semilla, clave), &i, NULL)){
+#if PLANO_CON_VALOR
+		return NULL;
+#else
+		return false;
+#endif
+	}
+#if PLANO_CON_VALOR
+	void *dato = hash->entradas[i].valor;
+#endif
+	PLANO_LIBERAR(hash->entradas[i].clave);
+
+	// Corrimiento hacia atras: los campos desplazados vuelven un lugar.
+	size_t mascara = hash->tam - 1;
+	ROBIN_CORRER_ATRAS(i, j, mascara, hash->distancias[j] > 1){
+		hash->entradas[i] = hash->entradas[j];
+		hash->distancias[i] = (uint8_t)(hash->distancias[j] - 1);
+	}
+	hash->distancias[i] = 0;
+	hash->cant--;
+#if PLANO_CON_VALOR
+	return dato;
+#else
+	return true;
+#endif
+}
+
+#if PLANO_CON_VALOR
+void *PLANO_F(_obtener)(const PLANO_T *hash, PLANO_CLAVE clave){
+	size_t pos;
+	if(!PLANO_F(_buscar)(hash, clave, PLANO_HASHEAR(hash->semilla, clave), &pos, NULL))
+		return NULL;
+	return hash->entradas[pos].valor;
+}
+#endif
+
+bool PLANO_F(_pertenece)(const PLANO_T *hash, PLANO_CLAVE clave){
+	size_t pos;
+	return PLANO_F(_buscar)(hash, clave, PLANO_HASHEAR(hash->semilla, clave), &pos, NULL);
+}
+
+size_t PLANO_F(_cantidad)(const PLANO_T *hash){
+	return hash->cant;
+}
+
+bool PLANO_F(_reservar)(PLANO_T *hash, size_t capacidad){
+	size_t tam = hash->tam;
+	while((double)capacidad > PLANO_CARGA_MAXIMA * (double)tam)
+		tam *= 2;
+	return tam == hash->tam || PLANO_F(_redimensionar)(hash, tam);
+}
+
+#if PLANO_CON_VALOR
+void PLANO_F(_iterar)(const PLANO_T *hash, bool visitar(PLANO_CLAVE clave, void *dato, void *extra), void *extra){
+#else
+void PLANO_F(_iterar)(const PLANO_T *hash, bool visitar(PLANO_CLAVE clave, void *extra), void *extra){
+#endif
+	for(size_t i = 0; i < hash->tam; i++){
+		if(!hash->distancias[i]) continue;
+#if PLANO_CON_VALOR
+		if(!visitar(hash->entradas[i].clave, hash->entradas[i].valor, extra))
+#else
+		if(!visitar(hash->entradas[i].clave, extra))
+#endif
+			return;
+	}
+}
+
+void PLANO_F(_destruir)(PLANO_T *hash){
+	for(size_t i = 0; i < hash->tam; i++){
+		if(!hash->distancias[i]) continue;
+		PLANO_LIBERAR(hash->entradas[i].clave);
+#if PLANO_CON_VALOR
+		if(hash->destruir)
+			hash->destruir(hash->entradas[i].valor);
+#endif
+	}
+	free(hash->entradas);
+	free(hash->distancias);
+	free(hash);
+}
+
+#undef PLANO_TAM_INICIAL
+#undef PLANO_CARGA_MAXIMA
+#undef PLANO_DISTANCIA_MAX
+#endif // PLANO_IMPLEMENTACION
+
+#undef PLANO_NOMBRE
+#undef PLANO_CLAVE
+#undef PLANO_CON_VALOR
+#undef PLANO_HASHEAR
+#undef PLANO_IGUALES
+#undef PLANO_COPIAR
+#undef PLANO_LIBERAR
+#undef PLANO_GUARDAR_HASH
+#undef PLANO_T
+#undef PLANO_F
@@ -1,198 +1,327 @@
-#include <stdlib.h>
-#include <stdio.h>
-#include "lista.h"
-
-/* ****************************************************************
-   *                   DEFINICION DE STRUCTS                      *
-   **************************************************************** */
-
-struct nodo{
-    void* dato;
-    struct nodo* prox;
-}typedef nodo_t;
-
-
-struct lista{
-    nodo_t* primero;
-    nodo_t* ultimo;
-    size_t cantidad;
-};
-
-struct lista_iter{
-    nodo_t* nodo_actual;
-    nodo_t* nodo_anterior;
-    lista_t* lista;
-};
-
-
-nodo_t* nodo_crear(void* valor){
-    nodo_t* nodo = malloc(sizeof(nodo_t));
-    if(!nodo){
-        return NULL;
-    }
-    nodo->dato = valor;
-    nodo->prox = NULL;
-    return nodo;
-}
-
-/* ****************************************************************
-   *                   PRIMITIVAS DE LA LISTA                     *
-   **************************************************************** */
-
-lista_t* lista_crear(void){
-    lista_t* lista = malloc(sizeof(lista_t));
-    if(!lista){
-        return NULL;
-    }
-    lista->primero = NULL;
-    lista->ultimo = NULL;
-    lista->cantidad = 0;
-    return lista;
-}
-
-bool lista_esta_vacia(const lista_t* lista){
-    return (!lista->primero);
-}
-
-bool lista_insertar_primero(lista_t* lista, void* dato){
-    nodo_t* nodo = nodo_crear(dato);
-    nodo->prox = lista->primero;
-    if(!lista->primero){
-        lista->ultimo = nodo;
-    }
-    lista->primero = nodo;
-    lista->cantidad++;
-    return true;
-}
-
-bool lista_insertar_ultimo(lista_t* lista, void* dato){
-    nodo_t* nodo = nodo_crear(dato);
-    if(!nodo)return NULL;
-    if(!lista->primero){
-        lista->primero = nodo;
-    }else{
-        lista->ultimo->prox = nodo;
-    }
-    lista->ultimo = nodo;
-    lista->cantidad++;
-    return true;
-}
-
-void* lista_borrar_primero(lista_t* lista) {
-    if(!lista->primero) return NULL;
-    nodo_t *auxiliar = lista->primero;
-    lista->primero = lista->primero->prox;
-    if (!lista->primero) {
-        lista->ultimo = NULL;
-    }
-    void* dato = auxiliar->dato;
-    free(auxiliar);
-    lista->cantidad--;
-    return dato;
-}
-
-void* lista_ver_primero(const lista_t* lista){
-    if(!lista->primero) return NULL;
-    return lista->primero->dato;
-}
-
-void* lista_ver_ultimo(const lista_t* lista){
-    if(!lista->ultimo) return NULL;
-    return lista->ultimo->dato;
-}
-
-size_t lista_largo(const lista_t* lista){
-    return lista->cantidad;
-}
-
-void lista_destruir(lista_t* lista, void destruir_dato(void*)){
-    while(lista->primero){
-        void* dato = lista_borrar_primero(lista);
-        if(destruir_dato){
-            destruir_dato(dato);
-        }
-    }
-    free(lista);
-}
-
-/* ****************************************************************
-   *                PRIMITIVAS DEL ITERADOR EXTERNO               *
-   **************************************************************** */
-
-lista_iter_t* lista_iter_crear(lista_t* lista){
-    lista_iter_t* iter = malloc(sizeof(lista_iter_t));
-    if(!iter) return NULL;
-    iter->lista = lista;
-    iter->nodo_actual = lista->primero;
-    iter->nodo_anterior = NULL;
-    return iter;
-}
-
-bool lista_iter_avanzar(lista_iter_t* iter){
-    if(!iter->nodo_actual) return false;
-    iter->nodo_anterior = iter->nodo_actual;
-    iter->nodo_actual = iter->nodo_actual->prox;
-    return true;
-}
-
-void* lista_iter_ver_actual(const lista_iter_t* iter){
-    if(!iter->nodo_actual) return NULL;
-    return iter->nodo_actual->dato;
-}
-
-bool lista_iter_al_final(const lista_iter_t* iter){
-    if(iter->nodo_actual) return false;
-    return true;
-}
-
-void lista_iter_destruir(lista_iter_t* iter){
-    free(iter);
-}
-
-bool lista_iter_insertar(lista_iter_t* iter, void* dato){
-    if(!iter->nodo_anterior){
-        lista_insertar_primero(iter->lista, dato);
-        iter->nodo_actual = iter->lista->primero;
-        return true;
-    }
-    if(!iter->nodo_actual){
-        lista_insertar_ultimo(iter->lista, dato);
-        iter->nodo_actual = iter->lista->ultimo;
-        return true;
-    }
-    nodo_t* nodo = nodo_crear(dato);
-    if(!nodo) return false;
-    iter->nodo_anterior->prox = nodo;
-    nodo->prox = iter->nodo_actual;
-    iter->nodo_actual = nodo;
-    iter->lista->cantidad++;
-    return true;
-}
-
-void* lista_iter_borrar(lista_iter_t* iter){
-    if(!iter->nodo_actual) return NULL;
-    iter->nodo_actual = iter->nodo_actual->prox;
-    if(!iter->nodo_anterior){
-        return lista_borrar_primero(iter->lista);
-    }
-    nodo_t* auxiliar = iter->nodo_anterior->prox;
-    iter->nodo_anterior->prox = iter->nodo_actual;
-    if(iter->nodo_actual == iter->lista->ultimo){
-        iter->lista->ultimo = iter->nodo_anterior;
-    }
-    void* dato = auxiliar->dato;
-    iter->lista->cantidad--;
-    free(auxiliar);
-    return dato;
-}
-
-/* ****************************************************************
-   *                PRIMITIVAS DEL ITERADOR INTERNO               *
-   **************************************************************** */
-
-void lista_iterar(lista_t* lista, bool visitar(void* dato, void* extra), void* extra) {
-    nodo_t *actual = lista->primero;
-    while (actual && visitar(actual->dato, extra)) {
-        actual = actual->prox;
-    }
-}
\ No newline at end of file
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "lista.h"
+
+// Datos por nodo: con los enlaces y los indices, un nodo ocupa 128 bytes
+// (dos lineas de cache) en plataformas de 64 bits.
+#define DATOS_POR_NODO 12
+
+// Nodos vacios que guarda cada lista para reutilizar; los demas se liberan.
+#define NODOS_LIBRES 8
+
+/* ****************************************************************
+   *                   DEFINICION DE STRUCTS                      *
+   **************************************************************** */
+
+// Los datos ocupados del nodo son datos[inicio] .. datos[inicio + cant - 1],
+// asi se puede insertar y borrar en los dos extremos sin mover datos.
+struct nodo{
+    struct nodo* ant;
+    struct nodo* prox;
+    size_t inicio;
+    size_t cant;
+    void* datos[DATOS_POR_NODO];
+}typedef nodo_t;
+
+
+struct lista{
+    nodo_t* primero;
+    nodo_t* ultimo;
+    size_t cantidad;
+    nodo_t* libres; // nodos para reutilizar, enlazados por prox
+    size_t cant_libres;
+};
+
+/* ****************************************************************
+   *                   FUNCIONES AUXILIARES                       *
+   **************************************************************** */
+
+// Devuelve un nodo vacio, reutilizando uno de la lista si lo hay.
+static nodo_t* nodo_crear(lista_t* lista){
+    nodo_t* nodo = lista->libres;
+    if(nodo){
+        lista->libres = nodo->prox;
+        lista->cant_libres--;
+    }else{
+        nodo = malloc(sizeof(nodo_t));
+        if(!nodo){
+            return NULL;
+        }
+    }
+    nodo->ant = NULL;
+    nodo->prox = NULL;
+    nodo->inicio = 0;
+    nodo->cant = 0;
+    return nodo;
+}
+
+// Guarda el nodo para reutilizarlo, o lo libera si ya hay suficientes.
+static void nodo_destruir(lista_t* lista, nodo_t* nodo){
+    if(lista->cant_libres == NODOS_LIBRES){
+        free(nodo);
+        return;
+    }
+    nodo->prox = lista->libres;
+    lista->libres = nodo;
+    lista->cant_libres++;
+}
+
+// Enlaza el nodo despues de anterior, o al principio si anterior es NULL.
+static void enlazar_nodo(lista_t* lista, nodo_t* nodo, nodo_t* anterior){
+    nodo->ant = anterior;
+    nodo->prox = anterior ? anterior->prox : lista->primero;
+    if(nodo->prox){
+        nodo->prox->ant = nodo;
+    }else{
+        lista->ultimo = nodo;
+    }
+    if(anterior){
+        anterior->prox = nodo;
+    }else{
+        lista->primero = nodo;
+    }
+}
+
+// Desenlaza el nodo de la lista (manteniendo primero y ultimo) y lo destruye.
+static void quitar_nodo(lista_t* lista, nodo_t* nodo){
+    if(nodo->ant){
+        nodo->ant->prox = nodo->prox;
+    }else{
+        lista->primero = nodo->prox;
+    }
+    if(nodo->prox){
+        nodo->prox->ant = nodo->ant;
+    }else{
+        lista->ultimo = nodo->ant;
+    }
+    nodo_destruir(lista, nodo);
+}
+
+// Pasa la segunda mitad de los datos de un nodo lleno a un nodo nuevo,
+// enlazado a continuacion. Devuelve el nodo nuevo, o NULL si no hay memoria.
+static nodo_t* partir_nodo(lista_t* lista, nodo_t* nodo){
+    nodo_t* nuevo = nodo_crear(lista);
+    if(!nuevo){
+        return NULL;
+    }
+    nuevo->cant = nodo->cant / 2;
+    nodo->cant -= nuevo->cant;
+    memcpy(nuevo->datos, &nodo->datos[nodo->inicio + nodo->cant], nuevo->cant * sizeof(void*));
+    enlazar_nodo(lista, nuevo, nodo);
+    return nuevo;
+}
+
+// Ubica al iterador en el primer dato de nodo (o al final si es NULL).
+static void iter_ubicar(lista_iter_t* iter, nodo_t* nodo){
+    iter->nodo = nodo;
+    iter->pos = nodo ? nodo->inicio : 0;
+}
+
+/* ****************************************************************
+   *                   PRIMITIVAS DE LA LISTA                     *
+   **************************************************************** */
+
+lista_t* lista_crear(void){
+    lista_t* lista = malloc(sizeof(lista_t));
+    if(!lista){
+        return NULL;
+    }
+    lista->primero = NULL;
+    lista->ultimo = NULL;
+    lista->cantidad = 0;
+    lista->libres = NULL;
+    lista->cant_libres = 0;
+    return lista;
+}
+
+bool lista_esta_vacia(const lista_t* lista){
+    return (!lista->cantidad);
+}
+
+bool lista_insertar_primero(lista_t* lista, void* dato){
+    nodo_t* nodo = lista->primero;
+    if(!nodo || nodo->inicio == 0){
+        nodo = nodo_crear(lista);
+        if(!nodo) return false;
+        // Se llena desde el final, para seguir insertando adelante.
+        nodo->inicio = DATOS_POR_NODO;
+        enlazar_nodo(lista, nodo, NULL);
+    }
+    nodo->datos[--nodo->inicio] = dato;
+    nodo->cant++;
+    lista->cantidad++;
+    return true;
+}
+
+bool lista_insertar_ultimo(lista_t* lista, void* dato){
+    nodo_t* nodo = lista->ultimo;
+    if(!nodo || nodo->inicio + nodo->cant == DATOS_POR_NODO){
+        nodo = nodo_crear(lista);
+        if(!nodo) return false;
+        enlazar_nodo(lista, nodo, lista->ultimo);
+    }
+    nodo->datos[nodo->inicio + nodo->cant++] = dato;
+    lista->cantidad++;
+    return true;
+}
+
+void* lista_borrar_primero(lista_t* lista) {
+    nodo_t* nodo = lista->primero;
+    if(!nodo) return NULL;
+    void* dato = nodo->datos[nodo->inicio++];
+    if(!--nodo->cant){
+        quitar_nodo(lista, nodo);
+    }
+    lista->cantidad--;
+    return dato;
+}
+
+void* lista_ver_primero(const lista_t* lista){
+    if(!lista->primero) return NULL;
+    return lista->primero->datos[lista->primero->inicio];
+}
+
+void* lista_ver_ultimo(const lista_t* lista){
+    if(!lista->ultimo) return NULL;
+    return lista->ultimo->datos[lista->ultimo->inicio + lista->ultimo->cant - 1];
+}
+
+size_t lista_largo(const lista_t* lista){
+    return lista->cantidad;
+}
+
+void lista_destruir(lista_t* lista, void destruir_dato(void*)){
+    nodo_t* nodo = lista->primero;
+    while(nodo){
+        nodo_t* prox = nodo->prox;
+        if(destruir_dato){
+            for(size_t i = nodo->inicio; i < nodo->inicio + nodo->cant; i++){
+                destruir_dato(nodo->datos[i]);
+            }
+        }
+        free(nodo);
+        nodo = prox;
+    }
+    while(lista->libres){
+        nodo_t* prox = lista->libres->prox;
+        free(lista->libres);
+        lista->libres = prox;
+    }
+    free(lista);
+}
+
+/* ****************************************************************
+   *                PRIMITIVAS DEL ITERADOR EXTERNO               *
+   **************************************************************** */
+
+void lista_iter_inicializar(lista_iter_t* iter, lista_t* lista){
+    iter->lista = lista;
+    iter_ubicar(iter, lista->primero);
+}
+
+lista_iter_t* lista_iter_crear(lista_t* lista){
+    lista_iter_t* iter = malloc(sizeof(lista_iter_t));
+    if(!iter) return NULL;
+    lista_iter_inicializar(iter, lista);
+    return iter;
+}
+
+bool lista_iter_avanzar(lista_iter_t* iter){
+    nodo_t* nodo = iter->nodo;
+    if(!nodo) return false;
+    if(++iter->pos == nodo->inicio + nodo->cant){
+        iter_ubicar(iter, nodo->prox);
+    }
+    return true;
+}
+
+void* lista_iter_ver_actual(const lista_iter_t* iter){
+    nodo_t* nodo = iter->nodo;
+    if(!nodo) return NULL;
+    return nodo->datos[iter->pos];
+}
+
+bool lista_iter_al_final(const lista_iter_t* iter){
+    if(iter->nodo) return false;
+    return true;
+}
+
+void lista_iter_destruir(lista_iter_t* iter){
+    free(iter);
+}
+
+bool lista_iter_insertar(lista_iter_t* iter, void* dato){
+    lista_t* lista = iter->lista;
+    nodo_t* nodo = iter->nodo;
+    if(!nodo){
+        if(!lista_insertar_ultimo(lista, dato)) return false;
+        iter->nodo = lista->ultimo;
+        iter->pos = lista->ultimo->inicio + lista->ultimo->cant - 1;
+        return true;
+    }
+    size_t pos = iter->pos;
+    if(nodo->cant == DATOS_POR_NODO){
+        nodo_t* nuevo = partir_nodo(lista, nodo);
+        if(!nuevo) return false;
+        if(pos >= nodo->inicio + nodo->cant){
+            pos -= nodo->inicio + nodo->cant;
+            nodo = nuevo;
+        }
+    }
+    // Se corren los datos hacia el lado del nodo que tenga lugar.
+    if(nodo->inicio > 0){
+        memmove(&nodo->datos[nodo->inicio - 1], &nodo->datos[nodo->inicio], (pos - nodo->inicio) * sizeof(void*));
+        nodo->inicio--;
+        pos--;
+    }else{
+        memmove(&nodo->datos[pos + 1], &nodo->datos[pos], (nodo->inicio + nodo->cant - pos) * sizeof(void*));
+    }
+    nodo->datos[pos] = dato;
+    nodo->cant++;
+    lista->cantidad++;
+    iter->nodo = nodo;
+    iter->pos = pos;
+    return true;
+}
+
+void* lista_iter_borrar(lista_iter_t* iter){
+    lista_t* lista = iter->lista;
+    nodo_t* nodo = iter->nodo;
+    if(!nodo) return NULL;
+    size_t pos = iter->pos;
+    size_t fin = nodo->inicio + nodo->cant;
+    void* dato = nodo->datos[pos];
+    // Se corre la parte mas corta del nodo sobre el lugar del dato borrado.
+    if(pos - nodo->inicio < fin - pos - 1){
+        memmove(&nodo->datos[nodo->inicio + 1], &nodo->datos[nodo->inicio], (pos - nodo->inicio) * sizeof(void*));
+        nodo->inicio++;
+        pos++;
+    }else{
+        memmove(&nodo->datos[pos], &nodo->datos[pos + 1], (fin - pos - 1) * sizeof(void*));
+    }
+    nodo->cant--;
+    lista->cantidad--;
+    if(pos == nodo->inicio + nodo->cant){
+        nodo_t* prox = nodo->prox;
+        if(!nodo->cant){
+            quitar_nodo(lista, nodo);
+        }
+        iter_ubicar(iter, prox);
+    }else{
+        iter->pos = pos;
+    }
+    return dato;
+}
+
+/* ****************************************************************
+   *                PRIMITIVAS DEL ITERADOR INTERNO               *
+   **************************************************************** */
+
+void lista_iterar(lista_t* lista, bool visitar(void* dato, void* extra), void* extra) {
+    for(nodo_t* nodo = lista->primero; nodo; nodo = nodo->prox){
+        for(size_t i = nodo->inicio; i < nodo->inicio + nodo->cant; i++){
+            if(!visitar(nodo->datos[i], extra)) return;
+        }
+    }
+}
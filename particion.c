@@ -0,0 +1,165 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "particion.h"
+
+/* *****************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+// Trabajo de un hilo sobre las claves desde..hasta del lote.
+struct tramo{
+	const char* const* claves;
+	size_t desde;
+	size_t hasta;
+	hash_funcion_t funcion;
+	uint64_t semilla;
+	size_t mascara;
+	particion_t* particion;
+	size_t* cuentas; // claves del tramo por particion, y luego donde va la proxima
+}typedef tramo_t;
+
+// Lo que recibe cada hilo creado por particion_ejecutar: correr tarea
+// sobre args[primero], args[primero + salto], ...
+struct trabajo{
+	particion_tarea_t tarea;
+	char* args;
+	size_t tam_arg;
+	size_t cant;
+	size_t primero;
+	size_t salto;
+}typedef trabajo_t;
+
+/* *****************************************************************
+ *                DEFINICION DE FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+/* Calcula el largo y el hash de las claves del tramo y cuenta cuantas
+ * caen en cada particion.
+ */
+static void contar_tramo(void* arg){
+	tramo_t* tramo = arg;
+	particion_t* particion = tramo->particion;
+	for(size_t i = tramo->desde; i < tramo->hasta; i++){
+		particion->largos[i] = strlen(tramo->claves[i]);
+		particion->hs[i] = tramo->funcion(tramo->claves[i], particion->largos[i], tramo->semilla);
+		tramo->cuentas[((size_t)particion->hs[i] & tramo->mascara) >> particion->corrimiento]++;
+	}
+}
+
+/* Escribe los indices de las claves del tramo en el lugar de su
+ * particion, a partir de las posiciones que dejo particion_crear en
+ * cuentas.
+ */
+static void repartir_tramo(void* arg){
+	tramo_t* tramo = arg;
+	particion_t* particion = tramo->particion;
+	for(size_t i = tramo->desde; i < tramo->hasta; i++)
+		particion->orden[tramo->cuentas[((size_t)particion->hs[i] & tramo->mascara) >> particion->corrimiento]++] = i;
+}
+
+static void* correr_trabajo(void* arg){
+	trabajo_t* trabajo = arg;
+	for(size_t i = trabajo->primero; i < trabajo->cant; i += trabajo->salto)
+		trabajo->tarea(trabajo->args + i * trabajo->tam_arg);
+	return NULL;
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DE LA PARTICION
+ * *****************************************************************/
+
+void particion_ejecutar(particion_tarea_t tarea, void* args, size_t tam_arg, size_t cant, size_t hilos){
+	if(hilos > cant) hilos = cant;
+	pthread_t* ids = malloc(sizeof(pthread_t) * hilos);
+	trabajo_t* trabajos = malloc(sizeof(trabajo_t) * hilos);
+	bool* creados = calloc(hilos, sizeof(bool));
+	if(!ids || !trabajos || !creados)
+		hilos = 1;
+	trabajo_t propio = {tarea, args, tam_arg, cant, 0, hilos ? hilos : 1};
+	// El trabajo 0 corre en el hilo actual, mientras trabajan los demas.
+	for(size_t t = 1; t < hilos; t++){
+		trabajos[t] = propio;
+		trabajos[t].primero = t;
+		creados[t] = pthread_create(&ids[t], NULL, correr_trabajo, &trabajos[t]) == 0;
+	}
+	correr_trabajo(&propio);
+	for(size_t t = 1; t < hilos; t++){
+		if(creados[t]){
+			pthread_join(ids[t], NULL);
+		}else{
+			propio.primero = t;
+			correr_trabajo(&propio);
+		}
+	}
+	free(ids);
+	free(trabajos);
+	free(creados);
+}
+
+size_t particion_cantidad(size_t hilos, size_t tam, size_t minimo){
+	size_t particiones = 1;
+	while((particiones < hilos || tam / particiones > PARTICION_POSICIONES) && tam / (particiones * 2) >= minimo)
+		particiones *= 2;
+	return particiones;
+}
+
+bool particion_crear(particion_t* particion, const char* const claves[], size_t cant, hash_funcion_t funcion, uint64_t semilla, size_t tam, size_t particiones, size_t hilos){
+	if(hilos == 0) hilos = 1;
+	if(hilos > cant) hilos = cant ? cant : 1;
+	particion->particiones = particiones;
+	particion->corrimiento = 0;
+	while(((size_t)1 << particion->corrimiento) < tam / particiones)
+		particion->corrimiento++;
+	particion->hs = malloc(sizeof(uint64_t) * (cant ? cant : 1));
+	particion->largos = malloc(sizeof(size_t) * (cant ? cant : 1));
+	particion->orden = malloc(sizeof(size_t) * (cant ? cant : 1));
+	particion->inicio = malloc(sizeof(size_t) * (particiones + 1));
+	size_t* cuentas = calloc(hilos * particiones, sizeof(size_t));
+	tramo_t* tramos = malloc(sizeof(tramo_t) * hilos);
+	if(!particion->hs || !particion->largos || !particion->orden || !particion->inicio || !cuentas || !tramos){
+		free(cuentas);
+		free(tramos);
+		particion_destruir(particion);
+		return false;
+	}
+	for(size_t t = 0; t < hilos; t++){
+		tramos[t].claves = claves;
+		tramos[t].desde = cant * t / hilos;
+		tramos[t].hasta = cant * (t + 1) / hilos;
+		tramos[t].funcion = funcion;
+		tramos[t].semilla = semilla;
+		tramos[t].mascara = tam - 1;
+		tramos[t].particion = particion;
+		tramos[t].cuentas = cuentas + t * particiones;
+	}
+	particion_ejecutar(contar_tramo, tramos, sizeof(tramo_t), hilos, hilos);
+
+	// Dentro de cada particion van primero las claves del primer tramo,
+	// asi se respeta el orden del lote.
+	size_t total = 0;
+	for(size_t p = 0; p < particiones; p++){
+		particion->inicio[p] = total;
+		for(size_t t = 0; t < hilos; t++){
+			size_t n = tramos[t].cuentas[p];
+			tramos[t].cuentas[p] = total;
+			total += n;
+		}
+	}
+	particion->inicio[particiones] = total;
+	particion_ejecutar(repartir_tramo, tramos, sizeof(tramo_t), hilos, hilos);
+	free(cuentas);
+	free(tramos);
+	return true;
+}
+
+void particion_destruir(particion_t* particion){
+	free(particion->hs);
+	free(particion->largos);
+	free(particion->orden);
+	free(particion->inicio);
+	particion->hs = NULL;
+	particion->largos = NULL;
+	particion->orden = NULL;
+	particion->inicio = NULL;
+}
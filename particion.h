@@ -0,0 +1,65 @@
+#ifndef PARTICION_H
+#define PARTICION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hash_funciones.h"
+
+/* Reparto de un lote de claves entre hilos, para que cada hilo arme
+ * rangos propios de posiciones de una tabla sin usar candados. Lo usan las
+ * implementaciones de hash_construir_paralelo. Se compila con -pthread.
+ */
+
+// Posiciones de la tabla que se busca que tenga cada particion, para que
+// el rango que arma un hilo entre en la cache del procesador.
+#define PARTICION_POSICIONES 16384
+
+/* *****************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+// Claves de un lote repartidas por particion. Las de la particion p son
+// orden[inicio[p]] .. orden[inicio[p + 1] - 1], indices de claves en el
+// orden del lote. hs y largos se indexan igual que las claves.
+typedef struct particion{
+	uint64_t *hs;
+	size_t *largos;
+	size_t *orden;
+	size_t *inicio; // particiones + 1 elementos
+	size_t particiones;
+	size_t corrimiento; // la posicion pos es de la particion pos >> corrimiento
+} particion_t;
+
+// Tarea que corre un hilo sobre su argumento.
+typedef void (*particion_tarea_t)(void *arg);
+
+/* *****************************************************************
+ *                    PRIMITIVAS DE LA PARTICION
+ * *****************************************************************/
+
+// Corre tarea sobre cada uno de los cant argumentos, de tam_arg bytes y
+// contiguos en args, repartidos entre hilos hilos (el hilo t corre los
+// argumentos t, t + hilos, ...), y espera a que terminen. Si no se puede
+// crear algun hilo, sus tareas corren en el hilo actual.
+void particion_ejecutar(particion_tarea_t tarea, void *args, size_t tam_arg, size_t cant, size_t hilos);
+
+// Devuelve cuantas particiones usar con hilos hilos en una tabla de tam
+// posiciones: una potencia de dos, al menos hilos y con no mas de
+// PARTICION_POSICIONES posiciones cada una, si eso deja al menos minimo
+// posiciones en cada particion.
+// Pre: tam y minimo son potencias de dos.
+size_t particion_cantidad(size_t hilos, size_t tam, size_t minimo);
+
+// Calcula en hilos hilos el largo y el hash (con funcion y semilla) de las
+// cant claves, y las reparte en particiones segun su posicion en una
+// tabla de tam posiciones: la particion p tiene las posiciones desde
+// p * tam / particiones hasta antes de (p + 1) * tam / particiones.
+// Pre: tam y particiones son potencias de dos y particiones <= tam.
+// Post: devuelve false si no hay memoria.
+bool particion_crear(particion_t *particion, const char *const claves[], size_t cant, hash_funcion_t funcion, uint64_t semilla, size_t tam, size_t particiones, size_t hilos);
+
+// Libera la memoria de una particion creada con particion_crear.
+void particion_destruir(particion_t *particion);
+
+#endif // PARTICION_H
@@ -0,0 +1,191 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../hash.h"
+#include "../hash_archivo.h"
+#include "pruebas.h"
+
+/* Prueba de hash_archivo: guardar un hash y abrirlo mapeado, indexar un
+ * archivo de texto, guardar el hash de un archivo de texto (claves
+ * prestadas, sin '\0'), guardar un hash con claves vencidas sin
+ * modificarlo, que una escritura fallida no pise el archivo anterior, y
+ * buscar en un archivo dañado.
+ */
+
+#define CANT 2000
+#define LARGO_CLAVE 32
+
+static char claves[CANT][LARGO_CLAVE];
+static char ruta_binario[64];
+static char ruta_texto[64];
+
+static bool escribir_cadena(const void* dato, FILE* archivo){
+	const char* cadena = dato;
+	return fwrite(cadena, 1, strlen(cadena), archivo) == strlen(cadena);
+}
+
+static void prueba_guardar_y_mapear(void){
+	hash_t* hash = hash_crear(NULL);
+	VERIFICAR(hash);
+	for(size_t i = 0; i < CANT; i++)
+		VERIFICAR(hash_guardar(hash, claves[i], i % 10 ? claves[i] : ""));
+	VERIFICAR(hash_guardar_archivo(hash, ruta_binario, escribir_cadena));
+	hash_destruir(hash);
+
+	hash_mmap_t* mapeado = hash_abrir_mmap(ruta_binario);
+	VERIFICAR(mapeado && hash_mmap_verificar(mapeado));
+	VERIFICAR(hash_mmap_cantidad(mapeado) == CANT);
+	for(size_t i = 0; i < CANT; i++){
+		size_t largo;
+		const char* dato = hash_mmap_obtener(mapeado, claves[i], &largo);
+		VERIFICAR(dato && (uintptr_t)dato % 8 == 0);
+		if(i % 10)
+			VERIFICAR(largo == strlen(claves[i]) && memcmp(dato, claves[i], largo) == 0);
+		else
+			VERIFICAR(largo == 0);
+	}
+	VERIFICAR(!hash_mmap_pertenece(mapeado, "no-esta"));
+	hash_mmap_cerrar(mapeado);
+}
+
+static void prueba_texto(void){
+	FILE* archivo = fopen(ruta_texto, "w");
+	VERIFICAR(archivo);
+	fputs("uno\t1\nsin-valor\n\ndos\tvalor con espacios\r\nuno\tpisado\ntres\t3", archivo);
+	VERIFICAR(fclose(archivo) == 0);
+
+	hash_texto_t* texto = hash_abrir_texto(ruta_texto, NULL);
+	VERIFICAR(texto);
+	size_t largo;
+	const char* valor = hash_texto_obtener(texto, "uno", &largo);
+	VERIFICAR(valor && largo == 6 && memcmp(valor, "pisado", 6) == 0);
+	valor = hash_texto_obtener(texto, "dos", &largo);
+	VERIFICAR(valor && largo == 18 && memcmp(valor, "valor con espacios", 18) == 0);
+	VERIFICAR(hash_texto_obtener(texto, "sin-valor", &largo) && largo == 0);
+	// La ultima clave termina justo al final del mapeo, sin '\0'.
+	valor = hash_texto_obtener(texto, "tres", &largo);
+	VERIFICAR(valor && largo == 1 && *valor == '3');
+	VERIFICAR(!hash_texto_obtener(texto, "cuatro", NULL));
+	VERIFICAR(hash_cantidad(hash_texto_hash(texto)) == 4);
+
+	// Guardar el hash del texto copia cada clave sin leer mas alla de ella.
+	VERIFICAR(hash_guardar_archivo(hash_texto_hash(texto), ruta_binario, NULL));
+	hash_texto_cerrar(texto);
+	hash_mmap_t* mapeado = hash_abrir_mmap(ruta_binario);
+	VERIFICAR(mapeado && hash_mmap_verificar(mapeado));
+	VERIFICAR(hash_mmap_cantidad(mapeado) == 4);
+	VERIFICAR(hash_mmap_pertenece(mapeado, "tres") && hash_mmap_pertenece(mapeado, "sin-valor"));
+	hash_mmap_cerrar(mapeado);
+}
+
+static uint64_t ahora;
+
+static uint64_t reloj(void){
+	return ahora;
+}
+
+static void prueba_guardar_con_vencidas(void){
+	hash_opciones_t opciones = {0};
+	opciones.vencimientos = true;
+	opciones.reloj = reloj;
+	hash_t* hash = hash_crear_con_opciones(free, &opciones);
+	VERIFICAR(hash);
+	for(size_t i = 0; i < CANT; i++){
+		char* dato = malloc(LARGO_CLAVE);
+		VERIFICAR(dato);
+		strcpy(dato, claves[i]);
+		VERIFICAR(hash_guardar_ttl(hash, claves[i], dato, 10));
+	}
+	ahora = 100;
+	VERIFICAR(hash_guardar_archivo(hash, ruta_binario, escribir_cadena));
+	VERIFICAR(hash_cantidad(hash) == CANT);
+	hash_destruir(hash);
+}
+
+static bool fallar_escritura(const void* dato, FILE* archivo){
+	(void)dato;
+	(void)archivo;
+	return false;
+}
+
+/* Si no se puede escribir el archivo nuevo, el anterior queda entero y
+ * no queda el temporal.
+ */
+static void prueba_guardar_fallido(void){
+	hash_t* hash = hash_crear(NULL);
+	VERIFICAR(hash);
+	VERIFICAR(hash_guardar(hash, "vieja", "dato viejo"));
+	VERIFICAR(hash_guardar_archivo(hash, ruta_binario, escribir_cadena));
+	VERIFICAR(hash_guardar(hash, "nueva", "dato nuevo"));
+	VERIFICAR(!hash_guardar_archivo(hash, ruta_binario, fallar_escritura));
+	hash_destruir(hash);
+
+	char temporal[sizeof(ruta_binario) + 4];
+	snprintf(temporal, sizeof(temporal), "%s.tmp", ruta_binario);
+	VERIFICAR(!fopen(temporal, "rb"));
+	hash_mmap_t* mapeado = hash_abrir_mmap(ruta_binario);
+	VERIFICAR(mapeado && hash_mmap_verificar(mapeado));
+	VERIFICAR(hash_mmap_cantidad(mapeado) == 1 && !hash_mmap_pertenece(mapeado, "nueva"));
+	size_t largo;
+	const char* dato = hash_mmap_obtener(mapeado, "vieja", &largo);
+	VERIFICAR(dato && largo == strlen("dato viejo") && memcmp(dato, "dato viejo", largo) == 0);
+	hash_mmap_cerrar(mapeado);
+}
+
+/* Deja todas las ranuras ocupadas y los registros con largos que no
+ * entran en el archivo.
+ */
+static void prueba_archivo_danado(void){
+	hash_t* hash = hash_crear(NULL);
+	VERIFICAR(hash);
+	VERIFICAR(hash_guardar(hash, "a", NULL) && hash_guardar(hash, "bb", NULL));
+	VERIFICAR(hash_guardar_archivo(hash, ruta_binario, NULL));
+	hash_destruir(hash);
+
+	FILE* archivo = fopen(ruta_binario, "rb+");
+	VERIFICAR(archivo);
+	unsigned char contenido[4096];
+	size_t largo = fread(contenido, 1, sizeof(contenido), archivo);
+	VERIFICAR(largo > 56 && largo < sizeof(contenido));
+	uint64_t tam, ranura[2], registro[2] = {UINT64_MAX / 2, 1};
+	memcpy(&tam, contenido + 24, sizeof(tam)); // despues de magia, version, orden y cant
+	for(uint64_t i = 0; i < tam; i++){
+		unsigned char* lugar = contenido + 56 + i * sizeof(ranura);
+		memcpy(ranura, lugar, sizeof(ranura));
+		if(ranura[1])
+			memcpy(contenido + ranura[1], registro, sizeof(registro));
+		else
+			ranura[1] = 8;
+		memcpy(lugar, ranura, sizeof(ranura));
+	}
+	VERIFICAR(fseek(archivo, 0, SEEK_SET) == 0 && fwrite(contenido, 1, largo, archivo) == largo);
+	VERIFICAR(fclose(archivo) == 0);
+
+	hash_mmap_t* mapeado = hash_abrir_mmap(ruta_binario);
+	VERIFICAR(mapeado);
+	VERIFICAR(!hash_mmap_verificar(mapeado));
+	VERIFICAR(!hash_mmap_obtener(mapeado, "a", NULL) && !hash_mmap_pertenece(mapeado, "bb"));
+	VERIFICAR(!hash_mmap_pertenece(mapeado, "no-esta"));
+	hash_mmap_cerrar(mapeado);
+}
+
+int main(void){
+	for(size_t i = 0; i < CANT; i++)
+		snprintf(claves[i], LARGO_CLAVE, i % 2 ? "c%zu" : "una-clave-larga-%zu", i);
+	snprintf(ruta_binario, sizeof(ruta_binario), "prueba_archivo_%ld.bin", (long)getpid());
+	snprintf(ruta_texto, sizeof(ruta_texto), "prueba_archivo_%ld.txt", (long)getpid());
+
+	prueba_guardar_y_mapear();
+	prueba_texto();
+	prueba_guardar_con_vencidas();
+	prueba_guardar_fallido();
+	prueba_archivo_danado();
+
+	remove(ruta_binario);
+	remove(ruta_texto);
+	puts("prueba_archivo: OK");
+	return 0;
+}
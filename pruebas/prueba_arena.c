@@ -0,0 +1,214 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../hash.h"
+#include "pruebas.h"
+
+/* Prueba de la arena, el slab y el asignador del hash: que toda la
+ * memoria pedida se devuelva, que el modo arena pida pocas paginas, que
+ * alcance un asignador sin liberar, y que un asignador que falla deje el
+ * hash consistente.
+ */
+
+#define CANT 20000
+#define LARGO_CLAVE 40
+#define TAM_BLOQUE ((size_t)64 << 20)
+
+static char claves[CANT][LARGO_CLAVE];
+static long valores[CANT];
+
+// Contexto del asignador de la prueba.
+typedef struct{
+	size_t pedidos;
+	size_t liberados;
+	size_t fallar_en; // numero de pedido que falla (0: ninguno)
+	char* bloque;     // si no es NULL, se reparte avanzando usado
+	size_t usado;
+} contexto_t;
+
+static void* pedir(void* ctx, size_t tam){
+	contexto_t* contexto = ctx;
+	if(++contexto->pedidos == contexto->fallar_en){
+		contexto->pedidos--;
+		contexto->fallar_en = 0;
+		return NULL;
+	}
+	if(!contexto->bloque)
+		return malloc(tam);
+	tam = (tam + 15) & ~(size_t)15;
+	if(contexto->usado + tam > TAM_BLOQUE)
+		return NULL;
+	void* ptr = contexto->bloque + contexto->usado;
+	contexto->usado += tam;
+	return ptr;
+}
+
+static void liberar(void* ctx, void* ptr){
+	contexto_t* contexto = ctx;
+	contexto->liberados++;
+	free(ptr);
+}
+
+static void prueba_arena(void){
+	arena_t* arena = arena_crear(NULL);
+	VERIFICAR(arena);
+	// Cada pedido esta alineado y no se pisa con los demas, aun los mas
+	// grandes que una pagina.
+	unsigned char* pedidos[1000];
+	size_t tams[1000];
+	for(size_t i = 0; i < 1000; i++){
+		tams[i] = i % 100 == 99 ? 100000 + i : i % 37 + 1;
+		pedidos[i] = arena_pedir(arena, tams[i]);
+		VERIFICAR(pedidos[i] && (uintptr_t)pedidos[i] % sizeof(uint64_t) == 0);
+		memset(pedidos[i], (int)(i & 0xff), tams[i]);
+	}
+	for(size_t i = 0; i < 1000; i++){
+		for(size_t j = 0; j < tams[i]; j++)
+			VERIFICAR(pedidos[i][j] == (i & 0xff));
+	}
+
+	slab_t slab;
+	slab_inicializar(&slab, arena, 24);
+	void* a = slab_pedir(&slab);
+	void* b = slab_pedir(&slab);
+	VERIFICAR(a && b && a != b);
+	slab_devolver(&slab, a);
+	VERIFICAR(slab_pedir(&slab) == a);
+	VERIFICAR(slab_pedir(&slab) != b);
+	arena_destruir(arena);
+}
+
+/* Guarda, reemplaza y borra claves largas y cortas, con los vencimientos
+ * y la instantanea de las opciones que los usan.
+ */
+static void usar(hash_t* hash, bool vencimientos){
+	for(size_t i = 0; i < CANT; i++){
+		if(vencimientos && i % 3 == 0)
+			VERIFICAR(hash_guardar_ttl(hash, claves[i], &valores[i], 1000000));
+		else
+			VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+	}
+	hash_snapshot_t* instantanea = hash_snapshot(hash);
+	VERIFICAR(instantanea);
+	for(size_t i = 0; i < CANT; i += 2)
+		VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+	for(size_t i = 0; i < CANT; i += 3)
+		hash_borrar(hash, claves[i]);
+	hash_snapshot_destruir(instantanea);
+	for(size_t i = 0; i < CANT / 2; i++)
+		hash_borrar(hash, claves[i]);
+	VERIFICAR(hash_compactar(hash));
+}
+
+static void prueba_todo_liberado(void){
+	for(int modo = 0; modo < 4; modo++){
+		contexto_t contexto = {0};
+		hash_opciones_t opciones = {0};
+		opciones.asignador.pedir = pedir;
+		opciones.asignador.liberar = liberar;
+		opciones.asignador.ctx = &contexto;
+		opciones.arena = modo == 1;
+		opciones.cache_entradas = modo == 2 ? CANT / 2 : 0;
+		opciones.vencimientos = modo == 3;
+		hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+		VERIFICAR(hash);
+		usar(hash, opciones.vencimientos);
+		hash_destruir(hash);
+		VERIFICAR(contexto.pedidos > 0 && contexto.pedidos == contexto.liberados);
+	}
+}
+
+/* En modo arena los campos y las claves salen de paginas grandes: la
+ * cantidad de pedidos no depende de la de claves.
+ */
+static void prueba_pocos_pedidos(void){
+	contexto_t contexto = {0};
+	hash_opciones_t opciones = {0};
+	opciones.asignador.pedir = pedir;
+	opciones.asignador.liberar = liberar;
+	opciones.asignador.ctx = &contexto;
+	opciones.arena = true;
+	hash_t* hash = hash_crear_con_opciones(free, &opciones);
+	VERIFICAR(hash);
+	for(size_t i = 0; i < CANT; i++){
+		long* dato = malloc(sizeof(long));
+		VERIFICAR(dato);
+		*dato = (long)i;
+		VERIFICAR(hash_guardar(hash, claves[i], dato));
+	}
+	VERIFICAR(contexto.pedidos < CANT / 100);
+	for(size_t i = 0; i < CANT; i++)
+		VERIFICAR(*(long*)hash_obtener(hash, claves[i]) == (long)i);
+	hash_destruir(hash);
+	VERIFICAR(contexto.pedidos == contexto.liberados);
+}
+
+/* Un asignador sin liberar, que reparte un bloque que el usuario libera
+ * entero al final.
+ */
+static void prueba_sin_liberar(void){
+	contexto_t contexto = {0};
+	contexto.bloque = malloc(TAM_BLOQUE);
+	VERIFICAR(contexto.bloque);
+	hash_opciones_t opciones = {0};
+	opciones.asignador.pedir = pedir;
+	opciones.asignador.ctx = &contexto;
+	hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+	VERIFICAR(hash);
+	usar(hash, false);
+	for(size_t i = CANT / 2; i < CANT; i++)
+		VERIFICAR(hash_obtener(hash, claves[i]) == (i % 3 ? &valores[i] : NULL));
+	hash_destruir(hash);
+	free(contexto.bloque);
+}
+
+/* Falla un pedido distinto en cada vuelta: guardar devuelve false sin
+ * guardar la clave, y lo demas queda como estaba.
+ */
+static void prueba_fallas(void){
+	for(size_t fallar_en = 1; fallar_en < 200; fallar_en += 7){
+		for(int arena = 0; arena < 2; arena++){
+			contexto_t contexto = {0};
+			contexto.fallar_en = fallar_en;
+			hash_opciones_t opciones = {0};
+			opciones.asignador.pedir = pedir;
+			opciones.asignador.liberar = liberar;
+			opciones.asignador.ctx = &contexto;
+			opciones.arena = arena;
+			opciones.politica.tam_inicial = 8;
+			hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+			if(!hash){
+				VERIFICAR(contexto.pedidos == contexto.liberados);
+				continue;
+			}
+			static bool guardada[CANT];
+			size_t cant = 0;
+			for(size_t i = 0; i < 2000; i++){
+				guardada[i] = hash_guardar(hash, claves[i], &valores[i]);
+				cant += guardada[i];
+			}
+			VERIFICAR(hash_cantidad(hash) == cant && cant >= 1999);
+			for(size_t i = 0; i < 2000; i++)
+				VERIFICAR(hash_obtener(hash, claves[i]) == (guardada[i] ? &valores[i] : NULL));
+			hash_destruir(hash);
+			VERIFICAR(contexto.pedidos == contexto.liberados);
+		}
+	}
+}
+
+int main(void){
+	for(size_t i = 0; i < CANT; i++){
+		snprintf(claves[i], LARGO_CLAVE, i % 2 ? "c%zu" : "una-clave-bastante-mas-larga-%zu", i);
+		valores[i] = (long)i;
+	}
+
+	prueba_arena();
+	prueba_todo_liberado();
+	prueba_pocos_pedidos();
+	prueba_sin_liberar();
+	prueba_fallas();
+
+	puts("prueba_arena: OK");
+	return 0;
+}
@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../hash.h"
+#include "pruebas.h"
+
+/* Prueba del modo cache: los limites de entradas y de bytes, que una
+ * clave usada hace poco sobrevive a un desalojo, la cuenta de bytes
+ * cuando los datos cambian despues de guardarlos, y los reemplazos que
+ * agrandan el dato.
+ */
+
+#define CANT 5000
+#define LIMITE 1000
+#define LARGO_CLAVE 32
+
+static char claves[CANT][LARGO_CLAVE];
+
+static hash_estadisticas_t estadisticas(const hash_t* hash){
+	hash_estadisticas_t e;
+	hash_estadisticas(hash, &e);
+	return e;
+}
+
+static size_t largo_dato(const void* dato){
+	return strlen(dato);
+}
+
+static char* cadena_nueva(const char* cadena){
+	char* copia = malloc(strlen(cadena) + 1);
+	VERIFICAR(copia);
+	strcpy(copia, cadena);
+	return copia;
+}
+
+static void prueba_entradas(bool incremental){
+	hash_opciones_t opciones = {0};
+	opciones.cache_entradas = LIMITE;
+	opciones.rehash_incremental = incremental;
+	hash_t* hash = hash_crear_con_opciones(free, &opciones);
+	VERIFICAR(hash);
+	for(size_t i = 0; i < CANT; i++){
+		VERIFICAR(hash_guardar(hash, claves[i], cadena_nueva(claves[i])));
+		VERIFICAR(hash_cantidad(hash) <= LIMITE);
+		// La primera clave se usa siempre antes de guardar otra, asi que
+		// nunca es la que se desaloja.
+		VERIFICAR(hash_obtener(hash, claves[0]) != NULL);
+	}
+	VERIFICAR(hash_cantidad(hash) == LIMITE);
+	VERIFICAR(estadisticas(hash).desalojos == CANT - LIMITE);
+	// Las mas nuevas siguen, y ninguna clave tiene un dato ajeno.
+	VERIFICAR(hash_pertenece(hash, claves[CANT - 1]));
+	for(size_t i = 0; i < CANT; i++){
+		char* dato = hash_obtener(hash, claves[i]);
+		VERIFICAR(!dato || strcmp(dato, claves[i]) == 0);
+	}
+	hash_destruir(hash);
+}
+
+static void prueba_bytes(void){
+	hash_opciones_t opciones = {0};
+	opciones.cache_bytes = 20 * LIMITE;
+	opciones.bytes_dato = largo_dato;
+	hash_t* hash = hash_crear_con_opciones(free, &opciones);
+	VERIFICAR(hash);
+	for(size_t i = 0; i < CANT; i++){
+		VERIFICAR(hash_guardar(hash, claves[i], cadena_nueva("un-dato-de-largo-mediano")));
+		// Cambiar el dato despues de guardarlo no descuadra la cuenta: al
+		// sacar la clave se resta lo que sumo al guardarla.
+		void** dato = hash_obtener_ptr(hash, claves[i]);
+		VERIFICAR(dato);
+		if(i % 2){
+			free(*dato);
+			*dato = cadena_nueva("x");
+		}else{
+			((char*)*dato)[3] = '\0';
+		}
+		VERIFICAR(estadisticas(hash).bytes_cache <= opciones.cache_bytes);
+	}
+	VERIFICAR(estadisticas(hash).desalojos > 0);
+	for(size_t i = 0; i < CANT; i++)
+		free(hash_borrar(hash, claves[i]));
+	VERIFICAR(hash_cantidad(hash) == 0);
+	VERIFICAR(estadisticas(hash).bytes_cache == 0);
+	hash_destruir(hash);
+}
+
+/* Reemplazar el dato de una clave por uno mas grande desaloja otras
+ * claves hasta que entre, nunca la que se reemplaza, y lo que no entra
+ * en cache_bytes no se guarda.
+ */
+static void prueba_reemplazos(void){
+	hash_opciones_t opciones = {0};
+	opciones.cache_bytes = 1000;
+	opciones.bytes_dato = largo_dato;
+	hash_t* hash = hash_crear_con_opciones(free, &opciones);
+	VERIFICAR(hash);
+	char grande[1001];
+	for(size_t vuelta = 0; vuelta < 3; vuelta++){
+		for(size_t i = 0; i < 100; i++)
+			VERIFICAR(hash_guardar(hash, claves[i], cadena_nueva("d")));
+		const char* clave = claves[vuelta];
+		size_t largo_clave = strlen(clave);
+		// El dato crece hasta llenar cache_bytes con la clave sola.
+		for(size_t largo = 1; largo_clave + 1 + largo <= opciones.cache_bytes; largo += 37){
+			memset(grande, 'g', largo);
+			grande[largo] = '\0';
+			VERIFICAR(hash_guardar(hash, clave, cadena_nueva(grande)));
+			VERIFICAR(strcmp(hash_obtener(hash, clave), grande) == 0);
+			VERIFICAR(estadisticas(hash).bytes_cache <= opciones.cache_bytes);
+		}
+		size_t largo = opciones.cache_bytes - largo_clave - 1;
+		memset(grande, 'g', largo);
+		grande[largo] = '\0';
+		VERIFICAR(hash_guardar(hash, clave, cadena_nueva(grande)));
+		VERIFICAR(hash_cantidad(hash) == 1 && estadisticas(hash).bytes_cache == opciones.cache_bytes);
+
+		// Un byte mas no entra: ni al reemplazar ni con una clave nueva.
+		// El dato sigue siendo del usuario y el hash queda igual.
+		grande[largo] = 'g';
+		grande[largo + 1] = '\0';
+		char* rechazado = cadena_nueva(grande);
+		VERIFICAR(!hash_guardar(hash, clave, rechazado));
+		VERIFICAR(strlen(hash_obtener(hash, clave)) == largo);
+		free(rechazado);
+		memset(grande, 'g', opciones.cache_bytes);
+		grande[opciones.cache_bytes] = '\0';
+		rechazado = cadena_nueva(grande);
+		VERIFICAR(!hash_guardar(hash, "", rechazado));
+		VERIFICAR(!hash_pertenece(hash, ""));
+		VERIFICAR(hash_cantidad(hash) == 1 && estadisticas(hash).bytes_cache == opciones.cache_bytes);
+		free(rechazado);
+	}
+	hash_destruir(hash);
+}
+
+int main(void){
+	for(size_t i = 0; i < CANT; i++)
+		snprintf(claves[i], LARGO_CLAVE, i % 2 ? "c%zu" : "una-clave-larga-%zu", i);
+
+	prueba_entradas(false);
+	prueba_entradas(true);
+	prueba_bytes();
+	prueba_reemplazos();
+
+	puts("prueba_cache: OK");
+	return 0;
+}
@@ -0,0 +1,151 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../hash.h"
+#include "pruebas.h"
+
+/* Prueba de las primitivas de claves binarias: claves con '\0' en el
+ * medio, la clave vacia, claves que son prefijo de otras, largos a los
+ * dos lados del limite de las claves cortas de hash.c, las variantes _nh
+ * y el largo que devuelve el iterador.
+ */
+
+#define CANT 5000
+#define LARGO_MAXIMO 40
+
+static unsigned char claves[CANT][LARGO_MAXIMO];
+static size_t largos[CANT];
+static long valores[CANT];
+
+static uint64_t estado = 271828;
+
+static size_t azar(size_t n){
+	estado ^= estado << 13;
+	estado ^= estado >> 7;
+	estado ^= estado << 17;
+	return (size_t)(estado % n);
+}
+
+/* Arma claves distintas de largo 0 a LARGO_MAXIMO - 1 con bytes al azar
+ * (incluido el 0): los primeros bytes son el indice, y las de largo menor
+ * a 2 son las unicas de ese largo. Las primeras son prefijos de otras.
+ */
+static void armar_claves(void){
+	for(size_t i = 0; i < CANT; i++){
+		largos[i] = i < 2 ? i : 2 + azar(LARGO_MAXIMO - 2);
+		for(size_t j = 0; j < largos[i]; j++)
+			claves[i][j] = (unsigned char)azar(4) ? (unsigned char)azar(256) : 0;
+		if(i >= 2){
+			claves[i][0] = (unsigned char)(i & 0xff);
+			claves[i][1] = (unsigned char)(i >> 8);
+		}
+		valores[i] = (long)i;
+	}
+	// Prefijos: la 2 es la 3 sin su ultimo byte.
+	largos[2] = 10;
+	largos[3] = 11;
+	claves[2][1] = 0xff;
+	memcpy(claves[3], claves[2], largos[2]);
+}
+
+static void prueba_binarias(void){
+	hash_t* hash = hash_crear(NULL);
+	VERIFICAR(hash);
+	for(size_t i = 0; i < CANT; i++)
+		VERIFICAR(hash_guardar_n(hash, claves[i], largos[i], &valores[i]));
+	VERIFICAR(hash_cantidad(hash) == CANT);
+	for(size_t i = 0; i < CANT; i++){
+		VERIFICAR(hash_obtener_n(hash, claves[i], largos[i]) == &valores[i]);
+		VERIFICAR(hash_pertenece_n(hash, claves[i], largos[i]));
+		uint64_t h = hash_calcular(hash, claves[i], largos[i]);
+		VERIFICAR(hash_obtener_nh(hash, claves[i], largos[i], h) == &valores[i]);
+		VERIFICAR(hash_pertenece_nh(hash, claves[i], largos[i], h));
+		void** ptr = hash_obtener_ptr_nh(hash, claves[i], largos[i], h);
+		VERIFICAR(ptr && *ptr == &valores[i]);
+	}
+
+	// El iterador devuelve cada clave con su largo y un '\0' extra.
+	size_t vistas = 0;
+	hash_iter_t iter;
+	for(hash_iter_inicializar(&iter, hash); !hash_iter_al_final(&iter); hash_iter_avanzar(&iter)){
+		size_t largo;
+		const char* clave = hash_iter_ver_actual_n(&iter, &largo);
+		long i = *(long*)hash_iter_ver_dato(&iter);
+		VERIFICAR(largo == largos[i] && memcmp(clave, claves[i], largo) == 0 && clave[largo] == '\0');
+		vistas++;
+	}
+	VERIFICAR(vistas == CANT);
+
+	// Borrar con las variantes _n y _nh, alternadas.
+	for(size_t i = 0; i < CANT; i += 2){
+		if(i % 4)
+			VERIFICAR(hash_borrar_n(hash, claves[i], largos[i]) == &valores[i]);
+		else
+			VERIFICAR(hash_borrar_nh(hash, claves[i], largos[i], hash_calcular(hash, claves[i], largos[i])) == &valores[i]);
+	}
+	for(size_t i = 0; i < CANT; i++)
+		VERIFICAR(hash_pertenece_n(hash, claves[i], largos[i]) == (i % 2 == 1));
+	VERIFICAR(hash_cantidad(hash) == CANT / 2);
+	hash_destruir(hash);
+}
+
+/* Una clave de hash_guardar es la misma que la de largo strlen con
+ * hash_guardar_n, y el '\0' del medio distingue claves.
+ */
+static void prueba_equivalencias(void){
+	hash_t* hash = hash_crear(NULL);
+	VERIFICAR(hash);
+	long a = 1, b = 2, c = 3, d = 4;
+	VERIFICAR(hash_guardar(hash, "abc", &a));
+	VERIFICAR(hash_obtener_n(hash, "abc", 3) == &a);
+	VERIFICAR(hash_guardar_n(hash, "abc\0def", 7, &b));
+	VERIFICAR(hash_guardar_n(hash, "abc\0deg", 7, &c));
+	VERIFICAR(hash_guardar_n(hash, "", 0, &d));
+	VERIFICAR(hash_cantidad(hash) == 4);
+	VERIFICAR(hash_obtener(hash, "abc") == &a);
+	VERIFICAR(hash_obtener(hash, "") == &d);
+	VERIFICAR(hash_obtener_n(hash, "abc\0def", 7) == &b);
+	VERIFICAR(hash_obtener_n(hash, "abc\0deg", 7) == &c);
+	VERIFICAR(!hash_obtener_n(hash, "abc\0de", 6) && !hash_obtener_n(hash, "abc\0", 4));
+	VERIFICAR(hash_borrar(hash, "abc") == &a);
+	VERIFICAR(hash_obtener_n(hash, "abc\0def", 7) == &b);
+	hash_destruir(hash);
+}
+
+/* Largos a los dos lados de LARGO_CLAVE_CORTA (15) de hash.c, que se
+ * guardan dentro o fuera del campo, con un byte que cambia al final.
+ */
+static void prueba_largos_limite(void){
+	hash_t* hash = hash_crear(NULL);
+	VERIFICAR(hash);
+	char clave[32];
+	memset(clave, 'x', sizeof(clave));
+	for(size_t largo = 12; largo < 20; largo++){
+		for(int ultimo = 0; ultimo < 3; ultimo++){
+			clave[largo - 1] = (char)ultimo;
+			VERIFICAR(hash_guardar_n(hash, clave, largo, &valores[largo * 3 + (size_t)ultimo]));
+		}
+		clave[largo - 1] = 'x';
+	}
+	VERIFICAR(hash_cantidad(hash) == 8 * 3);
+	for(size_t largo = 12; largo < 20; largo++){
+		for(int ultimo = 0; ultimo < 3; ultimo++){
+			clave[largo - 1] = (char)ultimo;
+			VERIFICAR(hash_obtener_n(hash, clave, largo) == &valores[largo * 3 + (size_t)ultimo]);
+		}
+		clave[largo - 1] = 'x';
+	}
+	hash_destruir(hash);
+}
+
+int main(void){
+	armar_claves();
+
+	prueba_binarias();
+	prueba_equivalencias();
+	prueba_largos_limite();
+
+	puts("prueba_claves_n: OK");
+	return 0;
+}
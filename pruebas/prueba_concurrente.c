@@ -0,0 +1,145 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../hash_concurrente.h"
+#include "pruebas.h"
+
+/* Prueba de hash_concurrente: varios hilos guardan, actualizan y borran
+ * claves propias mientras otros leen todas, con segmentos comunes, en
+ * modo cache y con vencimientos (donde las busquedas modifican el hash).
+ */
+
+#define HILOS 4
+#define POR_HILO 2000
+#define CANT (HILOS * POR_HILO)
+#define LARGO_CLAVE 32
+
+static char claves[CANT][LARGO_CLAVE];
+static long valores[CANT];
+
+typedef struct trabajo{
+	hash_concurrente_t* hash;
+	size_t desde;
+	size_t hasta;
+} trabajo_t;
+
+typedef struct leido{
+	const void* dato;
+	long valor;
+} leido_t;
+
+static void sumar_uno(void** dato, void* extra){
+	(void)extra;
+	long* valor = *dato;
+	(*valor)++;
+}
+
+/* Guarda las claves del trabajo, las incrementa con visitar y borra las
+ * pares.
+ */
+static void* escribir(void* arg){
+	trabajo_t* trabajo = arg;
+	for(size_t i = trabajo->desde; i < trabajo->hasta; i++){
+		valores[i] = (long)i;
+		VERIFICAR(hash_concurrente_guardar(trabajo->hash, claves[i], &valores[i]));
+	}
+	for(size_t i = trabajo->desde; i < trabajo->hasta; i++)
+		VERIFICAR(hash_concurrente_visitar(trabajo->hash, claves[i], sumar_uno, NULL));
+	for(size_t i = trabajo->desde; i < trabajo->hasta; i += 2)
+		VERIFICAR(hash_concurrente_borrar(trabajo->hash, claves[i]) == &valores[i]);
+	return NULL;
+}
+
+/* Copia el dato y su valor, que otro hilo puede estar cambiando. */
+static void copiar(const void* dato, void* extra){
+	leido_t* leido = extra;
+	leido->dato = dato;
+	leido->valor = *(const long*)dato;
+}
+
+/* Lee todas las claves varias veces. Lo que encuentra tiene que ser el
+ * dato de la clave, sumado o no.
+ */
+static void* leer(void* arg){
+	hash_concurrente_t* hash = arg;
+	for(int vuelta = 0; vuelta < 4; vuelta++){
+		for(size_t i = 0; i < CANT; i++){
+			leido_t leido;
+			if(hash_concurrente_obtener(hash, claves[i], copiar, &leido))
+				VERIFICAR(leido.dato == &valores[i] && (leido.valor == (long)i || leido.valor == (long)i + 1));
+			hash_concurrente_pertenece(hash, claves[i]);
+		}
+	}
+	return NULL;
+}
+
+static void prueba_escrituras_y_lecturas(const hash_opciones_t* opciones){
+	hash_concurrente_t* hash = hash_concurrente_crear(NULL, opciones, 8);
+	VERIFICAR(hash);
+	pthread_t escritores[HILOS], lectores[HILOS];
+	trabajo_t trabajos[HILOS];
+	for(size_t t = 0; t < HILOS; t++){
+		trabajos[t] = (trabajo_t){hash, t * POR_HILO, (t + 1) * POR_HILO};
+		VERIFICAR(pthread_create(&escritores[t], NULL, escribir, &trabajos[t]) == 0);
+		VERIFICAR(pthread_create(&lectores[t], NULL, leer, hash) == 0);
+	}
+	for(size_t t = 0; t < HILOS; t++){
+		pthread_join(escritores[t], NULL);
+		pthread_join(lectores[t], NULL);
+	}
+	VERIFICAR(hash_concurrente_cantidad(hash) == CANT / 2);
+	for(size_t i = 0; i < CANT; i++){
+		leido_t leido;
+		bool esta = hash_concurrente_obtener(hash, claves[i], copiar, &leido);
+		if(i % 2 == 0){
+			VERIFICAR(!esta && !hash_concurrente_pertenece(hash, claves[i]));
+		}else{
+			VERIFICAR(esta && leido.dato == &valores[i] && leido.valor == (long)i + 1);
+		}
+	}
+	hash_concurrente_destruir(hash);
+}
+
+/* Con las busquedas que modifican el hash: solo lectores, sobre un hash
+ * ya cargado.
+ */
+static void prueba_lecturas_que_modifican(const hash_opciones_t* opciones){
+	hash_concurrente_t* hash = hash_concurrente_crear(NULL, opciones, 2);
+	VERIFICAR(hash);
+	for(size_t i = 0; i < CANT; i++)
+		VERIFICAR(hash_concurrente_guardar(hash, claves[i], &valores[i]));
+	pthread_t lectores[HILOS];
+	for(size_t t = 0; t < HILOS; t++)
+		VERIFICAR(pthread_create(&lectores[t], NULL, leer, hash) == 0);
+	for(size_t t = 0; t < HILOS; t++)
+		pthread_join(lectores[t], NULL);
+	hash_concurrente_destruir(hash);
+}
+
+static uint64_t ahora;
+
+static uint64_t reloj(void){
+	return __atomic_load_n(&ahora, __ATOMIC_RELAXED);
+}
+
+int main(void){
+	for(size_t i = 0; i < CANT; i++)
+		snprintf(claves[i], LARGO_CLAVE, i % 2 ? "c%zu" : "una-clave-larga-%zu", i);
+
+	prueba_escrituras_y_lecturas(NULL);
+
+	hash_opciones_t opciones = {0};
+	opciones.cache_entradas = CANT;
+	prueba_escrituras_y_lecturas(&opciones);
+	opciones.cache_entradas = CANT / 4;
+	prueba_lecturas_que_modifican(&opciones);
+
+	opciones.cache_entradas = 0;
+	opciones.vencimientos = true;
+	opciones.reloj = reloj;
+	prueba_lecturas_que_modifican(&opciones);
+
+	puts("prueba_concurrente: OK");
+	return 0;
+}
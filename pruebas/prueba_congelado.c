@@ -0,0 +1,125 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../hash.h"
+#include "../hash_congelado.h"
+#include "pruebas.h"
+
+/* Prueba de hash_congelado: congelar un hash comun, uno vacio, uno de
+ * claves prestadas sin '\0' y uno con claves vencidas, que no se tiene
+ * que modificar al congelarlo.
+ */
+
+#define CANT 5000
+#define LARGO_CLAVE 32
+
+static char claves[CANT][LARGO_CLAVE];
+static long valores[CANT];
+
+static bool contar(const char* clave, void* dato, void* extra){
+	VERIFICAR(strcmp(clave, claves[*(long*)dato]) == 0);
+	(*(size_t*)extra)++;
+	return true;
+}
+
+static void prueba_congelar(void){
+	hash_t* hash = hash_crear(NULL);
+	VERIFICAR(hash);
+	for(size_t i = 0; i < CANT; i++)
+		VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+	hash_congelado_t* congelado = hash_congelar(hash);
+	hash_destruir(hash);
+	VERIFICAR(congelado && hash_congelado_cantidad(congelado) == CANT);
+	for(size_t i = 0; i < CANT; i++){
+		VERIFICAR(hash_congelado_obtener(congelado, claves[i]) == &valores[i]);
+		VERIFICAR(hash_congelado_pertenece_n(congelado, claves[i], strlen(claves[i])));
+	}
+	VERIFICAR(!hash_congelado_pertenece(congelado, "no-esta"));
+	VERIFICAR(!hash_congelado_obtener(congelado, ""));
+	size_t visitadas = 0;
+	hash_congelado_iterar(congelado, contar, &visitadas);
+	VERIFICAR(visitadas == CANT);
+	hash_congelado_destruir(congelado);
+}
+
+static bool no_visitar(const char* clave, void* dato, void* extra){
+	(void)clave; (void)dato; (void)extra;
+	VERIFICAR(false);
+	return false;
+}
+
+static void prueba_vacio(void){
+	hash_t* hash = hash_crear(NULL);
+	VERIFICAR(hash);
+	hash_congelado_t* congelado = hash_congelar(hash);
+	hash_destruir(hash);
+	VERIFICAR(congelado && hash_congelado_cantidad(congelado) == 0);
+	VERIFICAR(!hash_congelado_pertenece(congelado, "a"));
+	VERIFICAR(!hash_congelado_obtener_n(congelado, "", 0));
+	hash_congelado_iterar(congelado, no_visitar, NULL);
+	hash_congelado_destruir(congelado);
+}
+
+/* Cada clave prestada se pide con su largo justo, asi ASan detecta si se
+ * lee el '\0' que no tiene.
+ */
+static void prueba_claves_prestadas(void){
+	hash_opciones_t opciones = {0};
+	opciones.claves_prestadas = true;
+	hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+	VERIFICAR(hash);
+	char* prestadas[CANT];
+	for(size_t i = 0; i < CANT; i++){
+		size_t largo = strlen(claves[i]);
+		prestadas[i] = malloc(largo);
+		VERIFICAR(prestadas[i]);
+		memcpy(prestadas[i], claves[i], largo);
+		VERIFICAR(hash_guardar_n(hash, prestadas[i], largo, &valores[i]));
+	}
+	hash_congelado_t* congelado = hash_congelar(hash);
+	hash_destruir(hash);
+	for(size_t i = 0; i < CANT; i++)
+		free(prestadas[i]);
+	VERIFICAR(congelado);
+	for(size_t i = 0; i < CANT; i++)
+		VERIFICAR(hash_congelado_obtener(congelado, claves[i]) == &valores[i]);
+	hash_congelado_destruir(congelado);
+}
+
+static uint64_t ahora;
+
+static uint64_t reloj(void){
+	return ahora;
+}
+
+static void prueba_vencidas(void){
+	hash_opciones_t opciones = {0};
+	opciones.vencimientos = true;
+	opciones.reloj = reloj;
+	hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+	VERIFICAR(hash);
+	for(size_t i = 0; i < CANT; i++)
+		VERIFICAR(hash_guardar_ttl(hash, claves[i], &valores[i], 10));
+	ahora = 100;
+	hash_congelado_t* congelado = hash_congelar(hash);
+	VERIFICAR(congelado && hash_congelado_cantidad(congelado) == CANT);
+	VERIFICAR(hash_cantidad(hash) == CANT);
+	hash_congelado_destruir(congelado);
+	hash_destruir(hash);
+}
+
+int main(void){
+	for(size_t i = 0; i < CANT; i++){
+		snprintf(claves[i], LARGO_CLAVE, i % 2 ? "c%zu" : "una-clave-larga-%zu", i);
+		valores[i] = (long)i;
+	}
+
+	prueba_congelar();
+	prueba_vacio();
+	prueba_claves_prestadas();
+	prueba_vencidas();
+
+	puts("prueba_congelado: OK");
+	return 0;
+}
@@ -0,0 +1,109 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../hash_especializado.h"
+#include "pruebas.h"
+
+/* Prueba de las variantes planas de hash_especializado: hash_set_t,
+ * hash_u64_t y hash_ptr_t, con claves suficientes para redimensionar y
+ * borrados que desplazan campos.
+ */
+
+#define CANT 20000
+
+static long valores[CANT];
+
+static bool contar_set(const char* clave, void* extra){
+	VERIFICAR(strncmp(clave, "elemento-", 9) == 0);
+	(*(size_t*)extra)++;
+	return true;
+}
+
+static bool sumar_u64(uint64_t clave, void* dato, void* extra){
+	VERIFICAR(*(long*)dato == (long)(clave / 7));
+	*(uint64_t*)extra += clave;
+	return true;
+}
+
+static void prueba_set(void){
+	hash_set_t* set = hash_set_crear();
+	VERIFICAR(set);
+	char clave[32];
+	for(size_t i = 0; i < CANT; i++){
+		snprintf(clave, sizeof(clave), "elemento-%zu", i);
+		VERIFICAR(hash_set_guardar(set, clave));
+	}
+	// Guardar una que ya esta no la duplica.
+	VERIFICAR(hash_set_guardar(set, "elemento-0"));
+	VERIFICAR(hash_set_cantidad(set) == CANT);
+	for(size_t i = 0; i < CANT; i += 2){
+		snprintf(clave, sizeof(clave), "elemento-%zu", i);
+		VERIFICAR(hash_set_borrar(set, clave));
+	}
+	VERIFICAR(!hash_set_borrar(set, "elemento-0"));
+	for(size_t i = 0; i < CANT; i++){
+		snprintf(clave, sizeof(clave), "elemento-%zu", i);
+		VERIFICAR(hash_set_pertenece(set, clave) == (i % 2 == 1));
+	}
+	size_t visitados = 0;
+	hash_set_iterar(set, contar_set, &visitados);
+	VERIFICAR(visitados == CANT / 2);
+	hash_set_destruir(set);
+}
+
+static void prueba_u64(void){
+	hash_u64_t* hash = hash_u64_crear(NULL);
+	VERIFICAR(hash);
+	VERIFICAR(hash_u64_reservar(hash, CANT));
+	uint64_t suma = 0;
+	for(size_t i = 0; i < CANT; i++){
+		valores[i] = (long)i;
+		VERIFICAR(hash_u64_guardar(hash, (uint64_t)i * 7, &valores[i]));
+		suma += (uint64_t)i * 7;
+	}
+	VERIFICAR(hash_u64_cantidad(hash) == CANT);
+	// La clave 0 es una clave mas.
+	VERIFICAR(hash_u64_obtener(hash, 0) == &valores[0]);
+	VERIFICAR(!hash_u64_pertenece(hash, 1));
+	uint64_t visitada = 0;
+	hash_u64_iterar(hash, sumar_u64, &visitada);
+	VERIFICAR(visitada == suma);
+	for(size_t i = 0; i < CANT; i += 3)
+		VERIFICAR(hash_u64_borrar(hash, (uint64_t)i * 7) == &valores[i]);
+	for(size_t i = 0; i < CANT; i++)
+		VERIFICAR(hash_u64_obtener(hash, (uint64_t)i * 7) == (i % 3 ? &valores[i] : NULL));
+	hash_u64_destruir(hash);
+}
+
+static void prueba_ptr(void){
+	hash_ptr_t* hash = hash_ptr_crear(free);
+	VERIFICAR(hash);
+	for(size_t i = 0; i < CANT; i++){
+		long* dato = malloc(sizeof(long));
+		VERIFICAR(dato);
+		*dato = (long)i;
+		VERIFICAR(hash_ptr_guardar(hash, &valores[i], dato));
+	}
+	// Reemplazar destruye el dato anterior.
+	long* otro = malloc(sizeof(long));
+	VERIFICAR(otro);
+	*otro = -1;
+	VERIFICAR(hash_ptr_guardar(hash, &valores[0], otro));
+	VERIFICAR(hash_ptr_cantidad(hash) == CANT);
+	VERIFICAR(hash_ptr_obtener(hash, &valores[0]) == otro);
+	for(size_t i = 1; i < CANT; i++)
+		VERIFICAR(*(long*)hash_ptr_obtener(hash, &valores[i]) == (long)i);
+	free(hash_ptr_borrar(hash, &valores[1]));
+	VERIFICAR(!hash_ptr_pertenece(hash, &valores[1]) && hash_ptr_cantidad(hash) == CANT - 1);
+	hash_ptr_destruir(hash);
+}
+
+int main(void){
+	prueba_set();
+	prueba_u64();
+	prueba_ptr();
+
+	puts("prueba_especializado: OK");
+	return 0;
+}
@@ -0,0 +1,148 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../hash.h"
+#include "pruebas.h"
+
+/* Prueba de hash_estadisticas: cantidad, tamaño y carga, el histograma,
+ * el sondeo maximo con una funcion de hashing constante, los contadores
+ * de busquedas del modo cache, los bytes de las claves y la cantidad de
+ * redimensiones.
+ */
+
+#define CANT 5000
+#define LARGO_CLAVE 32
+
+static char claves[CANT][LARGO_CLAVE];
+static long valores[CANT];
+
+static hash_estadisticas_t estadisticas(const hash_t* hash){
+	hash_estadisticas_t e;
+	hash_estadisticas(hash, &e);
+	return e;
+}
+
+static uint64_t constante(const void* clave, size_t largo, uint64_t semilla){
+	(void)clave; (void)largo; (void)semilla;
+	return 0;
+}
+
+static void prueba_basicas(void){
+	hash_t* hash = hash_crear(NULL);
+	VERIFICAR(hash);
+	hash_estadisticas_t e = estadisticas(hash);
+	VERIFICAR(e.cantidad == 0 && e.tam > 0 && e.carga == 0 && e.max_sondeo == 0);
+	for(size_t i = 0; i < CANT; i++)
+		VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+	e = estadisticas(hash);
+	VERIFICAR(e.cantidad == CANT && e.carga == (double)CANT / (double)e.tam);
+	VERIFICAR(e.bytes_tabla > 0 && e.bytes_claves > 0);
+	// hash.c cuenta posiciones por largo de lista; hash_cerrado.c, campos
+	// por distancia.
+	size_t suma = 0;
+	for(size_t i = 0; i < HASH_LARGOS; i++)
+		suma += e.histograma[i];
+	VERIFICAR(suma == e.tam || suma == e.cantidad);
+	VERIFICAR(e.max_sondeo >= 1 && e.max_sondeo < CANT);
+	VERIFICAR(e.ns_redimension >= e.max_ns_redimension);
+	// Sin modo cache ni contadores no se cuentan las busquedas.
+	hash_obtener(hash, claves[0]);
+	e = estadisticas(hash);
+	VERIFICAR(e.desalojos == 0 && e.vencidas == 0);
+	hash_destruir(hash);
+}
+
+/* Con todas las claves en la misma posicion, encontrar la ultima mira
+ * todos los campos.
+ */
+static void prueba_sondeo_constante(void){
+	hash_opciones_t opciones = {0};
+	opciones.funcion = constante;
+	hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+	VERIFICAR(hash);
+	for(size_t n = 1; n <= 300; n++){
+		VERIFICAR(hash_guardar(hash, claves[n - 1], &valores[n - 1]));
+		VERIFICAR(estadisticas(hash).max_sondeo == n);
+	}
+	hash_destruir(hash);
+}
+
+static void prueba_contadores_cache(void){
+	hash_opciones_t opciones = {0};
+	opciones.cache_entradas = CANT;
+	hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+	VERIFICAR(hash);
+	for(size_t i = 0; i < CANT / 2; i++)
+		VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+	uint64_t aciertos = 0, fallos = 0;
+	for(size_t i = 0; i < CANT; i++){
+		bool esta = i < CANT / 2;
+		if(i % 2)
+			VERIFICAR(hash_obtener(hash, claves[i]) == (esta ? &valores[i] : NULL));
+		else
+			VERIFICAR(hash_pertenece(hash, claves[i]) == esta);
+		aciertos += esta;
+		fallos += !esta;
+	}
+	hash_estadisticas_t e = estadisticas(hash);
+	VERIFICAR(e.aciertos == aciertos && e.fallos == fallos);
+	VERIFICAR(e.busquedas == e.aciertos + e.fallos);
+	VERIFICAR(e.desalojos == 0);
+	hash_destruir(hash);
+}
+
+/* Con claves prestadas el hash no tiene claves propias. */
+static void prueba_bytes_claves(void){
+	hash_opciones_t opciones = {0};
+	opciones.claves_prestadas = true;
+	hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+	VERIFICAR(hash);
+	for(size_t i = 0; i < CANT; i++)
+		VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+	VERIFICAR(estadisticas(hash).bytes_claves == 0);
+	hash_destruir(hash);
+}
+
+/* Sin achicar, con factor 2, se redimensiona una vez por cada vez que se
+ * duplica el tamaño; despues de compactar, una vez mas.
+ */
+static void prueba_redimensiones(void){
+	hash_opciones_t opciones = {0};
+	opciones.politica.tam_inicial = 8;
+	opciones.politica.factor_crecimiento = 2;
+	opciones.politica.nunca_achicar = true;
+	hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+	VERIFICAR(hash);
+	VERIFICAR(estadisticas(hash).redimensiones == 0);
+	for(size_t i = 0; i < CANT; i++)
+		VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+	hash_estadisticas_t e = estadisticas(hash);
+	size_t duplicaciones = 0;
+	for(size_t tam = 8; tam < e.tam; tam *= 2)
+		duplicaciones++;
+	VERIFICAR(e.redimensiones == duplicaciones);
+	VERIFICAR(e.ns_redimension >= e.max_ns_redimension);
+	for(size_t i = 0; i < CANT - 10; i++)
+		VERIFICAR(hash_borrar(hash, claves[i]) == &valores[i]);
+	VERIFICAR(estadisticas(hash).redimensiones == duplicaciones);
+	VERIFICAR(hash_compactar(hash));
+	VERIFICAR(estadisticas(hash).redimensiones == duplicaciones + 1);
+	hash_destruir(hash);
+}
+
+int main(void){
+	for(size_t i = 0; i < CANT; i++){
+		snprintf(claves[i], LARGO_CLAVE, i % 2 ? "c%zu" : "una-clave-larga-%zu", i);
+		valores[i] = (long)i;
+	}
+
+	prueba_basicas();
+	prueba_sondeo_constante();
+	prueba_contadores_cache();
+	prueba_bytes_claves();
+	prueba_redimensiones();
+
+	puts("prueba_estadisticas: OK");
+	return 0;
+}
@@ -0,0 +1,61 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../hash_funciones.h"
+#include "pruebas.h"
+
+/* Prueba de las funciones de hashing: dos claves que chocan en CRC32C
+ * con cualquier semilla no tienen que chocar en hash_funcion_acelerada,
+ * y ninguna funcion tiene que dar colisiones de 64 bits en muchas
+ * claves cortas (lo que pasaria si el estado interno fuera mas chico).
+ */
+
+#define CANT 300000
+#define SEMILLAS 64
+
+static uint64_t valores[CANT];
+
+static int comparar(const void* a, const void* b){
+	uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+	return (x > y) - (x < y);
+}
+
+/* "abcdefgh" y "abcdefgh" ^ 0x0000000105ec76f1 tienen el mismo CRC32C
+ * sin importar el valor inicial del CRC.
+ */
+static void prueba_par_lineal(hash_funcion_t funcion){
+	unsigned char a[8], b[8];
+	memcpy(a, "abcdefgh", 8);
+	uint64_t v, diferencia = 0x0000000105ec76f1ULL;
+	memcpy(&v, a, 8);
+	v ^= diferencia;
+	memcpy(b, &v, 8);
+	for(uint64_t semilla = 1; semilla <= SEMILLAS; semilla++){
+		uint64_t s = semilla * 0x9e3779b97f4a7c15ULL;
+		VERIFICAR(funcion(a, 8, s) != funcion(b, 8, s));
+	}
+}
+
+static void prueba_sin_colisiones(hash_funcion_t funcion, uint64_t semilla){
+	for(size_t i = 0; i < CANT; i++){
+		char clave[32];
+		int largo = snprintf(clave, sizeof(clave), i % 2 ? "c%zu" : "una-clave-mas-larga-%zu", i);
+		valores[i] = funcion(clave, (size_t)largo, semilla);
+	}
+	qsort(valores, CANT, sizeof(uint64_t), comparar);
+	for(size_t i = 1; i < CANT; i++)
+		VERIFICAR(valores[i] != valores[i - 1]);
+}
+
+int main(void){
+	hash_funcion_t funciones[] = {hash_funcion_wy, hash_funcion_fnv, hash_funcion_acelerada()};
+	for(size_t i = 0; i < sizeof(funciones) / sizeof(funciones[0]); i++){
+		prueba_par_lineal(funciones[i]);
+		prueba_sin_colisiones(funciones[i], 0);
+		prueba_sin_colisiones(funciones[i], hash_semilla_aleatoria(NULL));
+	}
+
+	puts("prueba_funciones: OK");
+	return 0;
+}
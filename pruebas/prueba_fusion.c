@@ -0,0 +1,236 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../hash.h"
+#include "pruebas.h"
+
+/* Prueba de hash_construir_paralelo y hash_fusionar: con uno y varios
+ * hilos y claves repetidas, las dos politicas de fusion con opciones que
+ * permiten mover los campos y con opciones que obligan a copiarlos, y los
+ * vencimientos que pasan de un hash al otro, tambien sin memoria. Cada
+ * dato se destruye una sola vez.
+ */
+
+#define CANT 20000
+#define LARGO_CLAVE 32
+
+static char claves[CANT][LARGO_CLAVE];
+static int destruidos[2 * CANT];
+
+static uint64_t estado = 577215;
+
+static size_t azar(size_t n){
+	estado ^= estado << 13;
+	estado ^= estado >> 7;
+	estado ^= estado << 17;
+	return (size_t)(estado % n);
+}
+
+static void destruir(void* dato){
+	(*(int*)dato)++;
+}
+
+static uint64_t ahora;
+
+static uint64_t reloj(void){
+	return ahora;
+}
+
+/* Asignador que falla una vez, en el pedido numero fallar_en. */
+static size_t pedidos, fallar_en;
+
+static void* pedir(void* ctx, size_t tam){
+	(void)ctx;
+	if(++pedidos == fallar_en)
+		return NULL;
+	return malloc(tam);
+}
+
+static void liberar(void* ctx, void* ptr){
+	(void)ctx;
+	free(ptr);
+}
+
+static void verificar_destruidos(size_t cant){
+	for(size_t i = 0; i < cant; i++)
+		VERIFICAR(destruidos[i] == 1);
+}
+
+/* Un lote de 2 * CANT claves con repetidas, cuyo dato es su contador:
+ * queda el de la ultima aparicion de cada clave.
+ */
+static void prueba_construir(void){
+	static const char* lote[2 * CANT];
+	static void* datos[2 * CANT];
+	static size_t indices[2 * CANT];
+	static long ultima[CANT];
+	size_t hilos[] = {1, 4, 8};
+	for(size_t k = 0; k < sizeof(hilos) / sizeof(hilos[0]); k++){
+		memset(destruidos, 0, sizeof(destruidos));
+		for(size_t i = 0; i < CANT; i++)
+			ultima[i] = -1;
+		for(size_t j = 0; j < 2 * CANT; j++){
+			size_t i = azar(CANT);
+			lote[j] = claves[i];
+			indices[j] = i;
+			datos[j] = &destruidos[j];
+			ultima[i] = (long)j;
+		}
+		hash_t* hash = hash_construir_paralelo(lote, datos, 2 * CANT, hilos[k], destruir, NULL);
+		VERIFICAR(hash);
+		size_t cant = 0;
+		for(size_t i = 0; i < CANT; i++){
+			VERIFICAR(hash_obtener(hash, claves[i]) == (ultima[i] < 0 ? NULL : datos[ultima[i]]));
+			cant += ultima[i] >= 0;
+		}
+		VERIFICAR(hash_cantidad(hash) == cant);
+		// Los repetidos ya se destruyeron, y los que quedaron todavia no.
+		for(size_t j = 0; j < 2 * CANT; j++)
+			VERIFICAR(destruidos[j] == ((long)j != ultima[indices[j]]));
+		hash_destruir(hash);
+		verificar_destruidos(2 * CANT);
+	}
+	// Un lote vacio da un hash vacio.
+	hash_t* hash = hash_construir_paralelo(NULL, NULL, 0, 4, destruir, NULL);
+	VERIFICAR(hash && hash_cantidad(hash) == 0);
+	hash_destruir(hash);
+}
+
+/* Opciones de destino que permiten mover los campos de origen (las de
+ * origen son las predeterminadas) o que obligan a copiarlos.
+ */
+enum{ MOVER, OTRA_SEMILLA, ARENA, CACHE, MODOS };
+
+static hash_t* crear(int modo){
+	hash_opciones_t opciones = {0};
+	opciones.semilla = modo == OTRA_SEMILLA ? 12345 : 0;
+	opciones.arena = modo == ARENA;
+	opciones.cache_entradas = modo == CACHE ? 4 * CANT : 0;
+	return hash_crear_con_opciones(destruir, &opciones);
+}
+
+/* Destino tiene las claves [0, 2/3 CANT) con datos en la primera mitad
+ * de destruidos y origen las de [1/3 CANT, CANT) con datos en la segunda.
+ */
+static void prueba_fusionar(void){
+	for(int modo = 0; modo < MODOS; modo++){
+		for(int p = 0; p < 2; p++){
+			hash_fusion_t politica = p ? HASH_FUSION_SOBREESCRIBIR : HASH_FUSION_UNION;
+			memset(destruidos, 0, sizeof(destruidos));
+			hash_t* destino = crear(modo);
+			hash_t* origen = crear(MOVER);
+			VERIFICAR(destino && origen);
+			size_t tercio = CANT / 3;
+			for(size_t i = 0; i < 2 * tercio; i++)
+				VERIFICAR(hash_guardar(destino, claves[i], &destruidos[i]));
+			for(size_t i = tercio; i < CANT; i++)
+				VERIFICAR(hash_guardar(origen, claves[i], &destruidos[CANT + i]));
+			VERIFICAR(hash_fusionar(destino, origen, politica));
+			VERIFICAR(hash_cantidad(destino) == CANT);
+			for(size_t i = 0; i < CANT; i++){
+				bool de_origen = i >= 2 * tercio || (i >= tercio && politica == HASH_FUSION_SOBREESCRIBIR);
+				VERIFICAR(hash_obtener(destino, claves[i]) == (de_origen ? &destruidos[CANT + i] : &destruidos[i]));
+				// En las dos, el dato que no queda en destino queda en
+				// origen o se destruyo.
+				bool en_origen = i >= tercio && i < 2 * tercio && politica == HASH_FUSION_UNION;
+				VERIFICAR(hash_obtener(origen, claves[i]) == (en_origen ? &destruidos[CANT + i] : NULL));
+				VERIFICAR(destruidos[i] == (i >= tercio && i < 2 * tercio && politica == HASH_FUSION_SOBREESCRIBIR));
+			}
+			VERIFICAR(hash_cantidad(origen) == (politica == HASH_FUSION_UNION ? tercio : 0));
+			hash_destruir(origen);
+			hash_destruir(destino);
+			for(size_t i = 0; i < CANT; i++){
+				VERIFICAR(destruidos[i] == (i < 2 * tercio));
+				VERIFICAR(destruidos[CANT + i] == (i >= tercio));
+			}
+		}
+	}
+}
+
+/* Las claves de origen llevan su vencimiento a destino. */
+static void prueba_vencimientos(void){
+	hash_opciones_t opciones = {0};
+	opciones.vencimientos = true;
+	opciones.reloj = reloj;
+	memset(destruidos, 0, sizeof(destruidos));
+	ahora = 0;
+	hash_t* destino = hash_crear_con_opciones(destruir, &opciones);
+	hash_t* origen = hash_crear_con_opciones(destruir, &opciones);
+	VERIFICAR(destino && origen);
+	for(size_t i = 0; i < 1000; i++){
+		if(i % 2)
+			VERIFICAR(hash_guardar_ttl(origen, claves[i], &destruidos[i], 100));
+		else
+			VERIFICAR(hash_guardar(origen, claves[i], &destruidos[i]));
+	}
+	VERIFICAR(hash_fusionar(destino, origen, HASH_FUSION_UNION));
+	VERIFICAR(hash_cantidad(origen) == 0 && hash_cantidad(destino) == 1000);
+	ahora = 200;
+	for(size_t i = 0; i < 1000; i++)
+		VERIFICAR(hash_obtener(destino, claves[i]) == (i % 2 ? NULL : &destruidos[i]));
+	VERIFICAR(hash_cantidad(destino) == 500);
+	hash_destruir(origen);
+	hash_destruir(destino);
+	verificar_destruidos(1000);
+}
+
+/* Falla un pedido distinto de destino en cada vuelta, hasta que la
+ * fusion no falla, incluidos los de la rueda de vencimientos: cada clave queda en uno solo de los dos hash,
+ * y cada dato se destruye una sola vez. Si lo que falto fue la memoria
+ * de un vencimiento, la clave pasa sin vencimiento.
+ */
+static void prueba_sin_memoria(void){
+	size_t sin_vencimiento = 0;
+	bool ok = false;
+	for(size_t k = 1; !ok; k++){
+		hash_opciones_t opciones = {0};
+		opciones.semilla = 31415;
+		opciones.vencimientos = true;
+		opciones.reloj = reloj;
+		ahora = 0;
+		memset(destruidos, 0, sizeof(destruidos));
+		hash_t* origen = hash_crear_con_opciones(destruir, &opciones);
+		opciones.asignador.pedir = pedir;
+		opciones.asignador.liberar = liberar;
+		hash_t* destino = hash_crear_con_opciones(destruir, &opciones);
+		VERIFICAR(destino && origen);
+		for(size_t i = 0; i < 100; i++)
+			VERIFICAR(hash_guardar_ttl(destino, claves[i], &destruidos[i], 100));
+		for(size_t i = 100; i < 400; i++)
+			VERIFICAR(hash_guardar_ttl(origen, claves[i], &destruidos[i], 100));
+		pedidos = 0;
+		fallar_en = k;
+		ok = hash_fusionar(destino, origen, HASH_FUSION_SOBREESCRIBIR);
+		fallar_en = 0;
+		VERIFICAR(hash_cantidad(destino) + hash_cantidad(origen) == 400);
+		VERIFICAR(!ok || hash_cantidad(origen) == 0);
+		for(size_t i = 0; i < 400; i++){
+			bool en_destino = hash_obtener(destino, claves[i]) == &destruidos[i];
+			bool en_origen = hash_obtener(origen, claves[i]) == &destruidos[i];
+			VERIFICAR(en_destino != en_origen && (i >= 100 || en_destino));
+		}
+		// Las claves que pasaron sin vencimiento no vencen.
+		ahora = 200;
+		hash_expirar(destino, SIZE_MAX);
+		sin_vencimiento += hash_cantidad(destino);
+		VERIFICAR(ok || hash_cantidad(destino) <= 1);
+		hash_destruir(origen);
+		hash_destruir(destino);
+		verificar_destruidos(400);
+	}
+	VERIFICAR(sin_vencimiento > 0);
+}
+
+int main(void){
+	for(size_t i = 0; i < CANT; i++)
+		snprintf(claves[i], LARGO_CLAVE, i % 2 ? "c%zu" : "una-clave-larga-%zu", i);
+
+	prueba_construir();
+	prueba_fusionar();
+	prueba_vencimientos();
+	prueba_sin_memoria();
+
+	puts("prueba_fusion: OK");
+	return 0;
+}
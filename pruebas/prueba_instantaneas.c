@@ -0,0 +1,175 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../hash.h"
+#include "pruebas.h"
+
+/* Prueba de las instantaneas: que muestren el hash al momento de
+ * crearlas aunque despues se borre, se reemplace o se redimensione, y que
+ * otro hilo las pueda leer mientras el hash se sigue modificando (con
+ * desalojos, vencimientos, hash_obtener_ptr y hash_fusionar).
+ */
+
+#define CANT 6000
+#define LARGO_CLAVE 40
+
+static char claves[3 * CANT][LARGO_CLAVE];
+static long valores[3 * CANT];
+static uint64_t ahora = 1000;
+
+static uint64_t reloj(void){
+	return __atomic_load_n(&ahora, __ATOMIC_RELAXED);
+}
+
+typedef struct cuenta{
+	size_t cant;
+	long suma;
+} cuenta_t;
+
+static bool contar(const char* clave, void* dato, void* extra){
+	(void)clave;
+	cuenta_t* cuenta = extra;
+	cuenta->cant++;
+	cuenta->suma += *(long*)dato;
+	return true;
+}
+
+static cuenta_t recorrer(const hash_snapshot_t* snapshot){
+	cuenta_t cuenta = {0, 0};
+	VERIFICAR(hash_snapshot_iterar(snapshot, contar, &cuenta));
+	return cuenta;
+}
+
+static void prueba_estado(const hash_opciones_t* opciones){
+	hash_t* hash = hash_crear_con_opciones(NULL, opciones);
+	VERIFICAR(hash);
+	long suma = 0;
+	for(size_t i = 0; i < CANT; i++){
+		VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+		suma += (long)i;
+	}
+	hash_snapshot_t* primera = hash_snapshot(hash);
+	VERIFICAR(primera && hash_snapshot_cantidad(primera) == CANT);
+	for(size_t i = 0; i < CANT; i += 2)
+		VERIFICAR(hash_borrar(hash, claves[i]) == &valores[i]);
+	for(size_t i = 1; i < CANT; i += 4)
+		VERIFICAR(hash_guardar(hash, claves[i], &valores[CANT + i]));
+	hash_snapshot_t* segunda = hash_snapshot(hash);
+	VERIFICAR(segunda && hash_snapshot_cantidad(segunda) == CANT / 2);
+	// Agranda la tabla: las dos siguen viendo lo suyo.
+	for(size_t i = CANT; i < 2 * CANT; i++)
+		VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+	for(size_t i = 0; i < CANT; i++){
+		long* dato = hash_snapshot_obtener(primera, claves[i]);
+		VERIFICAR(dato && *dato == (long)i);
+		dato = hash_snapshot_obtener(segunda, claves[i]);
+		if(i % 2 == 0)
+			VERIFICAR(!dato && !hash_snapshot_pertenece(segunda, claves[i]));
+		else
+			VERIFICAR(dato && *dato == (long)(i % 4 == 1 ? CANT + i : i));
+	}
+	VERIFICAR(!hash_snapshot_pertenece(primera, claves[CANT + 1]));
+	cuenta_t cuenta = recorrer(primera);
+	VERIFICAR(cuenta.cant == CANT && cuenta.suma == suma);
+	hash_snapshot_destruir(primera);
+	// Al seguir modificando el hash se libera la primera.
+	for(size_t i = 1; i < CANT; i += 2)
+		VERIFICAR(hash_borrar(hash, claves[i]));
+	VERIFICAR(hash_compactar(hash));
+	VERIFICAR(recorrer(segunda).cant == CANT / 2);
+	hash_snapshot_destruir(segunda);
+	hash_destruir(hash);
+}
+
+typedef struct lector{
+	hash_snapshot_t* snapshot;
+	cuenta_t esperada;
+	bool ok;
+} lector_t;
+
+static void* leer(void* arg){
+	lector_t* lector = arg;
+	lector->ok = true;
+	for(int vuelta = 0; vuelta < 20 && lector->ok; vuelta++){
+		cuenta_t cuenta = recorrer(lector->snapshot);
+		lector->ok = cuenta.cant == lector->esperada.cant && cuenta.suma == lector->esperada.suma;
+		for(size_t i = 0; i < CANT && lector->ok; i += 7){
+			long* dato = hash_snapshot_obtener(lector->snapshot, claves[i]);
+			lector->ok = dato && *dato == (long)i;
+		}
+	}
+	return NULL;
+}
+
+static void prueba_lector_concurrente(const hash_opciones_t* opciones){
+	hash_t* hash = hash_crear_con_opciones(NULL, opciones);
+	VERIFICAR(hash);
+	cuenta_t esperada = {0, 0};
+	for(size_t i = 0; i < CANT; i++){
+		if(opciones->vencimientos)
+			VERIFICAR(hash_guardar_ttl(hash, claves[i], &valores[i], 10 + i % 50));
+		else
+			VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+		esperada.cant++;
+		esperada.suma += (long)i;
+	}
+	lector_t lector = {hash_snapshot(hash), esperada, false};
+	VERIFICAR(lector.snapshot);
+	pthread_t hilo;
+	VERIFICAR(pthread_create(&hilo, NULL, leer, &lector) == 0);
+	for(size_t i = CANT; i < 3 * CANT; i++){
+		VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+		if(i % 5 == 0)
+			hash_obtener(hash, claves[i - CANT]);
+		if(i % 7 == 0){
+			void** dato = hash_obtener_ptr(hash, claves[i]);
+			if(dato)
+				*dato = &valores[0];
+		}
+		if(i % 100 == 0){
+			__atomic_add_fetch(&ahora, 3, __ATOMIC_RELAXED);
+			hash_expirar(hash, 50);
+		}
+	}
+	hash_t* otro = hash_crear_con_opciones(NULL, opciones);
+	VERIFICAR(otro);
+	for(size_t i = 0; i < CANT; i += 2)
+		VERIFICAR(hash_guardar(otro, claves[i], &valores[CANT + i]));
+	VERIFICAR(hash_fusionar(hash, otro, HASH_FUSION_SOBREESCRIBIR));
+	hash_destruir(otro);
+	pthread_join(hilo, NULL);
+	VERIFICAR(lector.ok);
+	hash_snapshot_destruir(lector.snapshot);
+	hash_destruir(hash);
+}
+
+int main(void){
+	for(size_t i = 0; i < 3 * CANT; i++){
+		snprintf(claves[i], LARGO_CLAVE, i % 2 ? "c%zu" : "una-clave-larga-de-prueba-%zu", i);
+		valores[i] = (long)i;
+	}
+
+	hash_opciones_t opciones = {0};
+	prueba_estado(&opciones);
+	prueba_lector_concurrente(&opciones);
+	opciones.arena = true;
+	opciones.rehash_incremental = true;
+	prueba_estado(&opciones);
+	prueba_lector_concurrente(&opciones);
+
+	hash_opciones_t cache = {0};
+	cache.cache_entradas = CANT;
+	prueba_lector_concurrente(&cache);
+
+	hash_opciones_t vencimientos = {0};
+	vencimientos.vencimientos = true;
+	vencimientos.reloj = reloj;
+	prueba_estado(&vencimientos);
+	prueba_lector_concurrente(&vencimientos);
+	vencimientos.cache_entradas = CANT;
+	prueba_lector_concurrente(&vencimientos);
+
+	puts("prueba_instantaneas: OK");
+	return 0;
+}
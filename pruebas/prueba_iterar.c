@@ -0,0 +1,120 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../hash.h"
+#include "pruebas.h"
+
+/* Prueba de hash_iterar y de los iteradores: el hash vacio, cortar el
+ * recorrido, que los tres recorridos den las mismas claves en el mismo
+ * orden, y una tabla grande casi vacia, que se recorre salteando
+ * posiciones con el bitmap.
+ */
+
+#define CANT 50000
+#define LARGO_CLAVE 32
+
+static char claves[CANT][LARGO_CLAVE];
+static long valores[CANT];
+
+typedef struct{
+	const char* orden[CANT];
+	size_t cant;
+	size_t limite; // visitar devuelve false al llegar a este
+} recorrido_t;
+
+static bool anotar(const char* clave, void* dato, void* extra){
+	recorrido_t* recorrido = extra;
+	VERIFICAR(strcmp(clave, claves[*(long*)dato]) == 0);
+	recorrido->orden[recorrido->cant++] = clave;
+	return recorrido->cant < recorrido->limite;
+}
+
+static recorrido_t recorrido;
+
+/* Recorre el hash de las tres formas y verifica que den las mismas
+ * claves en el mismo orden, y que sean las cant esperadas.
+ */
+static void verificar_recorridos(const hash_t* hash, size_t cant){
+	recorrido.cant = 0;
+	recorrido.limite = SIZE_MAX;
+	hash_iterar(hash, anotar, &recorrido);
+	VERIFICAR(recorrido.cant == cant);
+
+	hash_iter_t iter;
+	size_t i = 0;
+	for(hash_iter_inicializar(&iter, hash); !hash_iter_al_final(&iter); hash_iter_avanzar(&iter)){
+		VERIFICAR(i < cant && hash_iter_ver_actual(&iter) == recorrido.orden[i]);
+		VERIFICAR(hash_iter_ver_dato(&iter) == hash_obtener(hash, recorrido.orden[i]));
+		i++;
+	}
+	VERIFICAR(i == cant);
+	VERIFICAR(!hash_iter_avanzar(&iter) && !hash_iter_ver_actual(&iter) && !hash_iter_ver_dato(&iter));
+
+	hash_iter_t* creado = hash_iter_crear(hash);
+	VERIFICAR(creado);
+	for(i = 0; i < cant; i++){
+		VERIFICAR(hash_iter_ver_actual(creado) == recorrido.orden[i]);
+		VERIFICAR(hash_iter_avanzar(creado) == (i + 1 < cant));
+	}
+	VERIFICAR(hash_iter_al_final(creado));
+	hash_iter_destruir(creado);
+}
+
+static void prueba_vacio(void){
+	hash_t* hash = hash_crear(NULL);
+	VERIFICAR(hash);
+	verificar_recorridos(hash, 0);
+	hash_iter_t iter;
+	hash_iter_inicializar(&iter, hash);
+	VERIFICAR(hash_iter_al_final(&iter) && !hash_iter_ver_actual(&iter));
+	hash_destruir(hash);
+}
+
+static void prueba_cortar(void){
+	hash_t* hash = hash_crear(NULL);
+	VERIFICAR(hash);
+	for(size_t i = 0; i < 1000; i++)
+		VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+	size_t limites[] = {1, 2, 500, 999, 1000};
+	for(size_t k = 0; k < sizeof(limites) / sizeof(limites[0]); k++){
+		recorrido.cant = 0;
+		recorrido.limite = limites[k];
+		hash_iterar(hash, anotar, &recorrido);
+		VERIFICAR(recorrido.cant == limites[k]);
+	}
+	hash_destruir(hash);
+}
+
+/* Despues de borrar casi todo, sin achicar la tabla, quedan pocas claves
+ * muy separadas.
+ */
+static void prueba_dispersa(void){
+	hash_opciones_t opciones = {0};
+	opciones.politica.nunca_achicar = true;
+	hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+	VERIFICAR(hash);
+	for(size_t i = 0; i < CANT; i++)
+		VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+	verificar_recorridos(hash, CANT);
+	for(size_t i = 0; i < CANT; i++){
+		if(i % 5000)
+			VERIFICAR(hash_borrar(hash, claves[i]) == &valores[i]);
+	}
+	verificar_recorridos(hash, CANT / 5000);
+	hash_destruir(hash);
+}
+
+int main(void){
+	for(size_t i = 0; i < CANT; i++){
+		snprintf(claves[i], LARGO_CLAVE, i % 2 ? "c%zu" : "una-clave-larga-%zu", i);
+		valores[i] = (long)i;
+	}
+
+	prueba_vacio();
+	prueba_cortar();
+	prueba_dispersa();
+
+	puts("prueba_iterar: OK");
+	return 0;
+}
@@ -0,0 +1,106 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../lista.h"
+#include "pruebas.h"
+
+/* Prueba de la lista: operaciones al azar en los dos extremos y en el
+ * medio con el iterador, comparadas con un arreglo, para cruzar los
+ * limites de los nodos de varios datos en todas las direcciones.
+ */
+
+#define OPERACIONES 20000
+#define MAXIMO 4096
+
+static uintptr_t modelo[MAXIMO];
+static size_t cant;
+
+static void* dato(uintptr_t valor){
+	return (void*)(valor + 1); // nunca NULL
+}
+
+static uint64_t estado = 12345;
+
+static size_t azar(size_t n){
+	estado ^= estado << 13;
+	estado ^= estado >> 7;
+	estado ^= estado << 17;
+	return (size_t)(estado % n);
+}
+
+static bool comparar(void* valor, void* extra){
+	size_t* i = extra;
+	VERIFICAR(*i < cant && valor == dato(modelo[*i]));
+	(*i)++;
+	return true;
+}
+
+static void verificar_igual(lista_t* lista){
+	VERIFICAR(lista_largo(lista) == cant);
+	VERIFICAR(lista_esta_vacia(lista) == (cant == 0));
+	if(cant){
+		VERIFICAR(lista_ver_primero(lista) == dato(modelo[0]));
+		VERIFICAR(lista_ver_ultimo(lista) == dato(modelo[cant - 1]));
+	}
+	size_t i = 0;
+	lista_iterar(lista, comparar, &i);
+	VERIFICAR(i == cant);
+}
+
+/* Ubica el iterador en la posicion pos.
+ */
+static void ir_a(lista_iter_t* iter, lista_t* lista, size_t pos){
+	lista_iter_inicializar(iter, lista);
+	for(size_t i = 0; i < pos; i++)
+		VERIFICAR(lista_iter_avanzar(iter));
+}
+
+int main(void){
+	lista_t* lista = lista_crear();
+	VERIFICAR(lista);
+	VERIFICAR(!lista_borrar_primero(lista) && !lista_ver_primero(lista));
+	for(uintptr_t n = 0; n < OPERACIONES; n++){
+		size_t operacion = azar(cant >= MAXIMO - 1 ? 2 : 6);
+		lista_iter_t iter;
+		size_t pos = azar(cant + 1);
+		if(operacion == 0 && cant){
+			VERIFICAR(lista_borrar_primero(lista) == dato(modelo[0]));
+			memmove(modelo, modelo + 1, sizeof(uintptr_t) * --cant);
+		}else if(operacion == 1 && pos < cant){
+			ir_a(&iter, lista, pos);
+			VERIFICAR(lista_iter_borrar(&iter) == dato(modelo[pos]));
+			memmove(modelo + pos, modelo + pos + 1, sizeof(uintptr_t) * (--cant - pos));
+			VERIFICAR(pos == cant ? lista_iter_al_final(&iter) : lista_iter_ver_actual(&iter) == dato(modelo[pos]));
+		}else if(operacion == 2){
+			VERIFICAR(lista_insertar_primero(lista, dato(n)));
+			memmove(modelo + 1, modelo, sizeof(uintptr_t) * cant++);
+			modelo[0] = n;
+		}else if(operacion == 3){
+			VERIFICAR(lista_insertar_ultimo(lista, dato(n)));
+			modelo[cant++] = n;
+		}else if(operacion >= 4){
+			ir_a(&iter, lista, pos);
+			VERIFICAR(lista_iter_insertar(&iter, dato(n)));
+			VERIFICAR(lista_iter_ver_actual(&iter) == dato(n));
+			memmove(modelo + pos + 1, modelo + pos, sizeof(uintptr_t) * (cant++ - pos));
+			modelo[pos] = n;
+		}
+		if(n % 97 == 0)
+			verificar_igual(lista);
+	}
+	verificar_igual(lista);
+
+	lista_iter_t* iter = lista_iter_crear(lista);
+	VERIFICAR(iter);
+	for(size_t i = 0; i < cant; i++){
+		VERIFICAR(lista_iter_ver_actual(iter) == dato(modelo[i]));
+		lista_iter_avanzar(iter);
+	}
+	VERIFICAR(lista_iter_al_final(iter) && !lista_iter_avanzar(iter));
+	lista_iter_destruir(iter);
+	lista_destruir(lista, NULL);
+
+	puts("prueba_lista: OK");
+	return 0;
+}
@@ -0,0 +1,104 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../hash.h"
+#include "pruebas.h"
+
+/* Prueba de las primitivas por lotes: lotes de largos que no son
+ * multiplo del grupo que se prepara junto, con claves repetidas, que
+ * faltan o que estan, comparados con las primitivas de a una sobre otro
+ * hash.
+ */
+
+#define CANT 20000
+#define LARGO_CLAVE 32
+#define MAX_LOTE 1000
+
+static char claves[CANT][LARGO_CLAVE];
+static int destruidos[CANT];
+
+static uint64_t estado = 1618033;
+
+static size_t azar(size_t n){
+	estado ^= estado << 13;
+	estado ^= estado >> 7;
+	estado ^= estado << 17;
+	return (size_t)(estado % n);
+}
+
+static void destruir(void* dato){
+	(*(int*)dato)++;
+}
+
+static const char* lote[MAX_LOTE];
+static void* datos[MAX_LOTE];
+static void* esperados[MAX_LOTE];
+
+/* Arma un lote de cant claves al azar entre las primeras rango, que
+ * pueden repetirse.
+ */
+static void armar_lote(size_t cant, size_t rango){
+	for(size_t k = 0; k < cant; k++){
+		size_t i = azar(rango);
+		lote[k] = claves[i];
+		datos[k] = &destruidos[i];
+	}
+}
+
+int main(void){
+	for(size_t i = 0; i < CANT; i++)
+		snprintf(claves[i], LARGO_CLAVE, i % 2 ? "c%zu" : "una-clave-larga-%zu", i);
+
+	hash_t* hash = hash_crear(destruir);
+	hash_t* modelo = hash_crear(NULL);
+	VERIFICAR(hash && modelo);
+	size_t largos[] = {0, 1, 15, 16, 17, 33, 100, MAX_LOTE};
+	for(size_t vuelta = 0; vuelta < 200; vuelta++){
+		size_t cant = largos[vuelta % (sizeof(largos) / sizeof(largos[0]))];
+		size_t rango = vuelta < 100 ? CANT : 300;
+
+		// guardar_lote reemplaza como hash_guardar, en orden: una clave
+		// repetida en el lote destruye el dato que guardo antes.
+		armar_lote(cant, rango);
+		int antes = 0, reemplazos = 0;
+		for(size_t i = 0; i < CANT; i++)
+			antes += destruidos[i];
+		for(size_t k = 0; k < cant; k++){
+			reemplazos += hash_pertenece(modelo, lote[k]);
+			VERIFICAR(hash_guardar(modelo, lote[k], datos[k]));
+		}
+		VERIFICAR(hash_guardar_lote(hash, lote, datos, cant));
+		int despues = 0;
+		for(size_t i = 0; i < CANT; i++)
+			despues += destruidos[i];
+		VERIFICAR(despues - antes == reemplazos);
+		VERIFICAR(hash_cantidad(hash) == hash_cantidad(modelo));
+
+		// obtener_lote con claves que estan y que no.
+		armar_lote(cant, rango);
+		for(size_t k = 0; k < cant; k++)
+			esperados[k] = hash_obtener(modelo, lote[k]);
+		hash_obtener_lote(hash, lote, cant, datos);
+		for(size_t k = 0; k < cant; k++)
+			VERIFICAR(datos[k] == esperados[k]);
+
+		// borrar_lote: una clave repetida se borra la primera vez.
+		if(vuelta % 3 == 2){
+			armar_lote(cant, rango);
+			for(size_t k = 0; k < cant; k++)
+				esperados[k] = hash_borrar(modelo, lote[k]);
+			hash_borrar_lote(hash, lote, cant, datos);
+			for(size_t k = 0; k < cant; k++)
+				VERIFICAR(datos[k] == esperados[k]);
+			VERIFICAR(hash_cantidad(hash) == hash_cantidad(modelo));
+		}
+	}
+	for(size_t i = 0; i < CANT; i++)
+		VERIFICAR(hash_obtener(hash, claves[i]) == hash_obtener(modelo, claves[i]));
+	hash_destruir(modelo);
+	hash_destruir(hash);
+
+	puts("prueba_lotes: OK");
+	return 0;
+}
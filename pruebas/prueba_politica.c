@@ -0,0 +1,152 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../hash.h"
+#include "pruebas.h"
+
+/* Prueba de las primitivas del hash y de la politica de redimension:
+ * operaciones al azar comparadas con un modelo (contando cuantas veces se
+ * destruye cada dato), las politicas invalidas, y que la carga quede
+ * entre los limites al crecer y al achicar.
+ */
+
+#define CANT 20000
+#define LARGO_CLAVE 32
+
+static char claves[CANT][LARGO_CLAVE];
+static int destruidos[CANT];
+
+static uint64_t estado = 424242;
+
+static size_t azar(size_t n){
+	estado ^= estado << 13;
+	estado ^= estado >> 7;
+	estado ^= estado << 17;
+	return (size_t)(estado % n);
+}
+
+/* Cada dato es la direccion de su contador de destrucciones. */
+static void destruir(void* dato){
+	(*(int*)dato)++;
+}
+
+static hash_estadisticas_t estadisticas(const hash_t* hash){
+	hash_estadisticas_t e;
+	hash_estadisticas(hash, &e);
+	return e;
+}
+
+static void prueba_modelo(void){
+	static bool esta[CANT];
+	static int reemplazos[CANT];
+	memset(destruidos, 0, sizeof(destruidos));
+	hash_t* hash = hash_crear(destruir);
+	VERIFICAR(hash);
+	VERIFICAR(!hash_guardar(hash, NULL, NULL));
+	VERIFICAR(!hash_borrar(hash, "nada") && !hash_obtener(hash, "nada") && !hash_pertenece(hash, "nada"));
+	size_t cant = 0;
+	for(size_t n = 0; n < 10 * CANT; n++){
+		size_t i = azar(n < 5 * CANT ? CANT : CANT / 8);
+		size_t operacion = azar(n < 5 * CANT ? 4 : 8);
+		if(operacion < 2){
+			// Reemplazar destruye el dato anterior, que es el mismo.
+			int antes = destruidos[i];
+			VERIFICAR(hash_guardar(hash, claves[i], &destruidos[i]));
+			VERIFICAR(destruidos[i] == antes + esta[i]);
+			reemplazos[i] += esta[i];
+			cant += !esta[i];
+			esta[i] = true;
+		}else if(operacion == 2){
+			VERIFICAR(hash_borrar(hash, claves[i]) == (esta[i] ? &destruidos[i] : NULL));
+			cant -= esta[i];
+			esta[i] = false;
+		}else if(operacion == 3){
+			void** dato = hash_obtener_ptr(hash, claves[i]);
+			VERIFICAR(esta[i] ? dato && *dato == &destruidos[i] : !dato);
+		}else{
+			VERIFICAR(hash_pertenece(hash, claves[i]) == esta[i]);
+			VERIFICAR(hash_obtener(hash, claves[i]) == (esta[i] ? &destruidos[i] : NULL));
+		}
+		VERIFICAR(hash_cantidad(hash) == cant);
+	}
+	hash_destruir(hash);
+	// hash_borrar no destruye el dato; hash_destruir, los que quedaban.
+	for(size_t i = 0; i < CANT; i++)
+		VERIFICAR(destruidos[i] == reemplazos[i] + esta[i]);
+}
+
+static void prueba_invalidas(void){
+	hash_opciones_t opciones = {0};
+	opciones.politica.carga_maxima = -1;
+	VERIFICAR(!hash_crear_con_opciones(NULL, &opciones));
+	opciones.politica.carga_maxima = 0.5;
+	opciones.politica.factor_crecimiento = 3;
+	VERIFICAR(!hash_crear_con_opciones(NULL, &opciones));
+	opciones.politica.factor_crecimiento = 2;
+	// Achicar con carga 0.3 dejaria la tabla con carga 0.6 > 0.5: volveria a crecer.
+	opciones.politica.carga_minima = 0.3;
+	VERIFICAR(!hash_crear_con_opciones(NULL, &opciones));
+	opciones.politica.nunca_achicar = true;
+	hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+	VERIFICAR(hash);
+	hash_destruir(hash);
+}
+
+/* La carga nunca supera carga_maxima, crece de a factor_crecimiento, y al
+ * borrar se achica (sin bajar de tam_inicial) solo si cae por debajo de
+ * carga_minima, o nunca con nunca_achicar.
+ */
+static void prueba_limites(double carga_maxima, size_t factor, size_t tam_inicial, bool nunca_achicar){
+	hash_opciones_t opciones = {0};
+	opciones.politica.carga_maxima = carga_maxima;
+	opciones.politica.factor_crecimiento = factor;
+	opciones.politica.tam_inicial = tam_inicial;
+	opciones.politica.nunca_achicar = nunca_achicar;
+	hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+	VERIFICAR(hash);
+	hash_estadisticas_t e = estadisticas(hash);
+	VERIFICAR(e.tam == tam_inicial);
+	size_t tam = e.tam;
+	for(size_t i = 0; i < CANT; i++){
+		VERIFICAR(hash_guardar(hash, claves[i], NULL));
+		e = estadisticas(hash);
+		VERIFICAR(e.carga <= carga_maxima);
+		VERIFICAR(e.tam == tam || e.tam == tam * factor);
+		tam = e.tam;
+	}
+	size_t tam_maximo = tam;
+	// Con la carga minima por defecto (la mitad de la que queda al crecer).
+	double carga_minima = carga_maxima / (double)(2 * factor);
+	for(size_t i = 0; i < CANT; i++){
+		VERIFICAR(hash_borrar(hash, claves[i]) == NULL);
+		e = estadisticas(hash);
+		VERIFICAR(e.tam >= tam_inicial);
+		if(nunca_achicar){
+			VERIFICAR(e.tam == tam_maximo);
+		}else if(e.tam != tam){
+			VERIFICAR(e.tam < tam && e.carga <= carga_maxima / (double)factor);
+		}else if(e.tam > tam_inicial){
+			VERIFICAR((double)e.cantidad >= carga_minima * (double)e.tam);
+		}
+		tam = e.tam;
+	}
+	VERIFICAR(hash_cantidad(hash) == 0);
+	VERIFICAR(nunca_achicar ? tam == tam_maximo : tam == tam_inicial);
+	hash_destruir(hash);
+}
+
+int main(void){
+	for(size_t i = 0; i < CANT; i++)
+		snprintf(claves[i], LARGO_CLAVE, i % 2 ? "c%zu" : "una-clave-larga-%zu", i);
+
+	prueba_modelo();
+	prueba_invalidas();
+	prueba_limites(0.7, 2, 64, false);
+	prueba_limites(0.5, 4, 16, false);
+	prueba_limites(0.9, 2, 1024, false);
+	prueba_limites(0.7, 2, 64, true);
+
+	puts("prueba_politica: OK");
+	return 0;
+}
@@ -0,0 +1,152 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../hash.h"
+#include "pruebas.h"
+
+/* Prueba del rehash incremental: guardar, borrar, buscar, iterar y crear
+ * instantaneas mientras la tabla vieja todavia tiene claves, comparando
+ * con un modelo. hash_cerrado.c ignora la opcion, y la prueba tiene que
+ * pasar igual.
+ */
+
+#define CANT 20000
+#define LARGO_CLAVE 32
+
+static char claves[CANT][LARGO_CLAVE];
+static long valores[CANT];
+static bool esta[CANT];
+static size_t cant;
+
+static uint64_t estado = 8675309;
+
+static size_t azar(size_t n){
+	estado ^= estado << 13;
+	estado ^= estado >> 7;
+	estado ^= estado << 17;
+	return (size_t)(estado % n);
+}
+
+static size_t redimensiones(const hash_t* hash){
+	hash_estadisticas_t e;
+	hash_estadisticas(hash, &e);
+	return e.redimensiones;
+}
+
+static bool marcar(const char* clave, void* dato, void* extra){
+	bool* vistas = extra;
+	long i = *(long*)dato;
+	VERIFICAR(strcmp(clave, claves[i]) == 0 && esta[i] && !vistas[i]);
+	vistas[i] = true;
+	return true;
+}
+
+/* Cada clave del modelo aparece una sola vez al iterar, con su dato, y
+ * ninguna de las borradas se encuentra.
+ */
+static void verificar_igual(const hash_t* hash){
+	static bool vistas[CANT];
+	memset(vistas, 0, sizeof(vistas));
+	VERIFICAR(hash_cantidad(hash) == cant);
+	hash_iterar(hash, marcar, vistas);
+	size_t contadas = 0;
+	hash_iter_t iter;
+	for(hash_iter_inicializar(&iter, hash); !hash_iter_al_final(&iter); hash_iter_avanzar(&iter))
+		contadas++;
+	VERIFICAR(contadas == cant);
+	for(size_t i = 0; i < CANT; i++){
+		VERIFICAR(vistas[i] == esta[i]);
+		VERIFICAR(hash_obtener(hash, claves[i]) == (esta[i] ? &valores[i] : NULL));
+	}
+}
+
+static void prueba_operaciones(void){
+	hash_opciones_t opciones = {0};
+	opciones.rehash_incremental = true;
+	opciones.politica.tam_inicial = 8;
+	hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+	VERIFICAR(hash);
+	memset(esta, 0, sizeof(esta));
+	cant = 0;
+	size_t verificadas = 0;
+	for(size_t n = 0; n < 4 * CANT; n++){
+		size_t i = azar(n < 2 * CANT ? CANT : CANT / 4);
+		size_t antes = redimensiones(hash);
+		if(azar(3) > 0 || n < CANT / 2){
+			VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+			cant += !esta[i];
+			esta[i] = true;
+		}else{
+			VERIFICAR(hash_borrar(hash, claves[i]) == (esta[i] ? &valores[i] : NULL));
+			cant -= esta[i];
+			esta[i] = false;
+		}
+		// Justo despues de redimensionar casi todas las claves siguen en la
+		// tabla vieja; unas operaciones despues, en las dos.
+		if(redimensiones(hash) != antes)
+			verificadas = n;
+		if(verificadas && (n == verificadas || n == verificadas + 50)){
+			verificar_igual(hash);
+			if(n == verificadas + 50)
+				verificadas = 0;
+		}
+	}
+	verificar_igual(hash);
+	hash_destruir(hash);
+}
+
+/* Una instantanea creada durante un rehash ve todas las claves, y las
+ * modificaciones posteriores no la cambian.
+ */
+static void prueba_instantanea(void){
+	hash_opciones_t opciones = {0};
+	opciones.rehash_incremental = true;
+	hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+	VERIFICAR(hash);
+	// La tercera redimension deja casi todas las claves en la tabla vieja.
+	size_t i = 0;
+	for(; redimensiones(hash) < 3; i++)
+		VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+	hash_snapshot_t* instantanea = hash_snapshot(hash);
+	VERIFICAR(instantanea && hash_snapshot_cantidad(instantanea) == i);
+	for(size_t j = 0; j < i; j += 2)
+		VERIFICAR(hash_borrar(hash, claves[j]) == &valores[j]);
+	for(size_t j = i; j < i + 1000; j++)
+		VERIFICAR(hash_guardar(hash, claves[j], &valores[j]));
+	for(size_t j = 0; j < i + 1000; j++)
+		VERIFICAR(hash_snapshot_obtener(instantanea, claves[j]) == (j < i ? &valores[j] : NULL));
+	hash_snapshot_destruir(instantanea);
+	hash_destruir(hash);
+}
+
+/* Destruir el hash a mitad de un rehash destruye cada dato una vez. */
+static void prueba_destruir(void){
+	hash_opciones_t opciones = {0};
+	opciones.rehash_incremental = true;
+	hash_t* hash = hash_crear_con_opciones(free, &opciones);
+	VERIFICAR(hash);
+	size_t i = 0;
+	for(size_t antes = redimensiones(hash); redimensiones(hash) < antes + 2; i++){
+		long* dato = malloc(sizeof(long));
+		VERIFICAR(dato);
+		*dato = (long)i;
+		VERIFICAR(hash_guardar(hash, claves[i], dato));
+	}
+	VERIFICAR(hash_cantidad(hash) == i);
+	hash_destruir(hash);
+}
+
+int main(void){
+	for(size_t i = 0; i < CANT; i++){
+		snprintf(claves[i], LARGO_CLAVE, i % 2 ? "c%zu" : "una-clave-larga-%zu", i);
+		valores[i] = (long)i;
+	}
+
+	prueba_operaciones();
+	prueba_instantanea();
+	prueba_destruir();
+
+	puts("prueba_rehash: OK");
+	return 0;
+}
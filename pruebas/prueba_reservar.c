@@ -0,0 +1,140 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../hash.h"
+#include "pruebas.h"
+
+/* Prueba de hash_crear_con_capacidad, hash_reservar y hash_compactar:
+ * despues de reservar no se redimensiona al guardar, compactar achica por
+ * debajo del tamaño inicial sin perder claves, y si no hay memoria el
+ * hash queda como estaba.
+ */
+
+#define CANT 20000
+#define LARGO_CLAVE 32
+
+static char claves[CANT][LARGO_CLAVE];
+static long valores[CANT];
+
+static hash_estadisticas_t estadisticas(const hash_t* hash){
+	hash_estadisticas_t e;
+	hash_estadisticas(hash, &e);
+	return e;
+}
+
+static void verificar_claves(const hash_t* hash, size_t desde, size_t hasta){
+	VERIFICAR(hash_cantidad(hash) == hasta - desde);
+	for(size_t i = 0; i < CANT; i++)
+		VERIFICAR(hash_obtener(hash, claves[i]) == (i >= desde && i < hasta ? &valores[i] : NULL));
+}
+
+/* Asignador que falla mientras fallar sea true. */
+static bool fallar;
+
+static void* pedir(void* ctx, size_t tam){
+	(void)ctx;
+	return fallar ? NULL : malloc(tam);
+}
+
+static void liberar(void* ctx, void* ptr){
+	(void)ctx;
+	free(ptr);
+}
+
+static void prueba_capacidad(void){
+	hash_t* hash = hash_crear_con_capacidad(NULL, CANT);
+	VERIFICAR(hash);
+	for(size_t i = 0; i < CANT; i++)
+		VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+	VERIFICAR(estadisticas(hash).redimensiones == 0);
+	// No se achica por debajo de la capacidad pedida.
+	size_t tam = estadisticas(hash).tam;
+	for(size_t i = 0; i < CANT; i++)
+		VERIFICAR(hash_borrar(hash, claves[i]) == &valores[i]);
+	VERIFICAR(estadisticas(hash).tam == tam);
+	hash_destruir(hash);
+}
+
+static void prueba_reservar(void){
+	hash_t* hash = hash_crear(NULL);
+	VERIFICAR(hash);
+	for(size_t i = 0; i < 100; i++)
+		VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+	size_t redimensiones = estadisticas(hash).redimensiones;
+	VERIFICAR(hash_reservar(hash, CANT));
+	hash_estadisticas_t e = estadisticas(hash);
+	VERIFICAR(e.redimensiones == redimensiones + 1);
+	// Reservar menos de lo que ya entra no hace nada.
+	VERIFICAR(hash_reservar(hash, CANT / 2) && hash_reservar(hash, 0));
+	VERIFICAR(estadisticas(hash).tam == e.tam);
+	for(size_t i = 100; i < CANT; i++)
+		VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+	VERIFICAR(estadisticas(hash).redimensiones == redimensiones + 1);
+	verificar_claves(hash, 0, CANT);
+	hash_destruir(hash);
+}
+
+static void prueba_compactar(void){
+	hash_opciones_t opciones = {0};
+	opciones.politica.nunca_achicar = true;
+	hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+	VERIFICAR(hash);
+	for(size_t i = 0; i < CANT; i++)
+		VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+	size_t tam_inicial = estadisticas(hash).tam;
+	for(size_t i = 0; i < CANT - 10; i++)
+		VERIFICAR(hash_borrar(hash, claves[i]) == &valores[i]);
+	VERIFICAR(estadisticas(hash).tam == tam_inicial);
+	VERIFICAR(hash_compactar(hash));
+	hash_estadisticas_t e = estadisticas(hash);
+	VERIFICAR(e.tam < 64 && e.carga <= 0.7);
+	verificar_claves(hash, CANT - 10, CANT);
+	// Compactar de nuevo no cambia nada.
+	VERIFICAR(hash_compactar(hash) && estadisticas(hash).tam == e.tam);
+	// Despues de compactar la tabla vuelve a crecer.
+	for(size_t i = 0; i < CANT - 10; i++)
+		VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+	verificar_claves(hash, 0, CANT);
+	hash_destruir(hash);
+}
+
+static void prueba_sin_memoria(void){
+	hash_opciones_t opciones = {0};
+	opciones.asignador.pedir = pedir;
+	opciones.asignador.liberar = liberar;
+	hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+	VERIFICAR(hash);
+	for(size_t i = 0; i < 1000; i++)
+		VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+	hash_estadisticas_t antes = estadisticas(hash);
+	fallar = true;
+	VERIFICAR(!hash_reservar(hash, CANT));
+	VERIFICAR(estadisticas(hash).tam == antes.tam);
+	verificar_claves(hash, 0, 1000);
+	fallar = false;
+	for(size_t i = 0; i < 990; i++)
+		VERIFICAR(hash_borrar(hash, claves[i]) == &valores[i]);
+	antes = estadisticas(hash);
+	fallar = true;
+	VERIFICAR(!hash_compactar(hash));
+	VERIFICAR(estadisticas(hash).tam == antes.tam);
+	verificar_claves(hash, 990, 1000);
+	fallar = false;
+	hash_destruir(hash);
+}
+
+int main(void){
+	for(size_t i = 0; i < CANT; i++){
+		snprintf(claves[i], LARGO_CLAVE, i % 2 ? "c%zu" : "una-clave-larga-%zu", i);
+		valores[i] = (long)i;
+	}
+
+	prueba_capacidad();
+	prueba_reservar();
+	prueba_compactar();
+	prueba_sin_memoria();
+
+	puts("prueba_reservar: OK");
+	return 0;
+}
@@ -0,0 +1,131 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../hash.h"
+#include "pruebas.h"
+
+/* Prueba de la busqueda con funciones de hashing degeneradas: todas las
+ * claves en la misma posicion con la misma etiqueta, pocos valores
+ * distintos, la misma posicion con etiquetas distintas y posiciones al
+ * final de la tabla, que obligan a dar la vuelta. Guarda, busca y borra
+ * al azar, comparando con un modelo.
+ */
+
+#define CANT 800
+#define OPERACIONES 20000
+#define LARGO_CLAVE 32
+
+static char claves[CANT][LARGO_CLAVE];
+static long valores[CANT];
+static bool guardadas[CANT];
+
+static uint64_t estado = 141421;
+
+static size_t azar(size_t n){
+	estado ^= estado << 13;
+	estado ^= estado >> 7;
+	estado ^= estado << 17;
+	return (size_t)(estado % n);
+}
+
+// FNV-1a, para que las funciones de abajo dependan de la clave.
+static uint64_t fnv(const void* clave, size_t largo){
+	const unsigned char* p = clave;
+	uint64_t h = 14695981039346656037u;
+	for(size_t i = 0; i < largo; i++)
+		h = (h ^ p[i]) * 1099511628211u;
+	return h;
+}
+
+static uint64_t constante(const void* clave, size_t largo, uint64_t semilla){
+	(void)clave; (void)largo; (void)semilla;
+	return 0;
+}
+
+static uint64_t pocos_bits(const void* clave, size_t largo, uint64_t semilla){
+	(void)semilla;
+	return fnv(clave, largo) & 7;
+}
+
+// Misma posicion y distinta etiqueta (bits 40 a 46 en hash_cerrado.c).
+static uint64_t misma_posicion(const void* clave, size_t largo, uint64_t semilla){
+	(void)semilla;
+	return fnv(clave, largo) & 0xffffff0000000000u;
+}
+
+// Las ultimas posiciones de cualquier tabla.
+static uint64_t al_final(const void* clave, size_t largo, uint64_t semilla){
+	(void)semilla;
+	return ~(fnv(clave, largo) & 3);
+}
+
+static void verificar_modelo(const hash_t* hash){
+	size_t cant = 0;
+	for(size_t i = 0; i < CANT; i++){
+		VERIFICAR(hash_obtener(hash, claves[i]) == (guardadas[i] ? &valores[i] : NULL));
+		cant += guardadas[i];
+	}
+	VERIFICAR(hash_cantidad(hash) == cant);
+	size_t vistas = 0;
+	hash_iter_t iter;
+	for(hash_iter_inicializar(&iter, hash); !hash_iter_al_final(&iter); hash_iter_avanzar(&iter)){
+		long i = *(long*)hash_iter_ver_dato(&iter);
+		VERIFICAR(guardadas[i] && strcmp(hash_iter_ver_actual(&iter), claves[i]) == 0);
+		vistas++;
+	}
+	VERIFICAR(vistas == cant);
+}
+
+static void prueba_funcion(hash_funcion_t funcion){
+	hash_opciones_t opciones = {0};
+	opciones.funcion = funcion;
+	hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+	VERIFICAR(hash);
+	memset(guardadas, 0, sizeof(guardadas));
+	for(size_t op = 0; op < OPERACIONES; op++){
+		size_t i = azar(CANT);
+		switch(azar(4)){
+		case 0:
+		case 1:
+			VERIFICAR(hash_guardar(hash, claves[i], &valores[i]));
+			guardadas[i] = true;
+			break;
+		case 2:
+			VERIFICAR(hash_borrar(hash, claves[i]) == (guardadas[i] ? &valores[i] : NULL));
+			guardadas[i] = false;
+			break;
+		default:
+			VERIFICAR(hash_pertenece(hash, claves[i]) == guardadas[i]);
+		}
+		if(op % 5000 == 4999)
+			verificar_modelo(hash);
+	}
+	// Borrar todo, dejando huecos en las corridas largas.
+	for(size_t i = 0; i < CANT; i += 2){
+		hash_borrar(hash, claves[i]);
+		guardadas[i] = false;
+	}
+	verificar_modelo(hash);
+	for(size_t i = 1; i < CANT; i += 2){
+		hash_borrar(hash, claves[i]);
+		guardadas[i] = false;
+	}
+	verificar_modelo(hash);
+	hash_destruir(hash);
+}
+
+int main(void){
+	for(size_t i = 0; i < CANT; i++){
+		snprintf(claves[i], LARGO_CLAVE, i % 2 ? "c%zu" : "una-clave-larga-%zu", i);
+		valores[i] = (long)i;
+	}
+
+	prueba_funcion(constante);
+	prueba_funcion(pocos_bits);
+	prueba_funcion(misma_posicion);
+	prueba_funcion(al_final);
+
+	puts("prueba_sondeo: OK");
+	return 0;
+}
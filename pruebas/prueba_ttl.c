@@ -0,0 +1,127 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../hash.h"
+#include "pruebas.h"
+
+/* Prueba de los vencimientos: hash_guardar_ttl, el borrado al buscar una
+ * clave vencida y hash_expirar, con un reloj controlado por la prueba.
+ */
+
+#define CANT 3000
+#define LARGO_CLAVE 32
+
+static char claves[CANT][LARGO_CLAVE];
+static uint64_t ahora;
+
+static uint64_t reloj(void){
+	return ahora;
+}
+
+static int* dato_nuevo(int valor){
+	int* dato = malloc(sizeof(int));
+	VERIFICAR(dato);
+	*dato = valor;
+	return dato;
+}
+
+static hash_t* crear(bool incremental, bool arena){
+	hash_opciones_t opciones = {0};
+	opciones.vencimientos = true;
+	opciones.reloj = reloj;
+	opciones.rehash_incremental = incremental;
+	opciones.arena = arena;
+	hash_t* hash = hash_crear_con_opciones(free, &opciones);
+	VERIFICAR(hash);
+	return hash;
+}
+
+static size_t vencidas(const hash_t* hash){
+	hash_estadisticas_t estadisticas;
+	hash_estadisticas(hash, &estadisticas);
+	return estadisticas.vencidas;
+}
+
+/* Cada clave i vence a los 10 + i % 100 milisegundos; las de i multiplo
+ * de 3 se guardan sin vencimiento.
+ */
+static void cargar(hash_t* hash){
+	for(size_t i = 0; i < CANT; i++){
+		if(i % 3 == 0)
+			VERIFICAR(hash_guardar(hash, claves[i], dato_nuevo((int)i)));
+		else
+			VERIFICAR(hash_guardar_ttl(hash, claves[i], dato_nuevo((int)i), 10 + i % 100));
+	}
+	VERIFICAR(hash_cantidad(hash) == CANT);
+}
+
+static void prueba_vencer_al_buscar(bool incremental, bool arena){
+	ahora = 1000;
+	hash_t* hash = crear(incremental, arena);
+	cargar(hash);
+	ahora += 60;
+	size_t vivas = 0;
+	for(size_t i = 0; i < CANT; i++){
+		int* dato = hash_obtener(hash, claves[i]);
+		bool vigente = i % 3 == 0 || 10 + i % 100 > 60;
+		VERIFICAR(vigente ? dato && *dato == (int)i : !dato);
+		VERIFICAR(hash_pertenece(hash, claves[i]) == vigente);
+		vivas += vigente;
+	}
+	VERIFICAR(hash_cantidad(hash) == vivas);
+	VERIFICAR(vencidas(hash) == CANT - vivas);
+	hash_destruir(hash);
+}
+
+static void prueba_expirar(void){
+	ahora = 5000;
+	hash_t* hash = crear(false, false);
+	cargar(hash);
+	VERIFICAR(hash_expirar(hash, CANT) == 0);
+	ahora += 200;
+	// Con presupuesto chico se borran de a poco, sin pasarse.
+	size_t borradas = 0, paso;
+	while((paso = hash_expirar(hash, 16)) > 0){
+		VERIFICAR(paso <= 16);
+		borradas += paso;
+	}
+	size_t sin_vencimiento = (CANT + 2) / 3;
+	VERIFICAR(borradas == CANT - sin_vencimiento);
+	VERIFICAR(hash_cantidad(hash) == sin_vencimiento);
+	hash_destruir(hash);
+}
+
+static void prueba_volver_a_guardar(void){
+	ahora = 0;
+	hash_t* hash = crear(false, false);
+	VERIFICAR(hash_guardar_ttl(hash, "a", dato_nuevo(1), 10));
+	VERIFICAR(hash_guardar_ttl(hash, "b", dato_nuevo(2), 10));
+	VERIFICAR(hash_guardar_ttl(hash, "c", dato_nuevo(3), 10));
+	// Volver a guardar reemplaza el vencimiento, o lo quita.
+	VERIFICAR(hash_guardar_ttl(hash, "a", dato_nuevo(4), 100));
+	VERIFICAR(hash_guardar(hash, "b", dato_nuevo(5)));
+	ahora = 50;
+	VERIFICAR(hash_expirar(hash, 100) == 1);
+	VERIFICAR(*(int*)hash_obtener(hash, "a") == 4);
+	VERIFICAR(*(int*)hash_obtener(hash, "b") == 5);
+	VERIFICAR(!hash_pertenece(hash, "c"));
+	// Borrar una clave vencida no devuelve su dato: ya se destruyo.
+	ahora = 100;
+	VERIFICAR(hash_borrar(hash, "a") == NULL);
+	VERIFICAR(hash_cantidad(hash) == 1);
+	hash_destruir(hash);
+}
+
+int main(void){
+	for(size_t i = 0; i < CANT; i++)
+		snprintf(claves[i], LARGO_CLAVE, i % 2 ? "c%zu" : "una-clave-larga-%zu", i);
+
+	prueba_vencer_al_buscar(false, false);
+	prueba_vencer_al_buscar(true, false);
+	prueba_vencer_al_buscar(false, true);
+	prueba_expirar();
+	prueba_volver_a_guardar();
+
+	puts("prueba_ttl: OK");
+	return 0;
+}
@@ -0,0 +1,17 @@
+#ifndef PRUEBAS_H
+#define PRUEBAS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Verificacion de las pruebas: a diferencia de assert, no depende de
+ * NDEBUG. Si la condicion es falsa, informa donde y termina el programa.
+ */
+#define VERIFICAR(condicion) do{ \
+	if(!(condicion)){ \
+		fprintf(stderr, "%s:%d: fallo: %s\n", __FILE__, __LINE__, #condicion); \
+		exit(1); \
+	} \
+}while(0)
+
+#endif // PRUEBAS_H
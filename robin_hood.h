@@ -0,0 +1,51 @@
+#ifndef ROBIN_HOOD_H
+#define ROBIN_HOOD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Sondeo lineal ordenado (Robin Hood). Lo usan hash_cerrado.c y
+ * hash_plano.h, que guardan de forma distinta si una posicion esta
+ * ocupada y a que distancia de su posicion ideal esta su campo: por eso
+ * los recorridos son encabezados de for que reciben esas condiciones
+ * como expresiones y dejan al cuerpo mover los campos. Se pueden usar
+ * con cuerpo o terminados en ';'. Las posiciones dan la vuelta con
+ * mascara, que es el tamaño de la tabla (potencia de dos) menos uno.
+ */
+
+// Distancia entre pos y la posicion ideal de un campo de hash h.
+static inline size_t robin_distancia(uint64_t h, size_t pos, size_t mascara){
+	return (pos - ((size_t)h & mascara)) & mascara;
+}
+
+/* Avanza pos (y d, la distancia que tendria ahi el campo que se busca)
+ * mientras sigue sea verdadera: sigue tiene que ser falsa en una
+ * posicion vacia o cuyo campo este a menos de d de su posicion ideal,
+ * donde se inserta el campo nuevo.
+ */
+#define ROBIN_SONDEAR(pos, d, mascara, sigue) \
+	for(; (sigue); (pos) = ((pos) + 1) & (mascara), (d)++)
+
+/* Avanza fin hasta la primera posicion en la que ocupada es falsa. */
+#define ROBIN_FIN_TRAMO(fin, mascara, ocupada) \
+	for(; (ocupada); (fin) = ((fin) + 1) & (mascara))
+
+/* Corre un lugar hacia adelante los campos desde pos hasta fin, que
+ * tiene que estar vacia, de atras para adelante: el cuerpo copia el
+ * campo de anterior a fin. Termina con fin en pos, listo para el campo
+ * nuevo.
+ */
+#define ROBIN_CORRER_ADELANTE(pos, fin, anterior, mascara) \
+	for(size_t anterior = ((fin) - 1) & (mascara); (fin) != (pos); \
+		(fin) = anterior, anterior = (anterior - 1) & (mascara))
+
+/* Corrimiento hacia atras al sacar el campo de i: mientras el campo de
+ * la posicion siguiente j este desplazado (ocupada y a distancia mayor
+ * a 0), el cuerpo lo copia a i. Termina con i en la posicion que queda
+ * vacia.
+ */
+#define ROBIN_CORRER_ATRAS(i, j, mascara, desplazado) \
+	for(size_t j = ((i) + 1) & (mascara); (desplazado); \
+		(i) = j, j = (j + 1) & (mascara))
+
+#endif // ROBIN_HOOD_H
@@ -0,0 +1,199 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "rueda.h"
+#include "bitmap.h"
+#define CAPACIDAD_INICIAL 8 // registros de una casilla al pedirle memoria por primera vez
+
+/* *****************************************************************
+ *                DEFINICION DE FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+/* Libera un arreglo de registros, que puede ser NULL (el asignador del
+ * usuario no tiene por que aceptarlo).
+ */
+static void liberar_registros(const rueda_t* rueda, rueda_registro_t* registros){
+	if(registros)
+		asignador_liberar(&rueda->asignador, registros);
+}
+
+/* Agrega el registro al final de la casilla, duplicando su capacidad si
+ * hace falta. Devuelve false si no hay memoria.
+ */
+static bool casilla_agregar(const rueda_t* rueda, rueda_casilla_t* casilla, const rueda_registro_t* registro){
+	if(casilla->cant == casilla->capacidad){
+		size_t capacidad = casilla->capacidad ? casilla->capacidad * 2 : CAPACIDAD_INICIAL;
+		rueda_registro_t* registros = asignador_pedir(&rueda->asignador, sizeof(rueda_registro_t) * capacidad);
+		if(!registros) return false;
+		if(casilla->cant)
+			memcpy(registros, casilla->registros, sizeof(rueda_registro_t) * casilla->cant);
+		liberar_registros(rueda, casilla->registros);
+		casilla->registros = registros;
+		casilla->capacidad = capacidad;
+	}
+	casilla->registros[casilla->cant++] = *registro;
+	return true;
+}
+
+/* Deja la casilla vacia y sin memoria pedida, y devuelve lo que tenia.
+ */
+static rueda_casilla_t casilla_vaciar(rueda_casilla_t* casilla){
+	rueda_casilla_t contenido = *casilla;
+	memset(casilla, 0, sizeof(*casilla));
+	return contenido;
+}
+
+/* Guarda el registro en la casilla que le toca segun el instante actual:
+ * en el nivel del grupo de bits mas alto en el que vence difiere de
+ * actual, asi la casilla siempre esta mas adelante que la actual de su
+ * nivel. No cambia la cantidad de registros.
+ */
+static bool colocar(rueda_t* rueda, const rueda_registro_t* registro){
+	if(registro->vence <= rueda->actual)
+		return casilla_agregar(rueda, &rueda->vencidos, registro);
+	uint64_t distintos = registro->vence ^ rueda->actual;
+	size_t nivel = 0;
+	while(nivel < RUEDA_NIVELES && distintos >> (RUEDA_BITS_NIVEL * (nivel + 1)))
+		nivel++;
+	if(nivel == RUEDA_NIVELES)
+		return casilla_agregar(rueda, &rueda->lejanos, registro);
+	size_t c = (size_t)(registro->vence >> (RUEDA_BITS_NIVEL * nivel)) & (RUEDA_CASILLAS - 1);
+	if(!casilla_agregar(rueda, &rueda->casillas[nivel][c], registro))
+		return false;
+	rueda->ocupadas[nivel] |= (uint64_t)1 << c;
+	return true;
+}
+
+/* Vuelve a colocar los registros de contenido y libera su memoria. Si no
+ * hay memoria para alguno se lo descarta: su elemento se borra recien al
+ * buscarlo en el hash.
+ */
+static void recolocar(rueda_t* rueda, rueda_casilla_t contenido){
+	for(size_t i = 0; i < contenido.cant; i++){
+		if(!colocar(rueda, &contenido.registros[i]))
+			rueda->cant--;
+	}
+	liberar_registros(rueda, contenido.registros);
+}
+
+/* Devuelve el proximo instante posterior a actual en el que empieza una
+ * casilla ocupada de algun nivel (o la proxima vuelta del ultimo nivel,
+ * si hay registros lejanos), o UINT64_MAX si no hay ninguno.
+ */
+static uint64_t proximo_evento(const rueda_t* rueda){
+	uint64_t proximo = UINT64_MAX;
+	for(size_t nivel = 0; nivel < RUEDA_NIVELES; nivel++){
+		unsigned corrimiento = (unsigned)(RUEDA_BITS_NIVEL * nivel);
+		size_t c = (size_t)(rueda->actual >> corrimiento) & (RUEDA_CASILLAS - 1);
+		uint64_t siguientes = c + 1 == RUEDA_CASILLAS ? 0 : rueda->ocupadas[nivel] & (~(uint64_t)0 << (c + 1));
+		if(!siguientes) continue;
+		uint64_t vuelta = rueda->actual >> (corrimiento + RUEDA_BITS_NIVEL) << (corrimiento + RUEDA_BITS_NIVEL);
+		uint64_t instante = vuelta + ((uint64_t)bitmap_primer_bit(siguientes) << corrimiento);
+		if(instante < proximo)
+			proximo = instante;
+	}
+	unsigned total = RUEDA_BITS_NIVEL * RUEDA_NIVELES;
+	if(rueda->lejanos.cant && (rueda->actual >> total) + 1 < ((uint64_t)1 << (64 - total))){
+		uint64_t instante = ((rueda->actual >> total) + 1) << total;
+		if(instante < proximo)
+			proximo = instante;
+	}
+	return proximo;
+}
+
+/* Lleva la rueda al instante t, en el que empieza alguna casilla: baja
+ * los registros de las casillas que empiezan en t, de arriba hacia abajo
+ * para que los que bajan lleguen a las casillas de t de los niveles
+ * inferiores, y los del nivel 0 quedan vencidos.
+ */
+static void procesar(rueda_t* rueda, uint64_t t){
+	rueda->actual = t;
+	unsigned total = RUEDA_BITS_NIVEL * RUEDA_NIVELES;
+	if(rueda->lejanos.cant && (t & (((uint64_t)1 << total) - 1)) == 0)
+		recolocar(rueda, casilla_vaciar(&rueda->lejanos));
+	for(size_t nivel = RUEDA_NIVELES; nivel-- > 0;){
+		unsigned corrimiento = (unsigned)(RUEDA_BITS_NIVEL * nivel);
+		if(t & (((uint64_t)1 << corrimiento) - 1)) continue;
+		size_t c = (size_t)(t >> corrimiento) & (RUEDA_CASILLAS - 1);
+		if(!(rueda->ocupadas[nivel] & ((uint64_t)1 << c))) continue;
+		rueda->ocupadas[nivel] &= ~((uint64_t)1 << c);
+		rueda_casilla_t* casilla = &rueda->casillas[nivel][c];
+		if(nivel == 0 && rueda->primero_vencido == rueda->vencidos.cant){
+			// Todos los del nivel 0 vencen en t: pasan juntos sin copiarlos.
+			liberar_registros(rueda, rueda->vencidos.registros);
+			rueda->vencidos = casilla_vaciar(casilla);
+			rueda->primero_vencido = 0;
+		}else{
+			recolocar(rueda, casilla_vaciar(casilla));
+		}
+	}
+}
+
+/* *****************************************************************
+ *                    PRIMITIVAS DE LA RUEDA
+ * *****************************************************************/
+
+uint64_t rueda_reloj(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+rueda_t* rueda_crear(const asignador_t* asignador, uint64_t ahora){
+	asignador_t propio = {0};
+	if(asignador)
+		propio = *asignador;
+	rueda_t* rueda = asignador_pedir(&propio, sizeof(rueda_t));
+	if(!rueda) return NULL;
+	memset(rueda, 0, sizeof(rueda_t));
+	rueda->asignador = propio;
+	rueda->actual = ahora;
+	return rueda;
+}
+
+bool rueda_agregar(rueda_t* rueda, uint64_t h, const void* id, uint64_t vence){
+	rueda_registro_t registro = {h, id, vence};
+	if(!colocar(rueda, &registro))
+		return false;
+	rueda->cant++;
+	return true;
+}
+
+/* Saltea los instantes sin casillas ocupadas: el costo de avanzar no
+ * depende del tiempo transcurrido sino de las casillas que se vacian.
+ */
+bool rueda_sacar(rueda_t* rueda, uint64_t ahora, rueda_registro_t* registro){
+	if(rueda->primero_vencido == rueda->vencidos.cant){
+		rueda->primero_vencido = 0;
+		rueda->vencidos.cant = 0;
+		while(ahora > rueda->actual && rueda->primero_vencido == rueda->vencidos.cant){
+			uint64_t t = proximo_evento(rueda);
+			if(t > ahora){
+				rueda->actual = ahora;
+				break;
+			}
+			procesar(rueda, t);
+		}
+		if(rueda->primero_vencido == rueda->vencidos.cant)
+			return false;
+	}
+	*registro = rueda->vencidos.registros[rueda->primero_vencido++];
+	rueda->cant--;
+	return true;
+}
+
+size_t rueda_cantidad(const rueda_t* rueda){
+	return rueda->cant;
+}
+
+void rueda_destruir(rueda_t* rueda){
+	for(size_t nivel = 0; nivel < RUEDA_NIVELES; nivel++){
+		for(size_t c = 0; c < RUEDA_CASILLAS; c++)
+			liberar_registros(rueda, rueda->casillas[nivel][c].registros);
+	}
+	liberar_registros(rueda, rueda->lejanos.registros);
+	liberar_registros(rueda, rueda->vencidos.registros);
+	asignador_t asignador = rueda->asignador;
+	asignador_liberar(&asignador, rueda);
+}
@@ -0,0 +1,88 @@
+#ifndef RUEDA_H
+#define RUEDA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "arena.h"
+
+/* Rueda de tiempos jerarquica: ordena vencimientos para sacarlos cuando
+ * llega su momento, con costo amortizado constante por vencimiento. Lo
+ * usan las implementaciones del hash para hash_guardar_ttl.
+ * Cada nivel tiene RUEDA_CASILLAS casillas; una casilla del nivel n
+ * abarca RUEDA_CASILLAS^n instantes. Un vencimiento se guarda en el
+ * nivel mas bajo que lo separa del instante actual, y al llegar al
+ * comienzo de su casilla baja a los niveles de abajo, hasta quedar
+ * vencido. Los instantes son los del reloj del hash (milisegundos).
+ */
+
+#define RUEDA_NIVELES 6
+#define RUEDA_CASILLAS 64 // una palabra del bitmap de casillas ocupadas
+#define RUEDA_BITS_NIVEL 6 // log2(RUEDA_CASILLAS)
+
+/* *****************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+// Vencimiento de un elemento del hash. El hash lo identifica por el hash
+// de su clave y un puntero propio de cada implementacion que no cambia
+// mientras el elemento este guardado. No se sacan los registros de los
+// elementos borrados o que cambiaron de vencimiento: al sacarlos, el hash
+// descarta los que no coinciden con un elemento y su vencimiento actual.
+typedef struct rueda_registro{
+	uint64_t h;
+	const void *id;
+	uint64_t vence;
+} rueda_registro_t;
+
+// Arreglo de registros que crece a medida que se agregan.
+typedef struct rueda_casilla{
+	rueda_registro_t *registros;
+	size_t cant;
+	size_t capacidad;
+} rueda_casilla_t;
+
+typedef struct rueda{
+	uint64_t actual; // ultimo instante al que se avanzo
+	uint64_t ocupadas[RUEDA_NIVELES]; // casillas no vacias de cada nivel
+	rueda_casilla_t casillas[RUEDA_NIVELES][RUEDA_CASILLAS];
+	rueda_casilla_t lejanos; // vencen despues de la vuelta actual del ultimo nivel
+	rueda_casilla_t vencidos; // listos para rueda_sacar desde primero_vencido
+	size_t primero_vencido;
+	size_t cant;
+	asignador_t asignador;
+} rueda_t;
+
+/* *****************************************************************
+ *                    PRIMITIVAS DE LA RUEDA
+ * *****************************************************************/
+
+// Devuelve los milisegundos del reloj monotono del sistema.
+uint64_t rueda_reloj(void);
+
+// Crea una rueda vacia en el instante ahora, que pide su memoria al
+// asignador recibido (que se copia; puede ser NULL).
+// Post: devuelve la rueda, o NULL si no hay memoria.
+rueda_t *rueda_crear(const asignador_t *asignador, uint64_t ahora);
+
+// Agrega un vencimiento. Si ya paso, queda listo para rueda_sacar.
+// Pre: la rueda fue creada.
+// Post: devuelve false si no hay memoria.
+bool rueda_agregar(rueda_t *rueda, uint64_t h, const void *id, uint64_t vence);
+
+// Saca en registro un vencimiento que ya paso en el instante ahora,
+// avanzando la rueda solo hasta encontrar alguno. Los saca en el orden en
+// que vencen, salvo los que ya habian pasado al agregarlos. Devuelve false
+// si no queda ninguno.
+// Pre: la rueda fue creada.
+bool rueda_sacar(rueda_t *rueda, uint64_t ahora, rueda_registro_t *registro);
+
+// Devuelve cuantos registros tiene la rueda, vencidos o no.
+// Pre: la rueda fue creada.
+size_t rueda_cantidad(const rueda_t *rueda);
+
+// Libera la rueda y sus registros.
+// Pre: la rueda fue creada.
+void rueda_destruir(rueda_t *rueda);
+
+#endif // RUEDA_H